@@ -0,0 +1,284 @@
+;;; byte-native.el --- translate byte-compiled Lisp into native code
+
+;; Copyright (C) 2026 Free Software Foundation, Inc.
+
+;; Maintainer: FSF
+;; Keywords: lisp, internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; `byte-native-compile-file' translates the byte-code functions of a
+;; byte-compiled file FOO.elc into C, one C function per byte-code
+;; string, and compiles that with a C compiler into a shared object
+;; FOO.eln next to it.  When `load' later loads FOO.elc, and
+;; `load-native-code' is non-nil, it loads FOO.eln as well, and each
+;; of those functions runs as native code instead of in the byte-code
+;; interpreter.
+
+;; Each instruction becomes a use of the macro in src/native.h named
+;; after it, which does what the interpreter does for it, and each
+;; jump becomes a C `goto'.  This removes the dispatch and operand
+;; decoding of the interpreter and lets the C compiler keep the stack
+;; pointer in a register; the functions called are the same.
+
+;; Functions that use an instruction that cannot be translated, and
+;; functions compiled with `byte-compile-dynamic', whose byte-code is
+;; only read when they are first called, keep running in the
+;; interpreter.
+
+;;; Code:
+
+(defgroup byte-native nil
+  "Translating byte-compiled Lisp into native code."
+  :group 'lisp
+  :version "23.2")
+
+(defcustom byte-native-cc "gcc"
+  "The C compiler used by `byte-native-compile-file'."
+  :type 'string
+  :group 'byte-native)
+
+(defcustom byte-native-cflags
+  (list "-shared" "-fPIC" "-O2" "-Demacs" "-DHAVE_CONFIG_H"
+	(concat "-I" (expand-file-name "src" source-directory)))
+  "Arguments for `byte-native-cc' to make a shared object.
+They must find the config.h and Lisp headers Emacs was built with."
+  :type '(repeat string)
+  :group 'byte-native)
+
+(defconst byte-native-operations
+  (let ((ops (make-vector 256 nil)))
+    ;; Groups of eight: the operand is in the opcode for the first
+    ;; six, and in one and two following bytes for the last two.
+    (dolist (group '((#o10 . "varref") (#o20 . "varset")
+		     (#o30 . "varbind") (#o40 . "call") (#o50 . "unbind")))
+      (dotimes (i 6)
+	(aset ops (+ (car group) i) (list (cdr group) i)))
+      (aset ops (+ (car group) 6) (list (cdr group) 'byte))
+      (aset ops (+ (car group) 7) (list (cdr group) 'word)))
+    (dotimes (i 64)
+      (aset ops (+ #o300 i) (list "constant" i)))
+    (dolist (op '((#o70 "nth") (#o71 "symbolp") (#o72 "consp")
+		  (#o73 "stringp") (#o74 "listp") (#o75 "eq") (#o76 "memq")
+		  (#o77 "not") (#o100 "car") (#o101 "cdr") (#o102 "cons")
+		  (#o103 "list1") (#o104 "list2") (#o105 "list3")
+		  (#o106 "list4") (#o107 "length") (#o110 "aref")
+		  (#o111 "aset") (#o112 "symbol_value")
+		  (#o113 "symbol_function") (#o114 "set") (#o115 "fset")
+		  (#o116 "get") (#o117 "substring") (#o120 "concat2")
+		  (#o121 "concat3") (#o122 "concat4") (#o123 "sub1")
+		  (#o124 "add1") (#o125 "eqlsign") (#o126 "gtr") (#o127 "lss")
+		  (#o130 "leq") (#o131 "geq") (#o132 "diff") (#o133 "negate")
+		  (#o134 "plus") (#o135 "max") (#o136 "min") (#o137 "mult")
+		  (#o140 "point") (#o141 "save_current_buffer")
+		  (#o142 "goto_char") (#o143 "insert") (#o144 "point_max")
+		  (#o145 "point_min") (#o146 "char_after")
+		  (#o147 "following_char") (#o150 "preceding_char")
+		  (#o151 "current_column") (#o152 "indent_to")
+		  (#o153 "scan_buffer") (#o154 "eolp") (#o155 "eobp")
+		  (#o156 "bolp") (#o157 "bobp") (#o160 "current_buffer")
+		  (#o161 "set_buffer") (#o162 "save_current_buffer")
+		  (#o163 "set_mark") (#o164 "interactive_p")
+		  (#o165 "forward_char") (#o166 "forward_word")
+		  (#o167 "skip_chars_forward") (#o170 "skip_chars_backward")
+		  (#o171 "forward_line") (#o172 "char_syntax")
+		  (#o173 "buffer_substring") (#o174 "delete_region")
+		  (#o175 "narrow_to_region") (#o176 "widen")
+		  (#o177 "end_of_line") (#o201 "constant" word)
+		  (#o202 "goto" jump) (#o203 "gotoifnil" jump)
+		  (#o204 "gotoifnonnil" jump) (#o205 "gotoifnilelsepop" jump)
+		  (#o206 "gotoifnonnilelsepop" jump) (#o207 "return")
+		  (#o210 "discard") (#o211 "dup") (#o212 "save_excursion")
+		  (#o213 "save_window_excursion") (#o214 "save_restriction")
+		  (#o215 "catch") (#o216 "unwind_protect")
+		  (#o217 "condition_case") (#o220 "temp_output_buffer_setup")
+		  (#o221 "temp_output_buffer_show") (#o223 "set_marker")
+		  (#o224 "match_beginning") (#o225 "match_end")
+		  (#o226 "upcase") (#o227 "downcase") (#o230 "stringeqlsign")
+		  (#o231 "stringlss") (#o232 "equal") (#o233 "nthcdr")
+		  (#o234 "elt") (#o235 "member") (#o236 "assq")
+		  (#o237 "nreverse") (#o240 "setcar") (#o241 "setcdr")
+		  (#o242 "car_safe") (#o243 "cdr_safe") (#o244 "nconc")
+		  (#o245 "quo") (#o246 "rem") (#o247 "numberp")
+		  (#o250 "integerp") (#o252 "goto" rjump)
+		  (#o253 "gotoifnil" rjump) (#o254 "gotoifnonnil" rjump)
+		  (#o255 "gotoifnilelsepop" rjump)
+		  (#o256 "gotoifnonnilelsepop" rjump) (#o257 "listN" byte)
+		  (#o260 "concatN" byte) (#o261 "insertN" byte)))
+      (aset ops (car op) (cdr op)))
+    ops)
+  "Vector of the byte-code instructions that can be translated.
+Element N describes opcode N as (NAME OPERAND), where NAME names the
+macro N_NAME in native.h, and OPERAND is nil if there is none, an
+integer if it is part of the opcode, `byte' or `word' if it follows
+in one or two bytes, or `jump' or `rjump' if it is the target of an
+absolute or relative jump.  Opcodes that are nil, such as
+`unbind-all', are not translated.")
+
+(defun byte-native-decode (bytes)
+  "Decode the byte-code string BYTES.
+Return a list of the instructions in order, each of the form
+\(PC NAME OPERAND), where OPERAND is an integer, the pc of the target
+of a jump, or nil.  Return nil if BYTES cannot be translated."
+  (catch 'byte-native-decode
+    (let ((pc 0) (length (length bytes)) insns)
+      (while (< pc length)
+	(let* ((op (aref bytes pc))
+	       (desc (or (aref byte-native-operations op)
+			 (throw 'byte-native-decode nil)))
+	       (start pc)
+	       (operand (cadr desc)))
+	  (setq pc (1+ pc))
+	  (cond ((memq operand '(byte rjump))
+		 (when (>= pc length)
+		   (throw 'byte-native-decode nil))
+		 (setq operand (aref bytes pc)
+		       pc (1+ pc))
+		 (when (eq (cadr desc) 'rjump)
+		   ;; The interpreter adds the operand less 127 to the
+		   ;; pc of the operand.
+		   (setq operand (+ pc operand -128))))
+		((memq operand '(word jump))
+		 (when (>= (1+ pc) length)
+		   (throw 'byte-native-decode nil))
+		 (setq operand (+ (aref bytes pc) (* 256 (aref bytes (1+ pc))))
+		       pc (+ pc 2))))
+	  (push (list start (car desc) operand) insns)))
+      (nreverse insns))))
+
+(defun byte-native-function (name bytes)
+  "Insert the C function NAME that executes the byte-code string BYTES.
+Return nil, inserting nothing, if BYTES cannot be translated."
+  (let ((insns (byte-native-decode bytes))
+	targets)
+    (when insns
+      (dolist (insn insns)
+	(when (memq (cadr (aref byte-native-operations
+				(aref bytes (car insn))))
+		    '(jump rjump))
+	  (push (nth 2 insn) targets)))
+      (insert "\nstatic Lisp_Object\n" name
+	      " (struct byte_stack *stack, Lisp_Object *vectorp,"
+	      " Lisp_Object *top)\n{\n")
+      (dolist (insn insns)
+	(let ((pc (nth 0 insn))
+	      (op (nth 1 insn))
+	      (operand (nth 2 insn))
+	      (kind (cadr (aref byte-native-operations
+				(aref bytes (car insn))))))
+	  (when (memq pc targets)
+	    (insert (format " pc_%d:\n" pc)))
+	  (insert
+	   (cond ((memq kind '(jump rjump))
+		  (format "  N_%s (pc_%d);\n" op operand))
+		 (operand
+		  (format "  N_%s (%d);\n" op operand))
+		 (t
+		  (format "  N_%s ();\n" op))))))
+      ;; Byte-code never runs off its end.
+      (insert "  return Qnil;\n}\n")
+      t)))
+
+(defun byte-native-collect (object table)
+  "Add the byte-code strings of the functions in OBJECT to TABLE.
+TABLE is an `equal' hash table; OBJECT is searched recursively."
+  (let ((seen (make-hash-table :test 'eq))
+	(stack (list object)))
+    (while stack
+      (let ((object (pop stack)))
+	(unless (or (gethash object seen)
+		    (not (or (consp object) (vectorp object)
+			     (byte-code-function-p object))))
+	  (puthash object t seen)
+	  (cond ((consp object)
+		 (push (car object) stack)
+		 (push (cdr object) stack))
+		(t
+		 (when (and (byte-code-function-p object)
+			    (stringp (aref object 1)))
+		   (puthash (if (multibyte-string-p (aref object 1))
+				(string-as-unibyte (aref object 1))
+			      (aref object 1))
+			    t table))
+		 (dotimes (i (length object))
+		   (push (aref object i) stack)))))))))
+
+(defun byte-native-string (string)
+  "Return STRING, a unibyte string, as a C string literal."
+  (concat "\""
+	  (mapconcat (lambda (byte) (format "\\%03o" byte)) string "")
+	  "\""))
+
+;;;###autoload
+(defun byte-native-compile-file (file)
+  "Translate the byte-compiled FILE into native code.
+The functions in FILE, which should be a .elc file, are translated
+into C and compiled with `byte-native-cc' into a shared object
+whose name is that of FILE with the last letter replaced by \"n\".
+Loading FILE then makes them run as native code; see `load-native-code'.
+Return the number of functions translated."
+  (interactive "fNative compile file: ")
+  (setq file (expand-file-name file))
+  (unless (string-match "\\.elc\\'" file)
+    (error "%s is not a byte-compiled file" file))
+  (let* ((base (substring file 0 -1))
+	 (c-file (concat base "n.c"))
+	 (eln-file (concat base "n"))
+	 (strings (make-hash-table :test 'equal))
+	 (count 0) entries)
+    (with-temp-buffer
+      (insert-file-contents file)
+      (goto-char (point-min))
+      (let ((load-file-name file))
+	(condition-case nil
+	    (while t
+	      (byte-native-collect (read (current-buffer)) strings))
+	  (end-of-file nil))))
+    (with-temp-file c-file
+      (set-buffer-multibyte nil)
+      (insert "/* Native code for " (file-name-nondirectory file)
+	      ", made by byte-native.el.  Do not edit.  */\n\n"
+	      "#include <config.h>\n#include \"native.h\"\n\n"
+	      "int emacs_native_abi_version = NATIVE_ABI_VERSION;\n"
+	      "const char emacs_native_emacs_version[] = "
+	      (byte-native-string (encode-coding-string emacs-version 'utf-8))
+	      ";\n")
+      (maphash (lambda (bytes ignore)
+		 (let ((name (format "native_%d" count)))
+		   (when (byte-native-function name bytes)
+		     (push (format "  { %s, %d, %s },\n"
+				   (byte-native-string bytes) (length bytes) name)
+			   entries)
+		     (setq count (1+ count)))))
+	       strings)
+      (insert "\nstruct native_function_entry emacs_native_functions[] =\n{\n")
+      (mapc 'insert (nreverse entries))
+      (insert "  { 0, 0, 0 }\n};\n"))
+    (with-temp-buffer
+      (unless (eq 0 (apply 'call-process byte-native-cc nil t nil
+			   (append byte-native-cflags
+				   (list "-o" eln-file c-file))))
+	(error "Compiling %s failed: %s" c-file (buffer-string))))
+    (delete-file c-file)
+    (when (interactive-p)
+      (message "Translated %d functions of %s" count file))
+    count))
+
+(provide 'byte-native)
+
+;;; byte-native.el ends here
@@ -1767,6 +1767,15 @@ The value is non-nil if there were no errors, nil if errors."
         (setq bytecomp-filename buffer-file-name))
       ;; Set the default directory, in case an eval-when-compile uses it.
       (setq default-directory (file-name-directory bytecomp-filename)))
+    ;; Lexical binding is experimental and works only in the
+    ;; interpreter.  The compiler knows only dynamic binding, and would
+    ;; turn the closures of a file that uses lexical binding into
+    ;; functions that lose their variables.
+    (when (and (buffer-local-value 'lexical-binding input-buffer)
+	       (not (buffer-local-value 'no-byte-compile input-buffer)))
+      (error "%s: only the interpreter supports `lexical-binding'; %s"
+	     (file-relative-name bytecomp-filename)
+	     "add `no-byte-compile: t' to load the file from source"))
     ;; Check if the file's local variables explicitly specify not to
     ;; compile this file.
     (if (with-current-buffer input-buffer no-byte-compile)
@@ -4372,31 +4381,82 @@ and corresponding effects."
 ;;; report metering (see the hacks in bytecode.c)
 
 (defvar byte-code-meter)
-(defun byte-compile-report-ops ()
-  (with-output-to-temp-buffer "*Meter*"
-    (set-buffer "*Meter*")
-    (let ((i 0) n op off)
-      (while (< i 256)
-	(setq n (aref (aref byte-code-meter 0) i)
-	      off nil)
-	(if t				;(not (zerop n))
-	    (progn
-	      (setq op i)
-	      (setq off nil)
-	      (cond ((< op byte-nth)
-		     (setq off (logand op 7))
-		     (setq op (logand op 248)))
-		    ((>= op byte-constant)
-		     (setq off (- op byte-constant)
-			   op byte-constant)))
-	      (setq op (aref byte-code-vector op))
-	      (insert (format "%-4d" i))
-	      (insert (symbol-name op))
-	      (if off (insert " [" (int-to-string off) "]"))
-	      (indent-to 40)
-	      (insert (int-to-string n) "\n")))
-	(setq i (1+ i))))))
-
+;;;###autoload
+(defun byte-compile-report-ops (&optional limit)
+  "Display the data collected by byte-code metering.
+Show how often each class of byte-code instructions was executed and
+how long it took, the most frequent pairs of successive instructions,
+and the functions called most often from byte-code.  LIMIT, or the
+numeric prefix argument, is the number of pairs and functions to show;
+it defaults to 20.  See `byte-code-meter-start'."
+  (interactive "P")
+  (unless (vectorp byte-code-meter)
+    (error "Byte-code metering has not been started"))
+  (setq limit (if limit (prefix-numeric-value limit) 20))
+  (let ((times (byte-code-meter-times))
+	(calls (byte-code-meter-calls))
+	(counts (make-vector 256 0))
+	classes pairs functions)
+    ;; Instructions whose operand is in the opcode are counted
+    ;; separately but timed together; show them together.
+    (dotimes (i 256)
+      (let ((class (byte-compile-meter-class i)))
+	(aset counts class (+ (aref counts class)
+			      (aref (aref byte-code-meter 0) i)))))
+    (dotimes (i 256)
+      (if (or (> (aref counts i) 0) (> (aref times i) 0))
+	  (push (list i (aref counts i) (aref times i)) classes))
+      (unless (zerop i)
+	(dotimes (j 256)
+	  (let ((n (aref (aref byte-code-meter i) j)))
+	    (if (> n 0) (push (list i j n) pairs))))))
+    (if calls (maphash (lambda (f n) (push (cons f n) functions)) calls))
+    (setq classes (sort classes (lambda (a b) (> (nth 2 a) (nth 2 b))))
+	  pairs (sort pairs (lambda (a b) (> (nth 2 a) (nth 2 b))))
+	  functions (sort functions (lambda (a b) (> (cdr a) (cdr b)))))
+    (with-output-to-temp-buffer "*Meter*"
+      (with-current-buffer standard-output
+	(insert (format "%-28s %14s %12s %10s\n"
+			"Instruction" "Count" "Seconds" "ns each"))
+	(dolist (class classes)
+	  (insert (format "%-28s %14d %12.6f %10.1f\n"
+			  (byte-compile-meter-name (car class))
+			  (nth 1 class) (nth 2 class)
+			  (if (zerop (nth 1 class)) 0.0
+			    (/ (* (nth 2 class) 1e9) (nth 1 class))))))
+	(insert (format "\n%-28s %-28s %14s\n"
+			"Instruction" "Followed by" "Count"))
+	(dolist (pair (byte-compile-meter-head pairs limit))
+	  (insert (format "%-28s %-28s %14d\n"
+			  (byte-compile-meter-name (nth 0 pair))
+			  (byte-compile-meter-name (nth 1 pair))
+			  (nth 2 pair))))
+	(insert (format "\n%-57s %14s\n" "Function called" "Count"))
+	(dolist (function (byte-compile-meter-head functions limit))
+	  (insert (format "%-57s %14d\n" (car function) (cdr function))))))))
+
+(defun byte-compile-meter-class (op)
+  "Return the first opcode of the instructions that OP belongs to."
+  (cond ((< op byte-nth) (logand op 248))
+	((>= op byte-constant) byte-constant)
+	(t op)))
+
+(defun byte-compile-meter-name (op)
+  "Return a string describing the byte-code instruction OP."
+  (let ((class (byte-compile-meter-class op)))
+    (concat (if (aref byte-code-vector class)
+		(symbol-name (aref byte-code-vector class))
+	      (format "<%d>" class))
+	    (if (/= class op) (format " [%d]" (- op class)) ""))))
+
+(defun byte-compile-meter-head (list n)
+  "Return a list of the first N elements of LIST."
+  (let (head)
+    (while (and list (> n 0))
+      (push (pop list) head)
+      (setq n (1- n)))
+    (nreverse head)))
+
 ;; To avoid "lisp nesting exceeds max-lisp-eval-depth" when bytecomp compiles
 ;; itself, compile some of its most used recursive functions (at load time).
 ;;
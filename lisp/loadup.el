@@ -49,8 +49,8 @@
 
 ;; Add subdirectories to the load-path for files that might get
 ;; autoloaded when bootstrapping.
-(if (or (equal (nth 3 command-line-args) "bootstrap")
-	(equal (nth 4 command-line-args) "bootstrap")
+(if (or (member (nth 3 command-line-args) '("bootstrap" "pbootstrap"))
+	(member (nth 4 command-line-args) '("bootstrap" "pbootstrap"))
 	(equal (nth 3 command-line-args) "unidata-gen.el")
 	(equal (nth 4 command-line-args) "unidata-gen-files")
 	;; In case CANNOT_DUMP.
@@ -66,8 +66,10 @@
 
 (message "Using load-path %s" load-path)
 
-(if (or (member (nth 3 command-line-args) '("dump" "bootstrap"))
-	(member (nth 4 command-line-args) '("dump" "bootstrap")))
+(if (or (member (nth 3 command-line-args)
+		'("dump" "bootstrap" "pdump" "pbootstrap"))
+	(member (nth 4 command-line-args)
+		'("dump" "bootstrap" "pdump" "pbootstrap")))
     ;; To reduce the size of dumped Emacs, we avoid making huge
     ;; char-tables.
     (setq inhibit-load-charset-map t))
@@ -264,8 +266,8 @@
 
 
 (message "Finding pointers to doc strings...")
-(if (or (equal (nth 3 command-line-args) "dump")
-	(equal (nth 4 command-line-args) "dump"))
+(if (or (member (nth 3 command-line-args) '("dump" "pdump"))
+	(member (nth 4 command-line-args) '("dump" "pdump")))
     (let ((name emacs-version))
       (while (string-match "[^-+_.a-zA-Z0-9]+" name)
 	(setq name (concat (downcase (substring name 0 (match-beginning 0)))
@@ -328,8 +330,8 @@
 (set-buffer-modified-p nil)
 
 ;; reset the load-path.  See lread.c:init_lread why.
-(if (or (equal (nth 3 command-line-args) "bootstrap")
-	(equal (nth 4 command-line-args) "bootstrap"))
+(if (or (member (nth 3 command-line-args) '("bootstrap" "pbootstrap"))
+	(member (nth 4 command-line-args) '("bootstrap" "pbootstrap")))
     (setcdr load-path nil))
 
 (remove-hook 'after-load-functions '(lambda (f) (garbage-collect)))
@@ -374,6 +376,20 @@
 	    (add-name-to-file "emacs" name t)))
       (kill-emacs)))
 
+;; With "pdump" or "pbootstrap", write the Lisp state to a portable
+;; dump file instead of an executable.  The Makefile installs temacs
+;; under the executable's name, which finds the dump file next to
+;; itself when it starts.
+(if (or (member (nth 3 command-line-args) '("pdump" "pbootstrap"))
+	(member (nth 4 command-line-args) '("pdump" "pbootstrap")))
+    (let ((file (if (or (equal (nth 3 command-line-args) "pbootstrap")
+			(equal (nth 4 command-line-args) "pbootstrap"))
+		    "bootstrap-emacs.pdmp"
+		  "emacs.pdmp")))
+      (message "Dumping into %s" file)
+      (dump-emacs-portable file)
+      (kill-emacs)))
+
 ;; Avoid error if user loads some more libraries now.
 (setq purify-flag nil)
 
@@ -260,7 +260,7 @@ configuration."
            ;; Filter out special forms.
            (not (eq 'unevalled (cdr (subr-arity object)))))
       (byte-code-function-p object)
-      (eq (car-safe object) 'lambda)))
+      (memq (car-safe object) '(lambda closure))))
 
 ;;;; List functions.
 
@@ -1214,7 +1214,8 @@ function, it is changed to a list of functions."
       (setq local t)))
   (let ((hook-value (if local (symbol-value hook) (default-value hook))))
     ;; If the hook value is a single function, turn it into a list.
-    (when (or (not (listp hook-value)) (eq (car hook-value) 'lambda))
+    (when (or (not (listp hook-value))
+	      (memq (car hook-value) '(lambda closure)))
       (setq hook-value (list hook-value)))
     ;; Do the actual addition if necessary
     (unless (member function hook-value)
@@ -1255,7 +1256,8 @@ the hook's buffer-local value rather than its default value."
       (setq local t))
     (let ((hook-value (if local (symbol-value hook) (default-value hook))))
       ;; Remove the function, for both the list and the non-list cases.
-      (if (or (not (listp hook-value)) (eq (car hook-value) 'lambda))
+      (if (or (not (listp hook-value))
+	      (memq (car hook-value) '(lambda closure)))
 	  (if (equal hook-value function) (setq hook-value nil))
 	(setq hook-value (delete function (copy-sequence hook-value))))
       ;; If the function is on the global hook, we need to shadow it locally
@@ -35,7 +35,7 @@ along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
 
 #include <signal.h>
 
-#ifdef HAVE_GTK_AND_PTHREAD
+#if defined (HAVE_GTK_AND_PTHREAD) || defined (HAVE_PTHREAD)
 #include <pthread.h>
 #endif
 
@@ -202,6 +202,11 @@ EMACS_INT gc_relative_threshold;
 
 static Lisp_Object Vgc_cons_percentage;
 
+/* Portion of the GC threshold after which to collect garbage when
+   idle.  */
+
+static Lisp_Object Vgc_cons_idle_fraction;
+
 /* Minimum number of bytes of consing since GC before next GC,
    when memory is full.  */
 
@@ -337,6 +342,7 @@ Lisp_Object Qgc_cons_threshold, Qchar_table_extra_slots;
 /* Hook run after GC has finished.  */
 
 Lisp_Object Vpost_gc_hook, Qpost_gc_hook;
+Lisp_Object Vpost_gc_functions, Qpost_gc_functions;
 
 Lisp_Object Vgc_elapsed;	/* accumulated elapsed time in GC  */
 EMACS_INT gcs_done;		/* accumulated GCs  */
@@ -356,6 +362,7 @@ extern void mark_fringe_data P_ ((void));
 
 static struct Lisp_String *allocate_string P_ ((void));
 static void compact_small_strings P_ ((void));
+static struct sblock *compact_sblocks P_ ((struct sblock *, int *));
 static void free_large_strings P_ ((void));
 static void sweep_strings P_ ((void));
 
@@ -378,7 +385,9 @@ enum mem_type
      process, hash_table, frame, terminal, and window, but we never made
      use of the distinction, so it only caused source-code complexity
      and runtime slowdown.  Minor but pointless.  */
-  MEM_TYPE_VECTORLIKE
+  MEM_TYPE_VECTORLIKE,
+  /* A block of small vectors of the same size, see vector_block.  */
+  MEM_TYPE_VECTOR_BLOCK
 };
 
 static POINTER_TYPE *lisp_align_malloc P_ ((size_t, enum mem_type));
@@ -501,11 +510,11 @@ struct gcpro *gcprolist;
    value; otherwise some compilers put it into BSS.  */
 
 #define NSTATICS 0x640
-static Lisp_Object *staticvec[NSTATICS] = {&Vpurify_flag};
+Lisp_Object *staticvec[NSTATICS] = {&Vpurify_flag};
 
 /* Index of next unused slot in staticvec.  */
 
-static int staticidx = 0;
+int staticidx = 0;
 
 static POINTER_TYPE *pure_alloc P_ ((size_t, int));
 
@@ -1518,11 +1527,32 @@ static void
 mark_interval_tree (tree)
      register INTERVAL tree;
 {
+  register INTERVAL i = tree;
+
   /* No need to test if this tree has been marked already; this
      function is always called through the MARK_INTERVAL_TREE macro,
-     which takes care of that.  */
-
-  traverse_intervals_noorder (tree, mark_interval, Qnil);
+     which takes care of that.
+
+     Walk the tree without recursion, using the parent pointers to
+     climb back up and the mark bits to tell which subtrees are done.
+     This works because intervals are never shared, so the children
+     of an interval not yet marked are not marked either.  */
+  mark_interval (i, Qnil);
+  while (1)
+    {
+      if (!NULL_LEFT_CHILD (i) && !i->left->gcmarkbit)
+	i = i->left;
+      else if (!NULL_RIGHT_CHILD (i) && !i->right->gcmarkbit)
+	i = i->right;
+      else if (i == tree)
+	break;
+      else
+	{
+	  i = INTERVAL_PARENT (i);
+	  continue;
+	}
+      mark_interval (i, Qnil);
+    }
 }
 
 
@@ -1647,6 +1677,10 @@ struct sblock
      of the sblock if there isn't any space left in this block.  */
   struct sdata *next_free;
 
+  /* Number of garbage collections the string data in this sblock
+     has survived, at least.  */
+  int age;
+
   /* Start of data.  */
   struct sdata first_data;
 };
@@ -1673,6 +1707,27 @@ struct string_block
 
 static struct sblock *oldest_sblock, *current_sblock;
 
+/* Small string data that has survived STRING_PROMOTION_AGE garbage
+   collections is moved, a whole sblock at a time, from the list
+   above to the list of old sblocks below.  Old sblocks are compacted
+   only when much of their space is taken by dead strings, so that
+   long-lived strings aren't copied around by every GC.  */
+
+#define STRING_PROMOTION_AGE 3
+
+/* Head and tail of the list of old sblocks.  */
+
+static struct sblock *oldest_old_sblock, *current_old_sblock;
+
+/* Number of bytes of string data, live or dead, in old sblocks.  */
+
+static int old_sblock_bytes;
+
+/* Number of bytes of string data of live small strings, as found by
+   the last sweep_strings.  */
+
+static int small_string_data_bytes;
+
 /* List of sblocks for large strings.  */
 
 static struct sblock *large_sblocks;
@@ -1767,6 +1822,8 @@ init_strings ()
 {
   total_strings = total_free_strings = total_string_size = 0;
   oldest_sblock = current_sblock = large_sblocks = NULL;
+  oldest_old_sblock = current_old_sblock = NULL;
+  old_sblock_bytes = 0;
   string_blocks = NULL;
   n_string_blocks = 0;
   string_free_list = NULL;
@@ -1850,6 +1907,8 @@ check_string_bytes (all_p)
 	    CHECK_STRING_BYTES (s);
 	}
 
+      for (b = oldest_old_sblock; b; b = b->next)
+	check_sblock (b);
       for (b = oldest_sblock; b; b = b->next)
 	check_sblock (b);
     }
@@ -2011,6 +2070,7 @@ allocate_string_data (s, nchars, nbytes)
       b->next_free = &b->first_data;
       b->first_data.string = NULL;
       b->next = NULL;
+      b->age = 0;
 
       if (current_sblock)
 	current_sblock->next = b;
@@ -2049,6 +2109,8 @@ allocate_string_data (s, nchars, nbytes)
     }
 
   consing_since_gc += needed;
+  if (profiler_memory_running)
+    malloc_probe (needed);
 }
 
 
@@ -2063,6 +2125,7 @@ sweep_strings ()
   string_free_list = NULL;
   total_strings = total_free_strings = 0;
   total_string_size = 0;
+  small_string_data_bytes = 0;
 
   /* Scan strings_blocks, free Lisp_Strings that aren't marked.  */
   for (b = string_blocks; b; b = next)
@@ -2089,6 +2152,9 @@ sweep_strings ()
 
 		  ++total_strings;
 		  total_string_size += STRING_BYTES (s);
+		  if (GC_STRING_BYTES (s) <= LARGE_STRING_BYTES)
+		    small_string_data_bytes
+		      += SDATA_SIZE (GC_STRING_BYTES (s)) + GC_STRING_EXTRA;
 		}
 	      else
 		{
@@ -2177,28 +2243,43 @@ free_large_strings ()
 }
 
 
-/* Compact data of small strings.  Free sblocks that don't contain
-   data of live strings after compaction.  */
+/* Compact the string data in the list of sblocks starting with
+   FIRST, by moving the data of live strings towards the start of
+   the list.  Free sblocks that don't contain data of live strings
+   after compaction.  Set *NBYTES to the number of bytes of string
+   data left.  Value is the last sblock of the list.  */
 
-static void
-compact_small_strings ()
+static struct sblock *
+compact_sblocks (first, nbytes_left)
+     struct sblock *first;
+     int *nbytes_left;
 {
   struct sblock *b, *tb, *next;
   struct sdata *from, *to, *end, *tb_end;
   struct sdata *to_end, *from_end;
+  int age, tb_age;
+
+  *nbytes_left = 0;
+  if (first == NULL)
+    return NULL;
 
   /* TB is the sblock we copy to, TO is the sdata within TB we copy
-     to, and TB_END is the end of TB.  */
-  tb = oldest_sblock;
+     to, and TB_END is the end of TB.  TB_AGE is the age of the
+     youngest data copied to TB.  */
+  tb = first;
   tb_end = (struct sdata *) ((char *) tb + SBLOCK_SIZE);
   to = &tb->first_data;
+  tb_age = -1;
 
   /* Step through the blocks from the oldest to the youngest.  We
      expect that old blocks will stabilize over time, so that less
-     copying will happen this way.  */
-  for (b = oldest_sblock; b; b = b->next)
+     copying will happen this way.  This also keeps the data in
+     order of age, so that the age of a block is a good lower bound
+     for the ages of the strings in it.  */
+  for (b = first; b; b = b->next)
     {
       end = b->next_free;
+      age = min (b->age + 1, STRING_PROMOTION_AGE);
       xassert ((char *) end <= (char *) b + SBLOCK_SIZE);
 
       for (from = &b->first_data; from < end; from = from_end)
@@ -2241,10 +2322,12 @@ compact_small_strings ()
 	      if (to_end > tb_end)
 		{
 		  tb->next_free = to;
+		  tb->age = max (tb_age, 0);
 		  tb = tb->next;
 		  tb_end = (struct sdata *) ((char *) tb + SBLOCK_SIZE);
 		  to = &tb->first_data;
 		  to_end = (struct sdata *) ((char *) to + nbytes + GC_STRING_EXTRA);
+		  tb_age = -1;
 		}
 
 	      /* Copy, and update the string's `data' pointer.  */
@@ -2255,8 +2338,12 @@ compact_small_strings ()
 		  to->string->data = SDATA_DATA (to);
 		}
 
+	      if (tb_age < 0 || age < tb_age)
+		tb_age = age;
+
 	      /* Advance past the sdata we copied to.  */
 	      to = to_end;
+	      *nbytes_left += nbytes + GC_STRING_EXTRA;
 	    }
 	}
     }
@@ -2271,7 +2358,54 @@ compact_small_strings ()
 
   tb->next_free = to;
   tb->next = NULL;
-  current_sblock = tb;
+  tb->age = max (tb_age, 0);
+  return tb;
+}
+
+
+/* Compact data of small strings, promoting sblocks whose data is old
+   enough to the old sblocks.  Compact the old sblocks too, if more
+   than half of their space is taken by dead strings.  */
+
+static void
+compact_small_strings ()
+{
+  struct sblock *b;
+  int nbytes, old_live_bytes;
+
+  current_sblock = compact_sblocks (oldest_sblock, &nbytes);
+
+  /* Promote full sblocks whose data has survived long enough.  The
+     sblock we allocate from is never promoted.  */
+  while (oldest_sblock != current_sblock
+	 && oldest_sblock->age >= STRING_PROMOTION_AGE)
+    {
+      b = oldest_sblock;
+      oldest_sblock = b->next;
+      b->next = NULL;
+      if (current_old_sblock)
+	current_old_sblock->next = b;
+      else
+	oldest_old_sblock = b;
+      current_old_sblock = b;
+      old_sblock_bytes += (char *) b->next_free - (char *) &b->first_data;
+      nbytes -= (char *) b->next_free - (char *) &b->first_data;
+    }
+
+  /* Whatever live small string data isn't in the young sblocks is in
+     the old ones.  */
+  old_live_bytes = small_string_data_bytes - nbytes;
+  if (old_sblock_bytes - old_live_bytes > old_sblock_bytes / 2
+      && old_sblock_bytes > 4 * SBLOCK_SIZE)
+    {
+      current_old_sblock = compact_sblocks (oldest_old_sblock,
+					    &old_sblock_bytes);
+      if (old_sblock_bytes == 0)
+	{
+	  lisp_free (oldest_old_sblock);
+	  oldest_old_sblock = current_old_sblock = NULL;
+	}
+    }
 }
 
 
@@ -2648,6 +2782,8 @@ make_float (float_value)
   eassert (!FLOAT_MARKED_P (XFLOAT (val)));
   consing_since_gc += sizeof (struct Lisp_Float);
   floats_consed++;
+  if (profiler_memory_running)
+    malloc_probe (sizeof (struct Lisp_Float));
   return val;
 }
 
@@ -2705,6 +2841,24 @@ struct Lisp_Cons *cons_free_list;
 
 static int n_cons_blocks;
 
+/* Lazy cons sweep.  GC sweeps only the newest cons block; the rest
+   are swept one at a time when Fcons runs out of free conses, and all
+   at once when Emacs waits for a command or when the next GC starts.
+   This takes the sweeping of the cons blocks out of the GC pause, but
+   not the marking, which takes most of it: the pause is not bounded.
+   See test/gc-pause-bench.el.  If this is non-null, the block
+   following it is the next one to sweep.  */
+
+static struct cons_block *cons_sweep_prev;
+
+/* Number of free conses found by the current lazy sweep so far.  */
+
+static int cons_sweep_free;
+
+static int sweep_cons_block P_ ((struct cons_block *, int,
+				 struct Lisp_Cons **));
+static int sweep_next_cons_block P_ ((void));
+
 
 /* Initialize cons allocation.  */
 
@@ -2715,6 +2869,7 @@ init_cons ()
   cons_block_index = CONS_BLOCK_SIZE; /* Force alloc of new cons_block.  */
   cons_free_list = 0;
   n_cons_blocks = 0;
+  cons_sweep_prev = NULL;
 }
 
 
@@ -2742,6 +2897,11 @@ DEFUN ("cons", Fcons, Scons, 2, 2, 0,
 
   MALLOC_BLOCK_INPUT;
 
+  /* Sweep blocks left over from the last GC until we find a free
+     cons, before resorting to a fresh one.  */
+  while (!cons_free_list && sweep_next_cons_block ())
+    ;
+
   if (cons_free_list)
     {
       /* We use the cdr for chaining the free list
@@ -2773,6 +2933,8 @@ DEFUN ("cons", Fcons, Scons, 2, 2, 0,
   eassert (!CONS_MARKED_P (XCONS (val)));
   consing_since_gc += sizeof (struct Lisp_Cons);
   cons_cells_consed++;
+  if (profiler_memory_running)
+    malloc_probe (sizeof (struct Lisp_Cons));
   return val;
 }
 
@@ -2903,7 +3065,54 @@ DEFUN ("make-list", Fmake_list, Smake_list, 2, 2, 0,
 			   Vector Allocation
  ***********************************************************************/
 
-/* Singly-linked list of all vectors.  */
+/* Small vectors are not allocated individually with lisp_malloc.
+   They are carved out of vector blocks instead, each of which holds
+   vectors of one size only.  There is a free list of vectors for
+   each size, and a list of the blocks holding vectors of that size.
+   Only the blocks are entered in the red-black tree of mem_nodes.
+   Larger vectors are allocated with lisp_malloc, and chained on
+   all_vectors.  */
+
+/* Vectors whose size is at most this many bytes are small.  */
+
+#define SMALL_VECTOR_MAX_BYTES (64 * sizeof (Lisp_Object))
+
+/* Number of size classes of small vectors.  The size of the vectors
+   in class N is N Lisp_Objects.  */
+
+#define VECTOR_SIZE_CLASSES (SMALL_VECTOR_MAX_BYTES / sizeof (Lisp_Object) + 1)
+
+/* Number of bytes of vector data in a vector block.  */
+
+#define VECTOR_BLOCK_BYTES \
+  (4 * 1020 - sizeof (struct vector_block *) - sizeof (int))
+
+struct vector_block
+{
+  /* Place `data' first, to preserve alignment.  */
+  char data[VECTOR_BLOCK_BYTES];
+  struct vector_block *next;
+
+  /* Size in bytes of the vectors in this block.  */
+  int nbytes;
+};
+
+/* The size field of vectors on a free list.  No live vector has all
+   pseudovector type bits set.  */
+
+#define VECTOR_FREE_SIZE (PSEUDOVECTOR_FLAG | PVEC_TYPE_MASK)
+
+/* For each size class, the list of vector blocks, and the free list
+   of vectors, chained through their `next' fields.  */
+
+static struct vector_block *vector_blocks[VECTOR_SIZE_CLASSES];
+static struct Lisp_Vector *vector_free_lists[VECTOR_SIZE_CLASSES];
+
+/* Number of vector blocks now in use.  */
+
+static int n_vector_blocks;
+
+/* Singly-linked list of all vectors that are not small.  */
 
 static struct Lisp_Vector *all_vectors;
 
@@ -2912,6 +3121,43 @@ static struct Lisp_Vector *all_vectors;
 static int n_vectors;
 
 
+/* Value is a pointer to a newly allocated small vector of NBYTES
+   bytes.  */
+
+static struct Lisp_Vector *
+allocate_small_vector (nbytes)
+     int nbytes;
+{
+  int size_class = nbytes / sizeof (Lisp_Object);
+  struct Lisp_Vector *p;
+
+  if (!vector_free_lists[size_class])
+    {
+      struct vector_block *b;
+      int i;
+
+      b = (struct vector_block *) lisp_malloc (sizeof *b,
+					       MEM_TYPE_VECTOR_BLOCK);
+      b->nbytes = nbytes;
+      b->next = vector_blocks[size_class];
+      vector_blocks[size_class] = b;
+      n_vector_blocks++;
+
+      for (i = VECTOR_BLOCK_BYTES / nbytes - 1; i >= 0; i--)
+	{
+	  p = (struct Lisp_Vector *) (b->data + i * nbytes);
+	  p->size = VECTOR_FREE_SIZE;
+	  p->next = vector_free_lists[size_class];
+	  vector_free_lists[size_class] = p;
+	}
+    }
+
+  p = vector_free_lists[size_class];
+  vector_free_lists[size_class] = p->next;
+  return p;
+}
+
+
 /* Value is a pointer to a newly allocated Lisp_Vector structure
    with room for LEN Lisp_Objects.  */
 
@@ -2922,6 +3168,22 @@ allocate_vectorlike (len)
   struct Lisp_Vector *p;
   size_t nbytes;
 
+  nbytes = sizeof *p + (len - 1) * sizeof p->contents[0];
+
+  if (nbytes <= SMALL_VECTOR_MAX_BYTES)
+    {
+      MALLOC_BLOCK_INPUT;
+      p = allocate_small_vector (nbytes);
+      MALLOC_UNBLOCK_INPUT;
+
+      consing_since_gc += nbytes;
+      vector_cells_consed += len;
+      ++n_vectors;
+      if (profiler_memory_running)
+	malloc_probe (nbytes);
+      return p;
+    }
+
   MALLOC_BLOCK_INPUT;
 
 #ifdef DOUG_LEA_MALLOC
@@ -2934,7 +3196,6 @@ allocate_vectorlike (len)
   /* This gets triggered by code which I haven't bothered to fix.  --Stef  */
   /* eassert (!handling_signal); */
 
-  nbytes = sizeof *p + (len - 1) * sizeof p->contents[0];
   p = (struct Lisp_Vector *) lisp_malloc (nbytes, MEM_TYPE_VECTORLIKE);
 
 #ifdef DOUG_LEA_MALLOC
@@ -2951,6 +3212,8 @@ allocate_vectorlike (len)
   MALLOC_UNBLOCK_INPUT;
 
   ++n_vectors;
+  if (profiler_memory_running)
+    malloc_probe (nbytes);
   return p;
 }
 
@@ -3210,6 +3473,7 @@ Its value and function definition are void, and its property list is nil.  */)
   p->gcmarkbit = 0;
   p->interned = SYMBOL_UNINTERNED;
   p->constant = 0;
+  p->declared_special = 0;
   p->indirect_variable = 0;
   consing_since_gc += sizeof (struct Lisp_Symbol);
   symbols_consed++;
@@ -4032,7 +4296,20 @@ live_vector_p (m, p)
      struct mem_node *m;
      void *p;
 {
-  return (p == m->start && m->type == MEM_TYPE_VECTORLIKE);
+  if (m->type == MEM_TYPE_VECTOR_BLOCK)
+    {
+      struct vector_block *b = (struct vector_block *) m->start;
+      int offset = (char *) p - b->data;
+
+      /* P must point to the start of a vector in the block, and the
+	 vector must not be on the free list.  */
+      return (offset >= 0
+	      && offset % b->nbytes == 0
+	      && offset / b->nbytes < VECTOR_BLOCK_BYTES / b->nbytes
+	      && ((struct Lisp_Vector *) p)->size != VECTOR_FREE_SIZE);
+    }
+  else
+    return (p == m->start && m->type == MEM_TYPE_VECTORLIKE);
 }
 
 
@@ -4231,6 +4508,7 @@ mark_maybe_pointer (p)
 	  break;
 
 	case MEM_TYPE_VECTORLIKE:
+	case MEM_TYPE_VECTOR_BLOCK:
 	  if (live_vector_p (m, p))
 	    {
 	      Lisp_Object tem;
@@ -4636,6 +4914,7 @@ valid_lisp_object_p (obj)
       return live_float_p (m, p);
 
     case MEM_TYPE_VECTORLIKE:
+    case MEM_TYPE_VECTOR_BLOCK:
       return live_vector_p (m, p);
 
     default:
@@ -4958,6 +5237,204 @@ inhibit_garbage_collection ()
 }
 
 
+/***********************************************************************
+			    GC Statistics
+ ***********************************************************************/
+
+/* Indices of the statistics recorded for each garbage collection.  */
+
+enum gc_stat
+{
+  /* Times, in seconds.  */
+  GC_STAT_START,		/* When the GC started, like `float-time'.  */
+  GC_STAT_INTERVAL,		/* Time since the previous GC ended.  */
+  GC_STAT_PAUSE,		/* Duration of the GC.  */
+  GC_STAT_MARK,			/* Time spent marking.  */
+  GC_STAT_STACK,		/* Part of that spent scanning the stack.  */
+  GC_STAT_SWEEP,		/* Time spent sweeping.  */
+  GC_STAT_STRINGS,		/* Part of that spent on strings.  */
+
+  /* Sizes, in bytes.  */
+  GC_STAT_CONSED,		/* Bytes consed since the previous GC.  */
+  GC_STAT_CONSES,		/* Bytes reclaimed, by type of object.  */
+  GC_STAT_SYMBOLS,
+  GC_STAT_MISCS,
+  GC_STAT_STRING_BYTES,
+  GC_STAT_VECTORS,
+  GC_STAT_FLOATS,
+  GC_STAT_INTERVALS,
+
+  GC_STAT_MAX
+};
+
+#define GC_STAT_FIRST_SIZE GC_STAT_CONSED
+
+/* Names of the statistics in the plists returned by `gc-statistics'.  */
+
+static char *gc_stat_names[GC_STAT_MAX] =
+  {
+    ":start", ":interval", ":pause", ":mark", ":stack-scan", ":sweep",
+    ":string-sweep", ":consed", ":conses", ":symbols", ":miscs",
+    ":strings", ":vectors", ":floats", ":intervals"
+  };
+
+/* A vector of keywords made from gc_stat_names.  */
+
+static Lisp_Object gc_stat_keywords;
+
+/* The statistics of the GC in progress, or of the last GC.  */
+
+static double gc_stat[GC_STAT_MAX];
+
+/* Statistics of recent GCs are kept in a ring buffer of
+   `gc-statistics-log-size' entries.  GC_LOG_NEXT is the entry to
+   write next, and GC_LOG_COUNT the number of entries in use.  */
+
+EMACS_INT gc_statistics_log_size;
+static double (*gc_log)[GC_STAT_MAX];
+static int gc_log_alloc, gc_log_next, gc_log_count;
+
+/* When the previous GC ended, or zero.  */
+
+static EMACS_TIME gc_last_end;
+
+/* The value of gc_bytes_freed for each type of object at the end of
+   the previous GC.  */
+
+static double gc_freed_before[GC_STAT_MAX];
+
+
+/* Value is the number of seconds elapsed since T0.  */
+
+static double
+gc_seconds_since (t0)
+     EMACS_TIME t0;
+{
+  EMACS_TIME t, d;
+
+  EMACS_GET_TIME (t);
+  EMACS_SUB_TIME (d, t, t0);
+  return EMACS_SECS (d) + EMACS_USECS (d) * 1.0e-6;
+}
+
+
+/* Value is the number of bytes of objects of the type corresponding
+   to STAT that have ever been freed.  This is what has been consed
+   minus what is live after the last sweep.  */
+
+static double
+gc_bytes_freed (stat)
+     enum gc_stat stat;
+{
+  switch (stat)
+    {
+    case GC_STAT_CONSES:
+      return ((double) cons_cells_consed - total_conses)
+	* sizeof (struct Lisp_Cons);
+    case GC_STAT_SYMBOLS:
+      return ((double) symbols_consed - total_symbols)
+	* sizeof (struct Lisp_Symbol);
+    case GC_STAT_MISCS:
+      return ((double) misc_objects_consed - total_markers)
+	* sizeof (union Lisp_Misc);
+    case GC_STAT_STRING_BYTES:
+      return (((double) strings_consed - total_strings)
+	      * sizeof (struct Lisp_String)
+	      + ((double) string_chars_consed - total_string_size));
+    case GC_STAT_VECTORS:
+      return ((double) vector_cells_consed - total_vector_size)
+	* sizeof (Lisp_Object);
+    case GC_STAT_FLOATS:
+      return ((double) floats_consed - total_floats)
+	* sizeof (struct Lisp_Float);
+    case GC_STAT_INTERVALS:
+      return ((double) intervals_consed - total_intervals)
+	* sizeof (struct interval);
+    default:
+      abort ();
+    }
+}
+
+
+/* Complete gc_stat at the end of a GC that started at T1, and add it
+   to the ring buffer.  */
+
+static void
+gc_record_stats (t1)
+     EMACS_TIME t1;
+{
+  int i;
+
+  gc_stat[GC_STAT_PAUSE] = gc_seconds_since (t1);
+
+  for (i = GC_STAT_CONSES; i < GC_STAT_MAX; i++)
+    {
+      double freed = gc_bytes_freed (i);
+      gc_stat[i] = max (0, freed - gc_freed_before[i]);
+      gc_freed_before[i] = freed;
+    }
+
+  EMACS_GET_TIME (gc_last_end);
+
+  if (gc_statistics_log_size != gc_log_alloc)
+    {
+      /* The size was changed; start over.  */
+      gc_log_alloc = max (0, min (gc_statistics_log_size, 100000));
+      gc_statistics_log_size = gc_log_alloc;
+      gc_log = (double (*)[GC_STAT_MAX])
+	xrealloc (gc_log, max (1, gc_log_alloc) * sizeof *gc_log);
+      gc_log_next = gc_log_count = 0;
+    }
+
+  if (gc_log_alloc > 0)
+    {
+      bcopy (gc_stat, gc_log[gc_log_next], sizeof gc_stat);
+      gc_log_next = (gc_log_next + 1) % gc_log_alloc;
+      if (gc_log_count < gc_log_alloc)
+	gc_log_count++;
+    }
+}
+
+
+/* Value is a plist describing the GC statistics STAT.  */
+
+static Lisp_Object
+gc_stat_to_plist (stat)
+     double *stat;
+{
+  Lisp_Object plist = Qnil, value;
+  int i;
+
+  for (i = GC_STAT_MAX - 1; i >= 0; i--)
+    {
+      if (i < GC_STAT_FIRST_SIZE)
+	value = make_float (stat[i]);
+      else if (stat[i] > MOST_POSITIVE_FIXNUM)
+	value = make_float (stat[i]);
+      else
+	value = make_number ((EMACS_INT) stat[i]);
+      plist = Fcons (AREF (gc_stat_keywords, i), Fcons (value, plist));
+    }
+
+  return plist;
+}
+
+
+/* Handle an error in `post-gc-functions'.  */
+
+static Lisp_Object
+post_gc_functions_error (data)
+     Lisp_Object data;
+{
+  Lisp_Object args[2];
+
+  args[0] = build_string ("Error in post-gc-functions: %S");
+  args[1] = data;
+  Fmessage (2, args);
+  return Qnil;
+}
+
+
 DEFUN ("garbage-collect", Fgarbage_collect, Sgarbage_collect, 0, 0, "",
        doc: /* Reclaim storage for Lisp objects no longer needed.
 Garbage collection happens automatically if you cons more than
@@ -4979,7 +5456,7 @@ returns nil, because real GC can't be done.  */)
   int message_p;
   Lisp_Object total[8];
   int count = SPECPDL_INDEX ();
-  EMACS_TIME t1, t2, t3;
+  EMACS_TIME t1, t2, t3, tphase, tstack;
 
   if (abort_on_gc)
     abort ();
@@ -5028,6 +5505,13 @@ returns nil, because real GC can't be done.  */)
   }
 
   EMACS_GET_TIME (t1);
+  gc_stat[GC_STAT_START] = EMACS_SECS (t1) + EMACS_USECS (t1) * 1.0e-6;
+  if (EMACS_SECS (gc_last_end) || EMACS_USECS (gc_last_end))
+    gc_stat[GC_STAT_INTERVAL] = gc_seconds_since (gc_last_end);
+  else
+    gc_stat[GC_STAT_INTERVAL] = 0;
+  gc_stat[GC_STAT_CONSED] = consing_since_gc;
+  gc_stat[GC_STAT_STACK] = 0;
 
   /* In case user calls debug_print during GC,
      don't let that cause a recursive GC.  */
@@ -5067,7 +5551,12 @@ returns nil, because real GC can't be done.  */)
 
   shrink_regexp_cache ();
 
+  /* The mark bits of conses not yet swept after the last GC must be
+     cleared before we can mark again.  */
+  sweep_pending_conses ();
+
   gc_in_progress = 1;
+  EMACS_GET_TIME (tphase);
 
   /* clear_marks (); */
 
@@ -5094,7 +5583,9 @@ returns nil, because real GC can't be done.  */)
 
 #if (GC_MARK_STACK == GC_MAKE_GCPROS_NOOPS \
      || GC_MARK_STACK == GC_MARK_STACK_CHECK_GCPROS)
+  EMACS_GET_TIME (tstack);
   mark_stack ();
+  gc_stat[GC_STAT_STACK] = gc_seconds_since (tstack);
 #else
   {
     register struct gcpro *tail;
@@ -5116,13 +5607,16 @@ returns nil, because real GC can't be done.  */)
       mark_object (handler->var);
     }
   mark_backtrace ();
+  mark_profiler ();
 
 #ifdef HAVE_WINDOW_SYSTEM
   mark_fringe_data ();
 #endif
 
 #if GC_MARK_STACK == GC_USE_GCPROS_CHECK_ZOMBIES
+  EMACS_GET_TIME (tstack);
   mark_stack ();
+  gc_stat[GC_STAT_STACK] = gc_seconds_since (tstack);
 #endif
 
   /* Everything is now marked, except for the things that require special
@@ -5173,7 +5667,10 @@ returns nil, because real GC can't be done.  */)
       }
   }
 
+  gc_stat[GC_STAT_MARK] = gc_seconds_since (tphase);
+  EMACS_GET_TIME (tphase);
   gc_sweep ();
+  gc_stat[GC_STAT_SWEEP] = gc_seconds_since (tphase);
 
   /* Clear the mark bits that we set in certain root slots.  */
 
@@ -5256,6 +5753,8 @@ returns nil, because real GC can't be done.  */)
     }
 #endif
 
+  gc_record_stats (t1);
+
   if (!NILP (Vpost_gc_hook))
     {
       int count = inhibit_garbage_collection ();
@@ -5263,6 +5762,18 @@ returns nil, because real GC can't be done.  */)
       unbind_to (count, Qnil);
     }
 
+  if (!NILP (Vpost_gc_functions))
+    {
+      int count = inhibit_garbage_collection ();
+      Lisp_Object args[2];
+
+      args[0] = Qpost_gc_functions;
+      args[1] = gc_stat_to_plist (gc_stat);
+      internal_condition_case_2 (Frun_hook_with_args, 2, args, Qt,
+				 post_gc_functions_error);
+      unbind_to (count, Qnil);
+    }
+
   /* Accumulate statistics.  */
   EMACS_GET_TIME (t2);
   EMACS_SUB_TIME (t3, t2, t1);
@@ -5276,6 +5787,67 @@ returns nil, because real GC can't be done.  */)
 }
 
 
+/* Value is the number of bytes that can be consed after a GC before
+   garbage is collected automatically.  */
+
+EMACS_INT
+gc_threshold ()
+{
+  return max (gc_cons_threshold, gc_relative_threshold);
+}
+
+
+/* Value is non-zero if more than `gc-cons-idle-fraction' of the
+   consing that triggers a GC has been done.  read_char then collects
+   garbage once Emacs has been idle for `gc-idle-delay' seconds, so
+   that the GC which is due soon anyway happens while the user isn't
+   waiting for a command to finish.  */
+
+int
+gc_due_when_idle ()
+{
+  return (NUMBERP (Vgc_cons_idle_fraction)
+	  && (consing_since_gc
+	      > XFLOATINT (Vgc_cons_idle_fraction) * gc_threshold ()));
+}
+
+
+DEFUN ("gc-statistics", Fgc_statistics, Sgc_statistics, 0, 1, 0,
+       doc: /* Return statistics about the last garbage collection.
+The value is a plist with the following properties:
+
+ :start         when the garbage collection started, like `float-time'
+ :interval      seconds since the previous garbage collection ended
+ :pause         seconds the garbage collection took
+ :mark          seconds spent marking live objects
+ :stack-scan    seconds of :mark spent scanning the C stack
+ :sweep         seconds spent freeing dead objects
+ :string-sweep  seconds of :sweep spent on strings, including compaction
+ :consed        bytes consed since the previous garbage collection
+ :conses, :symbols, :miscs, :strings, :vectors, :floats, :intervals
+                bytes of each type of object that were reclaimed
+
+The value is nil if there hasn't been a garbage collection yet.
+
+If ALL is non-nil, return a list of such plists for the most recent
+garbage collections, most recent first.  See `gc-statistics-log-size'.  */)
+     (all)
+     Lisp_Object all;
+{
+  Lisp_Object val = Qnil;
+  int i;
+
+  if (NILP (all))
+    return gcs_done ? gc_stat_to_plist (gc_stat) : Qnil;
+
+  for (i = gc_log_count; i > 0; i--)
+    val = Fcons (gc_stat_to_plist (gc_log[(gc_log_next - i + gc_log_alloc)
+					   % gc_log_alloc]),
+		 val);
+  return val;
+}
+
+
 /* Mark Lisp objects in glyph matrix MATRIX.  Currently the
    only interesting objects referenced from glyphs are strings.  */
 
@@ -5329,18 +5901,92 @@ mark_face_cache (c)
 
 
 /* Mark reference to a Lisp_Object.
-   If the object referred to has not been seen yet, recursively mark
-   all the references contained in it.  */
+   If the object referred to has not been seen yet, mark it and all
+   the references contained in it.  */
 
 #define LAST_MARKED_SIZE 500
 static Lisp_Object last_marked[LAST_MARKED_SIZE];
 int last_marked_index;
 
-/* For debugging--call abort when we cdr down this many
-   links of a list, in mark_object.  In debugging,
-   the call to abort will hit a breakpoint.
-   Normally this is zero and the check never goes off.  */
-static int mark_object_loop_halt;
+/* Instead of recursing into the objects referenced by an object
+   being marked, mark_object pushes the Lisp_Object slots holding
+   them on a mark stack, and loops until the stack is empty.  This
+   keeps deep lists and nested vectors from overflowing the C stack.
+   An entry of the mark stack describes a run of consecutive slots of
+   some object, e.g. the contents of a vector, still to be marked.
+   The stack lives in the heap and grows as needed.  */
+
+struct mark_stack_entry
+{
+  /* Next slot to mark.  */
+  Lisp_Object *pos;
+
+  /* End of the run of slots.  */
+  Lisp_Object *end;
+};
+
+/* Bottom, top and end of the allocated space of the mark stack.  */
+
+static struct mark_stack_entry *mark_stack_bottom;
+static struct mark_stack_entry *mark_stack_ptr;
+static struct mark_stack_entry *mark_stack_end;
+
+/* Nonzero while the outermost mark_object is processing the mark
+   stack.  Nested calls only push on the stack.  */
+
+static int mark_stack_busy;
+
+/* Initial number of entries of the mark stack.  */
+
+#define MARK_STACK_INITIAL_SIZE 1024
+
+/* Push the N slots starting at POS on the mark stack.  */
+
+static INLINE void
+mark_stack_push (pos, n)
+     Lisp_Object *pos;
+     EMACS_INT n;
+{
+  if (n <= 0)
+    return;
+
+  if (mark_stack_ptr == mark_stack_end)
+    {
+      int size = mark_stack_end - mark_stack_bottom;
+      int nsize = size ? 2 * size : MARK_STACK_INITIAL_SIZE;
+
+      mark_stack_bottom
+	= (struct mark_stack_entry *) xrealloc (mark_stack_bottom,
+						nsize * sizeof *mark_stack_bottom);
+      mark_stack_ptr = mark_stack_bottom + size;
+      mark_stack_end = mark_stack_bottom + nsize;
+    }
+
+  mark_stack_ptr->pos = pos;
+  mark_stack_ptr->end = pos + n;
+  mark_stack_ptr++;
+}
+
+/* Pop the next object to mark from the mark stack, which must not
+   be empty.  */
+
+static INLINE Lisp_Object
+mark_stack_pop ()
+{
+  struct mark_stack_entry *e = mark_stack_ptr - 1;
+  Lisp_Object obj = *e->pos++;
+
+  if (e->pos == e->end)
+    mark_stack_ptr--;
+
+#ifdef __GNUC__
+  /* Start fetching the header of the object we will look at next.  */
+  if (mark_stack_ptr != mark_stack_bottom)
+    __builtin_prefetch ((void *) XPNTR (*mark_stack_ptr[-1].pos));
+#endif
+
+  return obj;
+}
 
 /* Return non-zero if the object was not yet marked.  */
 static int
@@ -5348,7 +5994,6 @@ mark_vectorlike (ptr)
      struct Lisp_Vector *ptr;
 {
   register EMACS_INT size = ptr->size;
-  register int i;
 
   if (VECTOR_MARKED_P (ptr))
     return 0;			/* Already marked */
@@ -5360,8 +6005,7 @@ mark_vectorlike (ptr)
      the number of Lisp_Object fields that we should trace.
      The distinction is used e.g. by Lisp_Process which places extra
      non-Lisp_Object fields at the end of the structure.  */
-  for (i = 0; i < size; i++) /* and then mark its elements */
-    mark_object (ptr->contents[i]);
+  mark_stack_push (ptr->contents, size); /* and then mark its elements */
   return 1;
 }
 
@@ -5402,12 +6046,18 @@ mark_object (arg)
   void *po;
   struct mem_node *m;
 #endif
-  int cdr_count = 0;
+  int outermost_p = !mark_stack_busy;
+
+  mark_stack_busy = 1;
 
  loop:
 
   if (PURE_POINTER_P (XPNTR (obj)))
-    return;
+    goto next;
+
+  /* Let entries of weak hash tables waiting for OBJ know.  */
+  if (weak_hash_waiting)
+    weak_hash_object_marked (obj);
 
   last_marked[last_marked_index++] = obj;
   if (last_marked_index == LAST_MARKED_SIZE)
@@ -5503,7 +6153,6 @@ mark_object (arg)
 	{
 	  register struct Lisp_Vector *ptr = XVECTOR (obj);
 	  register EMACS_INT size = ptr->size;
-	  register int i;
 
 	  if (VECTOR_MARKED_P (ptr))
 	    break;   /* Already marked */
@@ -5511,11 +6160,10 @@ mark_object (arg)
 	  CHECK_LIVE (live_vector_p);
 	  VECTOR_MARK (ptr);	/* Else mark it */
 	  size &= PSEUDOVECTOR_SIZE_MASK;
-	  for (i = 0; i < size; i++) /* and then mark its elements */
-	    {
-	      if (i != COMPILED_CONSTANTS)
-		mark_object (ptr->contents[i]);
-	    }
+	  /* and then mark its elements */
+	  mark_stack_push (ptr->contents, COMPILED_CONSTANTS);
+	  mark_stack_push (ptr->contents + COMPILED_CONSTANTS + 1,
+			   size - COMPILED_CONSTANTS - 1);
 	  obj = ptr->contents[COMPILED_CONSTANTS];
 	  goto loop;
 	}
@@ -5550,7 +6198,7 @@ mark_object (arg)
 	    { /* If hash table is not weak, mark all keys and values.
 		 For weak tables, mark only the vector.  */
 	      if (NILP (h->weak))
-		mark_object (h->key_and_value);
+		mark_stack_push (&h->key_and_value, 1);
 	      else
 		VECTOR_MARK (XVECTOR (h->key_and_value));
 	    }
@@ -5572,9 +6220,8 @@ mark_object (arg)
 	if (ptr->gcmarkbit) break;
 	CHECK_ALLOCATED_AND_LIVE (live_symbol_p);
 	ptr->gcmarkbit = 1;
-	mark_object (ptr->value);
-	mark_object (ptr->function);
-	mark_object (ptr->plist);
+	/* Mark the value, function and plist slots.  */
+	mark_stack_push (&ptr->value, 3);
 
 	if (!PURE_POINTER_P (XSTRING (ptr->xname)))
 	  MARK_STRING (XSTRING (ptr->xname));
@@ -5605,15 +6252,9 @@ mark_object (arg)
 	  {
 	    register struct Lisp_Buffer_Local_Value *ptr
 	      = XBUFFER_LOCAL_VALUE (obj);
-	    /* If the cdr is nil, avoid recursion for the car.  */
-	    if (EQ (ptr->cdr, Qnil))
-	      {
-		obj = ptr->realvalue;
-		goto loop;
-	      }
-	    mark_object (ptr->realvalue);
-	    mark_object (ptr->buffer);
-	    mark_object (ptr->frame);
+	    mark_stack_push (&ptr->realvalue, 1);
+	    mark_stack_push (&ptr->buffer, 1);
+	    mark_stack_push (&ptr->frame, 1);
 	    obj = ptr->cdr;
 	    goto loop;
 	  }
@@ -5655,9 +6296,9 @@ mark_object (arg)
 	case Lisp_Misc_Overlay:
 	  {
 	    struct Lisp_Overlay *ptr = XOVERLAY (obj);
-	    mark_object (ptr->start);
-	    mark_object (ptr->end);
-	    mark_object (ptr->plist);
+	    mark_stack_push (&ptr->start, 1);
+	    mark_stack_push (&ptr->end, 1);
+	    mark_stack_push (&ptr->plist, 1);
 	    if (ptr->next)
 	      {
 		XSETMISC (obj, ptr->next);
@@ -5677,18 +6318,12 @@ mark_object (arg)
 	if (CONS_MARKED_P (ptr)) break;
 	CHECK_ALLOCATED_AND_LIVE (live_cons_p);
 	CONS_MARK (ptr);
-	/* If the cdr is nil, avoid recursion for the car.  */
-	if (EQ (ptr->u.cdr, Qnil))
-	  {
-	    obj = ptr->car;
-	    cdr_count = 0;
-	    goto loop;
-	  }
-	mark_object (ptr->car);
-	obj = ptr->u.cdr;
-	cdr_count++;
-	if (cdr_count == mark_object_loop_halt)
-	  abort ();
+	/* Mark the car right away and leave the cdr for later.  This
+	   keeps the mark stack shallow for long lists whose elements
+	   are themselves lists.  */
+	if (!NILP (ptr->u.cdr))
+	  mark_stack_push (&ptr->u.cdr, 1);
+	obj = ptr->car;
 	goto loop;
       }
 
@@ -5704,6 +6339,19 @@ mark_object (arg)
       abort ();
     }
 
+ next:
+  /* The outermost call does the marking of everything that has been
+     pushed on the mark stack meanwhile.  */
+  if (outermost_p)
+    {
+      if (mark_stack_ptr != mark_stack_bottom)
+	{
+	  obj = mark_stack_pop ();
+	  goto loop;
+	}
+      mark_stack_busy = 0;
+    }
+
 #undef CHECK_LIVE
 #undef CHECK_ALLOCATED
 #undef CHECK_ALLOCATED_AND_LIVE
@@ -5740,10 +6388,8 @@ mark_buffer (buf)
 
   /* buffer-local Lisp variables start at `undo_list',
      tho only the ones from `name' on are GC'd normally.  */
-  for (ptr = &buffer->name;
-       (char *)ptr < (char *)buffer + sizeof (struct buffer);
-       ptr++)
-    mark_object (*ptr);
+  ptr = &buffer->name;
+  mark_stack_push (ptr, (Lisp_Object *) (buffer + 1) - ptr);
 
   /* If this is an indirect buffer, mark its base buffer.  */
   if (buffer->base_buffer && !VECTOR_MARKED_P (buffer->base_buffer))
@@ -5760,13 +6406,15 @@ static void
 mark_terminals (void)
 {
   struct terminal *t;
+  Lisp_Object tem;
   for (t = terminal_list; t; t = t->next_terminal)
     {
       eassert (t->name != NULL);
 #ifdef HAVE_WINDOW_SYSTEM
       mark_image_cache (t->image_cache);
 #endif /* HAVE_WINDOW_SYSTEM */
-      mark_vectorlike ((struct Lisp_Vector *)t);
+      XSETTERMINAL (tem, t);
+      mark_object (tem);
     }
 }
 
@@ -5820,138 +6468,668 @@ survives_gc_p (obj)
 
 
 
-/* Sweep: find all structures not marked, and free them. */
+/* The sweep of cons, float and symbol blocks can be split between
+   several threads, see `gc-sweep-threads'.  Each thread sweeps a
+   consecutive run of blocks, building a free list of its own.  The
+   main thread then concatenates the free lists, and decides which of
+   the blocks that turned out to be entirely free to deallocate.  The
+   threads do nothing but look at and modify the blocks, so that
+   nothing else needs to be thread-safe.  */
 
-static void
-gc_sweep ()
-{
-  /* Remove or mark entries in weak hash tables.
+/* Maximum number of threads used for sweeping.  */
+
+#define MAX_SWEEP_THREADS 16
+
+/* Don't start a thread for sweeping fewer blocks than this.  */
+
+#define MIN_SWEEP_BLOCKS_PER_THREAD 32
+
+/* Number of threads to use for sweeping.  */
+
+EMACS_INT gc_sweep_threads;
+
+/* The blocks being swept, in the order of their block list, and the
+   number of free objects found in each of them.  */
+
+static void **sweep_blocks;
+static int *sweep_nfree;
+static int sweep_blocks_size;
+
+/* A run of blocks swept by one thread.  */
+
+struct sweep_part
+{
+  /* The blocks to sweep, their number, and where to record the
+     number of free objects found in each of them.  */
+  void **blocks;
+  int nblocks;
+  int *nfree;
+
+  /* Number of objects found in use.  */
+  int nused;
+
+  /* Head and last element of the free list built from the blocks.
+     The objects of blocks that are entirely free are not on it.  */
+  void *head, *tail;
+};
+
+/* Make sweep_blocks and sweep_nfree big enough for N blocks.  */
+
+static void
+ensure_sweep_blocks (n)
+     int n;
+{
+  if (n > sweep_blocks_size)
+    {
+      sweep_blocks_size = max (n, 2 * sweep_blocks_size);
+      sweep_blocks = (void **) xrealloc (sweep_blocks,
+					 sweep_blocks_size * sizeof *sweep_blocks);
+      sweep_nfree = (int *) xrealloc (sweep_nfree,
+				      sweep_blocks_size * sizeof *sweep_nfree);
+    }
+}
+
+#ifdef HAVE_PTHREAD
+
+/* The threads that sweep besides the main thread are started when
+   the first sweep needs them, and then wait for work for the rest of
+   the session.  SWEEP_WORKERS[I] sweeps the part I + 1 of a sweep.
+
+   configure defines HAVE_PTHREAD whenever -lpthread exists, but
+   gmalloc.c only serializes calls to malloc if HAVE_GTK_AND_PTHREAD
+   is defined, and the malloc hooks above block input without any
+   lock otherwise.  That is why the workers must never call malloc or
+   free, directly or through the C library: apart from the blocks they
+   are given, they only use the mutex and condition variables below,
+   which are statically initialized, and they never exit.  Starting
+   them happens in the main thread.  */
+
+struct sweep_worker
+{
+  pthread_t thread;
+
+  /* The part to sweep, or null while there is nothing to do.  */
+  struct sweep_part *part;
+};
+
+static struct sweep_worker sweep_workers[MAX_SWEEP_THREADS - 1];
+
+/* Number of elements of sweep_workers whose thread is running.  */
+
+static int n_sweep_workers;
+
+/* The function that the workers call on their parts.  */
+
+static void *(*sweep_function) P_ ((void *));
+
+/* Number of parts that workers have been given and not finished.  */
+
+static int sweep_parts_pending;
+
+/* SWEEP_MUTEX protects the variables above.  The workers wait on
+   SWEEP_START for a part, and the main thread waits on SWEEP_DONE
+   until sweep_parts_pending is zero.  */
+
+static pthread_mutex_t sweep_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sweep_start = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t sweep_done = PTHREAD_COND_INITIALIZER;
+
+/* The body of the thread of the struct sweep_worker ARG.  */
+
+static void *
+sweep_worker_loop (arg)
+     void *arg;
+{
+  struct sweep_worker *worker = (struct sweep_worker *) arg;
+
+  pthread_mutex_lock (&sweep_mutex);
+  for (;;)
+    {
+      struct sweep_part *part;
+      void *(*fn) P_ ((void *));
+
+      while (!worker->part)
+	pthread_cond_wait (&sweep_start, &sweep_mutex);
+      part = worker->part;
+      fn = sweep_function;
+      pthread_mutex_unlock (&sweep_mutex);
+
+      fn (part);
+
+      pthread_mutex_lock (&sweep_mutex);
+      worker->part = NULL;
+      if (--sweep_parts_pending == 0)
+	pthread_cond_signal (&sweep_done);
+    }
+  return NULL;
+}
+
+/* Make sure that N workers are running, if possible.  Value is the
+   number of workers that are.  */
+
+static int
+start_sweep_workers (n)
+     int n;
+{
+  sigset_t blocked, oldset;
+
+  if (n <= n_sweep_workers)
+    return n_sweep_workers;
+
+  /* Signal handlers must run in the main thread, so start the
+     workers with all signals blocked.  */
+  sigfillset (&blocked);
+  pthread_sigmask (SIG_SETMASK, &blocked, &oldset);
+  while (n_sweep_workers < n)
+    {
+      struct sweep_worker *worker = &sweep_workers[n_sweep_workers];
+
+      worker->part = NULL;
+      if (pthread_create (&worker->thread, NULL, sweep_worker_loop,
+			  worker) != 0)
+	break;
+      n_sweep_workers++;
+    }
+  pthread_sigmask (SIG_SETMASK, &oldset, NULL);
+  return n_sweep_workers;
+}
+
+#endif /* HAVE_PTHREAD */
+
+/* Sweep the first NBLOCKS blocks of sweep_blocks by calling FN on
+   one or more struct sweep_part, the first in the main thread and the
+   others in workers.  Fill PARTS with the results.  Value is the
+   number of parts.  */
+
+static int
+sweep_parts (fn, nblocks, parts)
+     void *(*fn) P_ ((void *));
+     int nblocks;
+     struct sweep_part *parts;
+{
+  int nparts = 1, i, start;
+
+#ifdef HAVE_PTHREAD
+  if (gc_sweep_threads > 1)
+    nparts = min (min (gc_sweep_threads, MAX_SWEEP_THREADS),
+		  nblocks / MIN_SWEEP_BLOCKS_PER_THREAD);
+  if (nparts > 1)
+    nparts = 1 + start_sweep_workers (nparts - 1);
+  if (nparts < 1)
+    nparts = 1;
+#endif
+
+  for (i = start = 0; i < nparts; i++)
+    {
+      int n = (nblocks - start) / (nparts - i);
+
+      parts[i].blocks = sweep_blocks + start;
+      parts[i].nfree = sweep_nfree + start;
+      parts[i].nblocks = n;
+      parts[i].nused = 0;
+      parts[i].head = parts[i].tail = NULL;
+      start += n;
+    }
+
+#ifdef HAVE_PTHREAD
+  if (nparts > 1)
+    {
+      pthread_mutex_lock (&sweep_mutex);
+      sweep_function = fn;
+      sweep_parts_pending = nparts - 1;
+      for (i = 1; i < nparts; i++)
+	sweep_workers[i - 1].part = &parts[i];
+      pthread_cond_broadcast (&sweep_start);
+      pthread_mutex_unlock (&sweep_mutex);
+    }
+#endif
+
+  fn (&parts[0]);
+
+#ifdef HAVE_PTHREAD
+  if (nparts > 1)
+    {
+      pthread_mutex_lock (&sweep_mutex);
+      while (sweep_parts_pending > 0)
+	pthread_cond_wait (&sweep_done, &sweep_mutex);
+      pthread_mutex_unlock (&sweep_mutex);
+    }
+#endif
+
+  return nparts;
+}
+
+/* Sweep the cons blocks of the struct sweep_part ARG.  */
+
+static void *
+sweep_cons_part (arg)
+     void *arg;
+{
+  struct sweep_part *part = (struct sweep_part *) arg;
+  struct Lisp_Cons *head = NULL, *tail;
+  int i;
+
+  for (i = 0; i < part->nblocks; i++)
+    {
+      struct cons_block *cblk = (struct cons_block *) part->blocks[i];
+      int this_free = sweep_cons_block (cblk, CONS_BLOCK_SIZE, &head);
+
+      part->nfree[i] = this_free;
+      if (this_free == CONS_BLOCK_SIZE)
+	/* Unhook from the free list.  */
+	head = cblk->conses[0].u.chain;
+    }
+
+  for (tail = head; tail && tail->u.chain; tail = tail->u.chain)
+    ;
+  part->head = head;
+  part->tail = tail;
+  return NULL;
+}
+
+/* Put the unmarked floats among the first LIM ones in FBLK on the
+   free list *FREE_LIST, and unmark the others.  Add the number of
+   floats in use to *NUSED.  Value is the number of floats freed.  */
+
+static int
+sweep_float_block (fblk, lim, free_list, nused)
+     struct float_block *fblk;
+     int lim;
+     struct Lisp_Float **free_list;
+     int *nused;
+{
+  int this_free = 0, num_used = 0;
+  int i;
+
+  for (i = 0; i < lim; i++)
+    if (!FLOAT_MARKED_P (&fblk->floats[i]))
+      {
+	this_free++;
+	fblk->floats[i].u.chain = *free_list;
+	*free_list = &fblk->floats[i];
+      }
+    else
+      {
+	num_used++;
+	FLOAT_UNMARK (&fblk->floats[i]);
+      }
+
+  *nused += num_used;
+  return this_free;
+}
+
+/* Sweep the float blocks of the struct sweep_part ARG.  */
+
+static void *
+sweep_float_part (arg)
+     void *arg;
+{
+  struct sweep_part *part = (struct sweep_part *) arg;
+  struct Lisp_Float *head = NULL, *tail;
+  int i;
+
+  for (i = 0; i < part->nblocks; i++)
+    {
+      struct float_block *fblk = (struct float_block *) part->blocks[i];
+      int lim = fblk == float_block ? float_block_index : FLOAT_BLOCK_SIZE;
+      int this_free = sweep_float_block (fblk, lim, &head, &part->nused);
+
+      part->nfree[i] = this_free;
+      if (this_free == FLOAT_BLOCK_SIZE)
+	/* Unhook from the free list.  */
+	head = fblk->floats[0].u.chain;
+    }
+
+  for (tail = head; tail && tail->u.chain; tail = tail->u.chain)
+    ;
+  part->head = head;
+  part->tail = tail;
+  return NULL;
+}
+
+/* Put the unmarked symbols among the first LIM ones in SBLK on the
+   free list *FREE_LIST, and unmark the others.  Add the number of
+   symbols in use to *NUSED.  Value is the number of symbols freed.  */
+
+static int
+sweep_symbol_block (sblk, lim, free_list, nused)
+     struct symbol_block *sblk;
+     int lim;
+     struct Lisp_Symbol **free_list;
+     int *nused;
+{
+  struct Lisp_Symbol *sym = sblk->symbols;
+  struct Lisp_Symbol *end = sym + lim;
+  int this_free = 0, num_used = 0;
+
+  for (; sym < end; ++sym)
+    {
+      /* Check if the symbol was created during loadup.  In such a case
+	 it might be pointed to by pure bytecode which we don't trace,
+	 so we conservatively assume that it is live.  */
+      int pure_p = PURE_POINTER_P (XSTRING (sym->xname));
+
+      if (!sym->gcmarkbit && !pure_p)
+	{
+	  sym->next = *free_list;
+	  *free_list = sym;
+#if GC_MARK_STACK
+	  sym->function = Vdead;
+#endif
+	  ++this_free;
+	}
+      else
+	{
+	  ++num_used;
+	  if (!pure_p)
+	    UNMARK_STRING (XSTRING (sym->xname));
+	  sym->gcmarkbit = 0;
+	}
+    }
+
+  *nused += num_used;
+  return this_free;
+}
+
+/* Sweep the symbol blocks of the struct sweep_part ARG.  */
+
+static void *
+sweep_symbol_part (arg)
+     void *arg;
+{
+  struct sweep_part *part = (struct sweep_part *) arg;
+  struct Lisp_Symbol *head = NULL, *tail;
+  int i;
+
+  for (i = 0; i < part->nblocks; i++)
+    {
+      struct symbol_block *sblk = (struct symbol_block *) part->blocks[i];
+      int lim = sblk == symbol_block ? symbol_block_index : SYMBOL_BLOCK_SIZE;
+      int this_free = sweep_symbol_block (sblk, lim, &head, &part->nused);
+
+      part->nfree[i] = this_free;
+      if (this_free == SYMBOL_BLOCK_SIZE)
+	/* Unhook from the free list.  */
+	head = sblk->symbols[0].next;
+    }
+
+  for (tail = head; tail && tail->next; tail = tail->next)
+    ;
+  part->head = head;
+  part->tail = tail;
+  return NULL;
+}
+
+
+/* Value is the number of bits set in the N ints at BITS.  */
+
+static int
+count_mark_bits (bits, n)
+     int *bits;
+     int n;
+{
+  int count = 0;
+
+  while (n-- > 0)
+    {
+#ifdef __GNUC__
+      count += __builtin_popcount (*bits++);
+#else
+      unsigned int x = *bits++;
+      for (; x; x &= x - 1)
+	count++;
+#endif
+    }
+  return count;
+}
+
+
+/* Put the unmarked conses among the first LIM ones in CBLK on the
+   free list *FREE_LIST, and unmark the others.  Value is the number
+   of conses freed.  */
+
+static int
+sweep_cons_block (cblk, lim, free_list)
+     struct cons_block *cblk;
+     int lim;
+     struct Lisp_Cons **free_list;
+{
+  int ilim = (lim + BITS_PER_INT - 1) / BITS_PER_INT;
+  int this_free = 0;
+  int i;
+
+  /* Scan the mark bits an int at a time.  */
+  for (i = 0; i < ilim; i++)
+    {
+      if (cblk->gcmarkbits[i] == -1)
+	/* Fast path - all cons cells for this int are marked.  */
+	cblk->gcmarkbits[i] = 0;
+      else
+	{
+	  /* Some cons cells for this int are not marked.
+	     Find which ones, and free them.  */
+	  int start, pos, stop;
+
+	  start = i * BITS_PER_INT;
+	  stop = min (lim, start + BITS_PER_INT);
+
+	  for (pos = start; pos < stop; pos++)
+	    {
+	      if (!CONS_MARKED_P (&cblk->conses[pos]))
+		{
+		  this_free++;
+		  cblk->conses[pos].u.chain = *free_list;
+		  *free_list = &cblk->conses[pos];
+#if GC_MARK_STACK
+		  cblk->conses[pos].car = Vdead;
+#endif
+		}
+	      else
+		CONS_UNMARK (&cblk->conses[pos]);
+	    }
+	}
+    }
+
+  return this_free;
+}
+
+
+/* Sweep the next cons block that the last GC left unswept.  Value is
+   zero if there was none left.  */
+
+static int
+sweep_next_cons_block ()
+{
+  struct cons_block *cblk;
+  int this_free;
+
+  if (!cons_sweep_prev)
+    return 0;
+
+  cblk = cons_sweep_prev->next;
+  if (!cblk)
+    {
+      cons_sweep_prev = NULL;
+      return 0;
+    }
+
+  this_free = sweep_cons_block (cblk, CONS_BLOCK_SIZE, &cons_free_list);
+
+  /* If this block contains only free conses and we have already
+     seen more than two blocks worth of free conses then deallocate
+     this block.  */
+  if (this_free == CONS_BLOCK_SIZE && cons_sweep_free > CONS_BLOCK_SIZE)
+    {
+      cons_sweep_prev->next = cblk->next;
+      /* Unhook from the free list.  */
+      cons_free_list = cblk->conses[0].u.chain;
+      lisp_align_free (cblk);
+      n_cons_blocks--;
+    }
+  else
+    {
+      cons_sweep_free += this_free;
+      cons_sweep_prev = cblk;
+    }
+
+  return 1;
+}
+
+
+/* Finish sweeping the cons blocks left over from the last GC.  This
+   must be done before the next GC starts marking, and is worth doing
+   whenever Emacs is idle.  */
+
+void
+sweep_pending_conses ()
+{
+  struct sweep_part parts[MAX_SWEEP_THREADS];
+  struct cons_block *cblk, *prev;
+  int nblocks, nparts, i, j;
+
+  if (!cons_sweep_prev)
+    return;
+
+  MALLOC_BLOCK_INPUT;
+
+  nblocks = 0;
+  for (cblk = cons_sweep_prev->next; cblk; cblk = cblk->next)
+    nblocks++;
+  ensure_sweep_blocks (nblocks);
+  nblocks = 0;
+  for (cblk = cons_sweep_prev->next; cblk; cblk = cblk->next)
+    sweep_blocks[nblocks++] = cblk;
+
+  nparts = sweep_parts (sweep_cons_part, nblocks, parts);
+
+  for (i = nparts - 1; i >= 0; i--)
+    if (parts[i].head)
+      {
+	((struct Lisp_Cons *) parts[i].tail)->u.chain = cons_free_list;
+	cons_free_list = parts[i].head;
+      }
+
+  /* Deal with the blocks whose conses are all free, in the order in
+     which sweep_next_cons_block would have seen them.  */
+  prev = cons_sweep_prev;
+  for (i = 0; i < nblocks; i++)
+    {
+      int this_free = sweep_nfree[i];
+
+      cblk = sweep_blocks[i];
+      if (this_free == CONS_BLOCK_SIZE && cons_sweep_free > CONS_BLOCK_SIZE)
+	{
+	  prev->next = cblk->next;
+	  lisp_align_free (cblk);
+	  n_cons_blocks--;
+	}
+      else
+	{
+	  if (this_free == CONS_BLOCK_SIZE)
+	    for (j = 0; j < CONS_BLOCK_SIZE; j++)
+	      {
+		cblk->conses[j].u.chain = cons_free_list;
+		cons_free_list = &cblk->conses[j];
+	      }
+	  cons_sweep_free += this_free;
+	  prev = cblk;
+	}
+    }
+
+  cons_sweep_prev = NULL;
+  MALLOC_UNBLOCK_INPUT;
+}
+
+
+/* Sweep: find all structures not marked, and free them. */
+
+static void
+gc_sweep ()
+{
+  EMACS_TIME t;
+
+  /* Remove or mark entries in weak hash tables.
      This must be done before any object is unmarked.  */
   sweep_weak_hash_tables ();
 
+  EMACS_GET_TIME (t);
   sweep_strings ();
+  gc_stat[GC_STAT_STRINGS] = gc_seconds_since (t);
 #ifdef GC_CHECK_STRING_BYTES
   if (!noninteractive)
     check_string_bytes (1);
 #endif
 
-  /* Put all unmarked conses on free list */
+  /* Put the unmarked conses of the newest block on the free list.
+     The other blocks are swept lazily, see cons_sweep_prev.  */
   {
     register struct cons_block *cblk;
-    struct cons_block **cprev = &cons_block;
-    register int lim = cons_block_index;
-    register int num_free = 0, num_used = 0;
+    int num_used = 0;
 
     cons_free_list = 0;
+    cons_sweep_prev = cons_block;
+    cons_sweep_free = 0;
 
-    for (cblk = cons_block; cblk; cblk = *cprev)
-      {
-	register int i = 0;
-	int this_free = 0;
-	int ilim = (lim + BITS_PER_INT - 1) / BITS_PER_INT;
-
-	/* Scan the mark bits an int at a time.  */
-	for (i = 0; i <= ilim; i++)
-	  {
-	    if (cblk->gcmarkbits[i] == -1)
-	      {
-		/* Fast path - all cons cells for this int are marked.  */
-		cblk->gcmarkbits[i] = 0;
-		num_used += BITS_PER_INT;
-	      }
-	    else
-	      {
-		/* Some cons cells for this int are not marked.
-		   Find which ones, and free them.  */
-		int start, pos, stop;
-
-		start = i * BITS_PER_INT;
-		stop = lim - start;
-		if (stop > BITS_PER_INT)
-		  stop = BITS_PER_INT;
-		stop += start;
+    for (cblk = cons_block; cblk; cblk = cblk->next)
+      num_used += count_mark_bits (cblk->gcmarkbits,
+				   sizeof cblk->gcmarkbits / sizeof (int));
 
-		for (pos = start; pos < stop; pos++)
-		  {
-		    if (!CONS_MARKED_P (&cblk->conses[pos]))
-		      {
-			this_free++;
-			cblk->conses[pos].u.chain = cons_free_list;
-			cons_free_list = &cblk->conses[pos];
-#if GC_MARK_STACK
-			cons_free_list->car = Vdead;
-#endif
-		      }
-		    else
-		      {
-			num_used++;
-			CONS_UNMARK (&cblk->conses[pos]);
-		      }
-		  }
-	      }
-	  }
+    if (cons_block)
+      cons_sweep_free = sweep_cons_block (cons_block, cons_block_index,
+					  &cons_free_list);
 
-	lim = CONS_BLOCK_SIZE;
-	/* If this block contains only free conses and we have already
-	   seen more than two blocks worth of free conses then deallocate
-	   this block.  */
-	if (this_free == CONS_BLOCK_SIZE && num_free > CONS_BLOCK_SIZE)
-	  {
-	    *cprev = cblk->next;
-	    /* Unhook from the free list.  */
-	    cons_free_list = cblk->conses[0].u.chain;
-	    lisp_align_free (cblk);
-	    n_cons_blocks--;
-	  }
-	else
-	  {
-	    num_free += this_free;
-	    cprev = &cblk->next;
-	  }
-      }
     total_conses = num_used;
-    total_free_conses = num_free;
+    total_free_conses = (n_cons_blocks * CONS_BLOCK_SIZE
+			 - (CONS_BLOCK_SIZE - cons_block_index) - num_used);
   }
 
   /* Put all unmarked floats on free list */
   {
+    struct sweep_part parts[MAX_SWEEP_THREADS];
     register struct float_block *fblk;
     struct float_block **fprev = &float_block;
-    register int lim = float_block_index;
-    register int num_free = 0, num_used = 0;
+    int num_free = 0, num_used = 0;
+    int nblocks, nparts, i, j;
+
+    ensure_sweep_blocks (n_float_blocks);
+    nblocks = 0;
+    for (fblk = float_block; fblk; fblk = fblk->next)
+      sweep_blocks[nblocks++] = fblk;
+
+    nparts = sweep_parts (sweep_float_part, nblocks, parts);
 
     float_free_list = 0;
+    for (i = nparts - 1; i >= 0; i--)
+      {
+	if (parts[i].head)
+	  {
+	    ((struct Lisp_Float *) parts[i].tail)->u.chain = float_free_list;
+	    float_free_list = parts[i].head;
+	  }
+	num_used += parts[i].nused;
+      }
 
-    for (fblk = float_block; fblk; fblk = *fprev)
+    for (i = 0, fblk = float_block; fblk; fblk = *fprev, i++)
       {
-	register int i;
-	int this_free = 0;
-	for (i = 0; i < lim; i++)
-	  if (!FLOAT_MARKED_P (&fblk->floats[i]))
-	    {
-	      this_free++;
-	      fblk->floats[i].u.chain = float_free_list;
-	      float_free_list = &fblk->floats[i];
-	    }
-	  else
-	    {
-	      num_used++;
-	      FLOAT_UNMARK (&fblk->floats[i]);
-	    }
-	lim = FLOAT_BLOCK_SIZE;
+	int this_free = sweep_nfree[i];
+
 	/* If this block contains only free floats and we have already
 	   seen more than two blocks worth of free floats then deallocate
 	   this block.  */
 	if (this_free == FLOAT_BLOCK_SIZE && num_free > FLOAT_BLOCK_SIZE)
 	  {
 	    *fprev = fblk->next;
-	    /* Unhook from the free list.  */
-	    float_free_list = fblk->floats[0].u.chain;
 	    lisp_align_free (fblk);
 	    n_float_blocks--;
 	  }
 	else
 	  {
+	    if (this_free == FLOAT_BLOCK_SIZE)
+	      for (j = 0; j < FLOAT_BLOCK_SIZE; j++)
+		{
+		  fblk->floats[j].u.chain = float_free_list;
+		  float_free_list = &fblk->floats[j];
+		}
 	    num_free += this_free;
 	    fprev = &fblk->next;
 	  }
@@ -6012,58 +7190,51 @@ gc_sweep ()
 
   /* Put all unmarked symbols on free list */
   {
+    struct sweep_part parts[MAX_SWEEP_THREADS];
     register struct symbol_block *sblk;
     struct symbol_block **sprev = &symbol_block;
-    register int lim = symbol_block_index;
-    register int num_free = 0, num_used = 0;
+    int num_free = 0, num_used = 0;
+    int nblocks, nparts, i, j;
 
-    symbol_free_list = NULL;
+    ensure_sweep_blocks (n_symbol_blocks);
+    nblocks = 0;
+    for (sblk = symbol_block; sblk; sblk = sblk->next)
+      sweep_blocks[nblocks++] = sblk;
 
-    for (sblk = symbol_block; sblk; sblk = *sprev)
-      {
-	int this_free = 0;
-	struct Lisp_Symbol *sym = sblk->symbols;
-	struct Lisp_Symbol *end = sym + lim;
+    nparts = sweep_parts (sweep_symbol_part, nblocks, parts);
 
-	for (; sym < end; ++sym)
+    symbol_free_list = NULL;
+    for (i = nparts - 1; i >= 0; i--)
+      {
+	if (parts[i].head)
 	  {
-	    /* Check if the symbol was created during loadup.  In such a case
-	       it might be pointed to by pure bytecode which we don't trace,
-	       so we conservatively assume that it is live.  */
-	    int pure_p = PURE_POINTER_P (XSTRING (sym->xname));
-
-	    if (!sym->gcmarkbit && !pure_p)
-	      {
-		sym->next = symbol_free_list;
-		symbol_free_list = sym;
-#if GC_MARK_STACK
-		symbol_free_list->function = Vdead;
-#endif
-		++this_free;
-	      }
-	    else
-	      {
-		++num_used;
-		if (!pure_p)
-		  UNMARK_STRING (XSTRING (sym->xname));
-		sym->gcmarkbit = 0;
-	      }
+	    ((struct Lisp_Symbol *) parts[i].tail)->next = symbol_free_list;
+	    symbol_free_list = parts[i].head;
 	  }
+	num_used += parts[i].nused;
+      }
+
+    for (i = 0, sblk = symbol_block; sblk; sblk = *sprev, i++)
+      {
+	int this_free = sweep_nfree[i];
 
-	lim = SYMBOL_BLOCK_SIZE;
 	/* If this block contains only free symbols and we have already
 	   seen more than two blocks worth of free symbols then deallocate
 	   this block.  */
 	if (this_free == SYMBOL_BLOCK_SIZE && num_free > SYMBOL_BLOCK_SIZE)
 	  {
 	    *sprev = sblk->next;
-	    /* Unhook from the free list.  */
-	    symbol_free_list = sblk->symbols[0].next;
 	    lisp_free (sblk);
 	    n_symbol_blocks--;
 	  }
 	else
 	  {
+	    if (this_free == SYMBOL_BLOCK_SIZE)
+	      for (j = 0; j < SYMBOL_BLOCK_SIZE; j++)
+		{
+		  sblk->symbols[j].next = symbol_free_list;
+		  symbol_free_list = &sblk->symbols[j];
+		}
 	    num_free += this_free;
 	    sprev = &sblk->next;
 	  }
@@ -6153,11 +7324,77 @@ gc_sweep ()
 	}
   }
 
-  /* Free all unmarked vectors */
+  /* Put all unmarked small vectors on the free lists.  */
   {
-    register struct Lisp_Vector *vector = all_vectors, *prev = 0, *next;
+    int size_class;
+
     total_vector_size = 0;
 
+    for (size_class = 0; size_class < VECTOR_SIZE_CLASSES; size_class++)
+      {
+	struct vector_block *b, **bprev = &vector_blocks[size_class];
+	int num_free = 0;
+
+	vector_free_lists[size_class] = NULL;
+
+	for (b = *bprev; b; b = *bprev)
+	  {
+	    struct Lisp_Vector *old_free_list = vector_free_lists[size_class];
+	    int nslots = VECTOR_BLOCK_BYTES / b->nbytes;
+	    int this_free = 0;
+	    int i;
+
+	    for (i = 0; i < nslots; i++)
+	      {
+		struct Lisp_Vector *vector
+		  = (struct Lisp_Vector *) (b->data + i * b->nbytes);
+
+		if (VECTOR_MARKED_P (vector))
+		  {
+		    VECTOR_UNMARK (vector);
+		    if (vector->size & PSEUDOVECTOR_FLAG)
+		      total_vector_size += (PSEUDOVECTOR_SIZE_MASK
+					    & vector->size);
+		    else
+		      total_vector_size += vector->size;
+		  }
+		else
+		  {
+		    if (vector->size != VECTOR_FREE_SIZE)
+		      {
+			vector->size = VECTOR_FREE_SIZE;
+			n_vectors--;
+		      }
+		    vector->next = vector_free_lists[size_class];
+		    vector_free_lists[size_class] = vector;
+		    this_free++;
+		  }
+	      }
+
+	    /* If this block contains only free vectors and we have
+	       already seen more than a block's worth of free vectors
+	       of this size then deallocate this block.  */
+	    if (this_free == nslots && num_free > nslots)
+	      {
+		*bprev = b->next;
+		/* Unhook from the free list.  */
+		vector_free_lists[size_class] = old_free_list;
+		lisp_free (b);
+		n_vector_blocks--;
+	      }
+	    else
+	      {
+		num_free += this_free;
+		bprev = &b->next;
+	      }
+	  }
+      }
+  }
+
+  /* Free all unmarked vectors that are not small.  */
+  {
+    register struct Lisp_Vector *vector = all_vectors, *prev = 0, *next;
+
     while (vector)
       if (!VECTOR_MARKED_P (vector))
 	{
@@ -6317,11 +7554,21 @@ init_alloc ()
 #endif
   Vgc_elapsed = make_float (0.0);
   gcs_done = 0;
+#ifdef HAVE_PTHREAD
+  /* A dumped Emacs has none of the sweep workers of the Emacs that
+     dumped it.  */
+  n_sweep_workers = 0;
+  pthread_mutex_init (&sweep_mutex, NULL);
+  pthread_cond_init (&sweep_start, NULL);
+  pthread_cond_init (&sweep_done, NULL);
+#endif
 }
 
 void
 syms_of_alloc ()
 {
+  int i;
+
   DEFVAR_INT ("gc-cons-threshold", &gc_cons_threshold,
 	      doc: /* *Number of bytes of consing between garbage collections.
 Garbage collection can happen automatically once this many bytes have been
@@ -6340,6 +7587,24 @@ has been allocated since the last garbage collection.
 If this portion is smaller than `gc-cons-threshold', this is ignored.  */);
   Vgc_cons_percentage = make_float (0.1);
 
+  DEFVAR_LISP ("gc-cons-idle-fraction", &Vgc_cons_idle_fraction,
+	       doc: /* *Portion of the GC threshold after which to collect garbage when idle.
+When Emacs has waited `gc-idle-delay' seconds for a command, it
+collects garbage if it has consed more than this fraction of what
+would trigger garbage collection, as determined by `gc-cons-threshold'
+and `gc-cons-percentage'.  That way, the collection doesn't happen in
+the middle of the next command.  nil means don't do this.  */);
+  Vgc_cons_idle_fraction = make_float (0.5);
+
+  DEFVAR_INT ("gc-sweep-threads", &gc_sweep_threads,
+	      doc: /* *Number of threads garbage collection uses for sweeping.
+If this is more than 1, the cons, float and symbol blocks are swept
+in parallel by this many threads, provided there are enough of them
+to make it worthwhile.  The threads are started by the first garbage
+collection that needs them, and then wait for the next one.  This has
+no effect on systems without threads.  */);
+  gc_sweep_threads = 1;
+
   DEFVAR_INT ("pure-bytes-used", &pure_bytes_used,
 	      doc: /* Number of bytes of sharable Lisp data allocated so far.  */);
 
@@ -6381,6 +7646,26 @@ This means that certain objects should be allocated in shared (pure) space.  */)
   Qpost_gc_hook = intern ("post-gc-hook");
   staticpro (&Qpost_gc_hook);
 
+  DEFVAR_LISP ("post-gc-functions", &Vpost_gc_functions,
+	       doc: /* Abnormal hook run after garbage collection has finished.
+Each function is called with one argument, a plist of statistics
+about the garbage collection, as returned by `gc-statistics'.  */);
+  Vpost_gc_functions = Qnil;
+  Qpost_gc_functions = intern ("post-gc-functions");
+  staticpro (&Qpost_gc_functions);
+
+  DEFVAR_INT ("gc-statistics-log-size", &gc_statistics_log_size,
+	      doc: /* *Number of garbage collections to keep statistics for.
+`gc-statistics' with a non-nil argument returns the statistics of this
+many of the most recent garbage collections.  Changing the value
+discards the statistics collected so far.  */);
+  gc_statistics_log_size = 0;
+
+  gc_stat_keywords = Fmake_vector (make_number (GC_STAT_MAX), Qnil);
+  staticpro (&gc_stat_keywords);
+  for (i = 0; i < GC_STAT_MAX; i++)
+    ASET (gc_stat_keywords, i, intern (gc_stat_names[i]));
+
   DEFVAR_LISP ("memory-signal-data", &Vmemory_signal_data,
 	       doc: /* Precomputed `signal' argument for memory-full error.  */);
   /* We build this in advance because if we wait until we need it, we might
@@ -6417,6 +7702,7 @@ The time is in seconds as a floating point value.  */);
   defsubr (&Smake_marker);
   defsubr (&Spurecopy);
   defsubr (&Sgarbage_collect);
+  defsubr (&Sgc_statistics);
   defsubr (&Smemory_limit);
   defsubr (&Smemory_use_counts);
 
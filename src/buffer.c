@@ -5419,6 +5419,7 @@ defvar_per_buffer (namestring, address, type, doc)
   int offset;
 
   sym = intern (namestring);
+  XSYMBOL (sym)->declared_special = 1;
   val = allocate_misc ();
   offset = (char *)address - (char *)current_buffer;
 
@@ -5435,6 +5436,39 @@ defvar_per_buffer (namestring, address, type, doc)
 }
 
 
+/* Save the default values of the per-buffer variables in a portable
+   dump.  buffer_defaults is a buffer, so it is not dumped itself.  */
+
+static void
+buffer_dump_save ()
+{
+  int offset;
+
+  for (offset = PER_BUFFER_VAR_OFFSET (name) + sizeof (Lisp_Object);
+       offset < sizeof (struct buffer);
+       offset += sizeof (Lisp_Object))
+    pdump_write_object (PER_BUFFER_DEFAULT (offset));
+}
+
+/* Restore the defaults buffer_dump_save saved, and give the buffers
+   made while Emacs started those defaults.  */
+
+static void
+buffer_dump_load ()
+{
+  struct buffer *b;
+  int offset;
+
+  for (offset = PER_BUFFER_VAR_OFFSET (name) + sizeof (Lisp_Object);
+       offset < sizeof (struct buffer);
+       offset += sizeof (Lisp_Object))
+    pdump_read_object (&PER_BUFFER_DEFAULT (offset));
+
+  for (b = all_buffers; b; b = b->next)
+    if (!NILP (b->name))
+      reset_buffer_local_variables (b, 1);
+}
+
 /* initialize the buffer routines */
 void
 syms_of_buffer ()
@@ -5443,6 +5477,8 @@ syms_of_buffer ()
   last_overlay_modification_hooks
     = Fmake_vector (make_number (10), Qnil);
 
+  pdump_add_hooks (buffer_dump_save, buffer_dump_load);
+
   staticpro (&Vbuffer_defaults);
   staticpro (&Vbuffer_local_symbols);
   staticpro (&Qfundamental_mode);
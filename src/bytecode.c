@@ -40,6 +40,8 @@ by Hallvard:
 #include "character.h"
 #include "syntax.h"
 #include "window.h"
+#include "bytecode.h"
+#include "systime.h"
 
 #ifdef CHECK_FRAME_FONT
 #include "frame.h"
@@ -49,216 +51,261 @@ by Hallvard:
 /*
  * define BYTE_CODE_SAFE to enable some minor sanity checking (useful for
  * debugging the byte compiler...)
- *
- * define BYTE_CODE_METER to enable generation of a byte-op usage histogram.
  */
 /* #define BYTE_CODE_SAFE */
-/* #define BYTE_CODE_METER */
 
 
-#ifdef BYTE_CODE_METER
-
-Lisp_Object Vbyte_code_meter, Qbyte_code_meter;
+/* Byte-code metering.
+
+   While byte_metering_on is non-zero, each byte-code function entered
+   counts the instructions it executes, and each pair of successive
+   instructions, in Vbyte_code_meter.  The time from the start of one
+   instruction to the start of the next one is charged to the class of
+   the first, which is its opcode without any operand that is part of
+   the opcode.  Time spent in byte-code called from there is charged
+   to its own instructions.  Calls of named functions from byte-code
+   are counted in byte_meter_calls.  */
+
+Lisp_Object Vbyte_code_meter;
 int byte_metering_on;
 
-#define METER_2(code1, code2) \
-  XFASTINT (XVECTOR (XVECTOR (Vbyte_code_meter)->contents[(code1)]) \
-	    ->contents[(code2)])
-
-#define METER_1(code) METER_2 (0, (code))
-
-#define METER_CODE(last_code, this_code)				\
-{									\
-  if (byte_metering_on)							\
-    {									\
-      if (METER_1 (this_code) < MOST_POSITIVE_FIXNUM)			\
-        METER_1 (this_code)++;						\
-      if (last_code							\
-	  && METER_2 (last_code, this_code) < MOST_POSITIVE_FIXNUM)	\
-        METER_2 (last_code, this_code)++;				\
-    }									\
+/* Hash table mapping the functions called from byte-code to the number
+   of times they were called, or nil before metering starts.  */
+static Lisp_Object byte_meter_calls;
+
+/* Seconds charged to each opcode class.  */
+static double byte_meter_time[256];
+
+/* The class being timed, or -1 if none, and since when.  */
+static int byte_meter_class;
+static EMACS_TIME byte_meter_start;
+
+/* Seconds that reading the clock adds to each time charged, which
+   would otherwise swamp the time of the cheaper instructions.  It is
+   measured when metering starts and subtracted from every charge.  */
+static double byte_meter_overhead;
+
+#define BYTE_METER_CALIBRATION 10000
+
+/* Return the count for instruction CODE2 following CODE1 in
+   Vbyte_code_meter, or for CODE2 alone if CODE1 is 0, or null if
+   Vbyte_code_meter has been set to something that is not a vector of
+   256 vectors of 256 elements.  */
+
+static Lisp_Object *
+byte_meter_slot (code1, code2)
+     int code1, code2;
+{
+  Lisp_Object row;
+
+  if (!VECTORP (Vbyte_code_meter) || ASIZE (Vbyte_code_meter) != 256)
+    return NULL;
+  row = AREF (Vbyte_code_meter, code1);
+  if (!VECTORP (row) || ASIZE (row) != 256)
+    return NULL;
+  return &XVECTOR (row)->contents[code2];
 }
 
-#else /* no BYTE_CODE_METER */
+/* Return non-zero if Vbyte_code_meter has the shape byte_meter_slot
+   expects.  */
 
-#define METER_CODE(last_code, this_code)
+static int
+byte_meter_vector_p ()
+{
+  int i;
 
-#endif /* no BYTE_CODE_METER */
-
+  for (i = 0; i < 256; i++)
+    if (!byte_meter_slot (i, 0))
+      return 0;
+  return 1;
+}
 
-Lisp_Object Qbytecode;
+/* Set byte_meter_overhead.  */
+
+static void
+byte_meter_calibrate ()
+{
+  EMACS_TIME start, now;
+  int i;
+
+  EMACS_GET_TIME (start);
+  for (i = 0; i < BYTE_METER_CALIBRATION; i++)
+    EMACS_GET_TIME (now);
+  byte_meter_overhead
+    = ((EMACS_SECS (now) - EMACS_SECS (start))
+       + (EMACS_USECS (now) - EMACS_USECS (start)) * 1e-6)
+       / BYTE_METER_CALIBRATION;
+}
 
-/*  Byte codes: */
-
-#define Bvarref 010
-#define Bvarset 020
-#define Bvarbind 030
-#define Bcall 040
-#define Bunbind 050
-
-#define Bnth 070
-#define Bsymbolp 071
-#define Bconsp 072
-#define Bstringp 073
-#define Blistp 074
-#define Beq 075
-#define Bmemq 076
-#define Bnot 077
-#define Bcar 0100
-#define Bcdr 0101
-#define Bcons 0102
-#define Blist1 0103
-#define Blist2 0104
-#define Blist3 0105
-#define Blist4 0106
-#define Blength 0107
-#define Baref 0110
-#define Baset 0111
-#define Bsymbol_value 0112
-#define Bsymbol_function 0113
-#define Bset 0114
-#define Bfset 0115
-#define Bget 0116
-#define Bsubstring 0117
-#define Bconcat2 0120
-#define Bconcat3 0121
-#define Bconcat4 0122
-#define Bsub1 0123
-#define Badd1 0124
-#define Beqlsign 0125
-#define Bgtr 0126
-#define Blss 0127
-#define Bleq 0130
-#define Bgeq 0131
-#define Bdiff 0132
-#define Bnegate 0133
-#define Bplus 0134
-#define Bmax 0135
-#define Bmin 0136
-#define Bmult 0137
-
-#define Bpoint 0140
-/* Was Bmark in v17.  */
-#define Bsave_current_buffer 0141
-#define Bgoto_char 0142
-#define Binsert 0143
-#define Bpoint_max 0144
-#define Bpoint_min 0145
-#define Bchar_after 0146
-#define Bfollowing_char 0147
-#define Bpreceding_char 0150
-#define Bcurrent_column 0151
-#define Bindent_to 0152
-#define Bscan_buffer 0153 /* No longer generated as of v18 */
-#define Beolp 0154
-#define Beobp 0155
-#define Bbolp 0156
-#define Bbobp 0157
-#define Bcurrent_buffer 0160
-#define Bset_buffer 0161
-#define Bsave_current_buffer_1 0162 /* Replacing Bsave_current_buffer.  */
-#define Bread_char 0162 /* No longer generated as of v19 */
-#define Bset_mark 0163 /* this loser is no longer generated as of v18 */
-#define Binteractive_p 0164 /* Needed since interactive-p takes unevalled args */
-
-#define Bforward_char 0165
-#define Bforward_word 0166
-#define Bskip_chars_forward 0167
-#define Bskip_chars_backward 0170
-#define Bforward_line 0171
-#define Bchar_syntax 0172
-#define Bbuffer_substring 0173
-#define Bdelete_region 0174
-#define Bnarrow_to_region 0175
-#define Bwiden 0176
-#define Bend_of_line 0177
-
-#define Bconstant2 0201
-#define Bgoto 0202
-#define Bgotoifnil 0203
-#define Bgotoifnonnil 0204
-#define Bgotoifnilelsepop 0205
-#define Bgotoifnonnilelsepop 0206
-#define Breturn 0207
-#define Bdiscard 0210
-#define Bdup 0211
-
-#define Bsave_excursion 0212
-#define Bsave_window_excursion 0213
-#define Bsave_restriction 0214
-#define Bcatch 0215
-
-#define Bunwind_protect 0216
-#define Bcondition_case 0217
-#define Btemp_output_buffer_setup 0220
-#define Btemp_output_buffer_show 0221
-
-#define Bunbind_all 0222
-
-#define Bset_marker 0223
-#define Bmatch_beginning 0224
-#define Bmatch_end 0225
-#define Bupcase 0226
-#define Bdowncase 0227
-
-#define Bstringeqlsign 0230
-#define Bstringlss 0231
-#define Bequal 0232
-#define Bnthcdr 0233
-#define Belt 0234
-#define Bmember 0235
-#define Bassq 0236
-#define Bnreverse 0237
-#define Bsetcar 0240
-#define Bsetcdr 0241
-#define Bcar_safe 0242
-#define Bcdr_safe 0243
-#define Bnconc 0244
-#define Bquo 0245
-#define Brem 0246
-#define Bnumberp 0247
-#define Bintegerp 0250
-
-#define BRgoto 0252
-#define BRgotoifnil 0253
-#define BRgotoifnonnil 0254
-#define BRgotoifnilelsepop 0255
-#define BRgotoifnonnilelsepop 0256
-
-#define BlistN 0257
-#define BconcatN 0260
-#define BinsertN 0261
-
-#define Bconstant 0300
-#define CONSTANTLIM 0100
 
-
-/* Structure describing a value stack used during byte-code execution
-   in Fbyte_code.  */
+#define METER_CLASS(code) \
+  ((code) < Bnth ? (code) & ~7 : (code) >= Bconstant ? Bconstant : (code))
+
+/* Charge the time since the last call to the class being timed, and
+   start timing CLASS.  */
 
-struct byte_stack
+static void
+byte_meter_charge (class)
+     int class;
 {
-  /* Program counter.  This points into the byte_string below
-     and is relocated when that string is relocated.  */
-  const unsigned char *pc;
+  EMACS_TIME now;
+
+  EMACS_GET_TIME (now);
+  if (byte_meter_class >= 0)
+    byte_meter_time[byte_meter_class]
+      += ((EMACS_SECS (now) - EMACS_SECS (byte_meter_start))
+	  + (EMACS_USECS (now) - EMACS_USECS (byte_meter_start)) * 1e-6
+	  - byte_meter_overhead);
+  byte_meter_start = now;
+  byte_meter_class = class;
+}
 
-  /* Top and bottom of stack.  The bottom points to an area of memory
-     allocated with alloca in Fbyte_code.  */
-  Lisp_Object *top, *bottom;
+/* Increment the count at COUNT, unless it would overflow or COUNT is
+   null.  A count that is not a natural number starts again.  */
 
-  /* The string containing the byte-code, and its current address.
-     Storing this here protects it from GC because mark_byte_stack
-     marks it.  */
-  Lisp_Object byte_string;
-  const unsigned char *byte_string_start;
+static INLINE void
+byte_meter_increment (count)
+     Lisp_Object *count;
+{
+  if (!count)
+    return;
+  if (!NATNUMP (*count))
+    XSETFASTINT (*count, 1);
+  else if (XFASTINT (*count) < MOST_POSITIVE_FIXNUM)
+    XSETFASTINT (*count, XFASTINT (*count) + 1);
+}
 
-  /* The vector of constants used during byte-code execution.  Storing
-     this here protects it from GC because mark_byte_stack marks it.  */
-  Lisp_Object constants;
+/* Meter the instruction THIS_CODE, which follows LAST_CODE, or 0 if
+   it is the first of its function.  */
 
-  /* Next entry in byte_stack_list.  */
-  struct byte_stack *next;
-};
+static void
+byte_meter_code (last_code, this_code)
+     int last_code, this_code;
+{
+  if (!byte_metering_on)
+    return;
+  byte_meter_increment (byte_meter_slot (0, this_code));
+  if (last_code)
+    byte_meter_increment (byte_meter_slot (last_code, this_code));
+  byte_meter_charge (METER_CLASS (this_code));
+}
+
+/* Count a call of FUNCTION from byte-code.  This can GC.  */
+
+static void
+byte_meter_call (function)
+     Lisp_Object function;
+{
+  struct Lisp_Hash_Table *h;
+  unsigned hash;
+  int i;
+
+  if (!HASH_TABLE_P (byte_meter_calls))
+    return;
+  h = XHASH_TABLE (byte_meter_calls);
+  i = hash_lookup (h, function, &hash);
+  if (i < 0)
+    hash_put (h, function, make_number (1), hash);
+  else if (XINT (HASH_VALUE (h, i)) < MOST_POSITIVE_FIXNUM)
+    HASH_VALUE (h, i) = make_number (XINT (HASH_VALUE (h, i)) + 1);
+}
+
+DEFUN ("byte-code-meter-start", Fbyte_code_meter_start,
+       Sbyte_code_meter_start, 0, 0, 0,
+       doc: /* Start metering byte-code execution.
+Set `byte-metering-on', creating `byte-code-meter' if needed, or if it
+is not a vector of 256 vectors of 256 elements.
+The data collected so far is kept; see `byte-code-meter-reset'.
+Use `byte-compile-report-ops' to display it.  */)
+     ()
+{
+  int i;
+
+  if (!byte_meter_vector_p ())
+    {
+      Vbyte_code_meter = Fmake_vector (make_number (256), make_number (0));
+      for (i = 0; i < 256; i++)
+	ASET (Vbyte_code_meter, i,
+	      Fmake_vector (make_number (256), make_number (0)));
+    }
+  if (!HASH_TABLE_P (byte_meter_calls))
+    {
+      Lisp_Object args[2];
+      args[0] = QCtest;
+      args[1] = Qeq;
+      byte_meter_calls = Fmake_hash_table (2, args);
+    }
+  byte_meter_calibrate ();
+  byte_meter_class = -1;
+  byte_metering_on = 1;
+  return Qt;
+}
+
+DEFUN ("byte-code-meter-stop", Fbyte_code_meter_stop,
+       Sbyte_code_meter_stop, 0, 0, 0,
+       doc: /* Stop metering byte-code execution.
+Return non-nil if it was running.  */)
+     ()
+{
+  int was_running = byte_metering_on;
+
+  byte_metering_on = 0;
+  byte_meter_class = -1;
+  return was_running ? Qt : Qnil;
+}
+
+DEFUN ("byte-code-meter-reset", Fbyte_code_meter_reset,
+       Sbyte_code_meter_reset, 0, 0, 0,
+       doc: /* Discard the data collected by byte-code metering.  */)
+     ()
+{
+  int i, j;
+
+  if (byte_meter_vector_p ())
+    for (i = 0; i < 256; i++)
+      for (j = 0; j < 256; j++)
+	XSETFASTINT (*byte_meter_slot (i, j), 0);
+  if (HASH_TABLE_P (byte_meter_calls))
+    Fclrhash (byte_meter_calls);
+  for (i = 0; i < 256; i++)
+    byte_meter_time[i] = 0;
+  byte_meter_class = -1;
+  return Qnil;
+}
+
+DEFUN ("byte-code-meter-times", Fbyte_code_meter_times,
+       Sbyte_code_meter_times, 0, 0, 0,
+       doc: /* Return the time spent in each class of byte-code instructions.
+The value is a vector of 256 floats, in seconds, indexed by opcode.
+The time of instructions whose operand is part of the opcode, such as
+`varref' and `constant', is all at the first opcode of their range.
+The time it takes to read the clock, measured when metering starts,
+is not included.  */)
+     ()
+{
+  Lisp_Object times;
+  int i;
+
+  times = Fmake_vector (make_number (256), Qnil);
+  for (i = 0; i < 256; i++)
+    ASET (times, i, make_float (max (byte_meter_time[i], 0)));
+  return times;
+}
+
+DEFUN ("byte-code-meter-calls", Fbyte_code_meter_calls,
+       Sbyte_code_meter_calls, 0, 0, 0,
+       doc: /* Return the number of calls of each function made from byte-code.
+The value is a new hash table mapping function names to call counts,
+or nil if byte-code metering has never been started.  */)
+     ()
+{
+  if (!HASH_TABLE_P (byte_meter_calls))
+    return Qnil;
+  return Fcopy_hash_table (byte_meter_calls);
+}
+
+
+Lisp_Object Qbytecode;
 
 /* A list of currently active byte-code execution value stacks.
    Fbyte_code adds an entry to the head of this list before it starts
@@ -395,6 +442,37 @@ unmark_byte_stack ()
       }							\
   } while (0)
 
+/* With GCC, dispatch each instruction through a table of label
+   addresses ("threaded code") instead of returning to the top of the
+   loop and going through the switch.  Every instruction then ends in
+   an indirect jump of its own, which the branch predictor can learn
+   separately.  The switch is still used for the first instruction and
+   is the only dispatch method when the extension is unavailable or
+   when checking is done at the top of the loop.
+
+   When metering, DISPATCH is a table that sends every instruction to
+   insn_meter first.  */
+
+#if defined (__GNUC__) && !defined (BYTE_CODE_SAFE)
+#define BYTE_CODE_THREADED
+#endif
+
+#ifdef BYTE_CODE_THREADED
+
+#define CASE(OP)		insn_##OP: case OP
+#define CASE_OFFSET(OP, N)	insn_##OP##_##N: case OP + N
+#define CASE_DEFAULT		insn_default: default
+#define NEXT			goto *(dispatch[op = FETCH])
+
+#else /* not BYTE_CODE_THREADED */
+
+#define CASE(OP)		case OP
+#define CASE_OFFSET(OP, N)	case OP + N
+#define CASE_DEFAULT		default
+#define NEXT			break
+
+#endif /* not BYTE_CODE_THREADED */
+
 
 DEFUN ("byte-code", Fbyte_code, Sbyte_code, 3, 3, 0,
        doc: /* Function used internally in byte-compiled code.
@@ -404,12 +482,50 @@ the third, MAXDEPTH, the maximum stack depth used in this function.
 If the third argument is incorrect, Emacs may crash.  */)
      (bytestr, vector, maxdepth)
      Lisp_Object bytestr, vector, maxdepth;
+{
+  return exec_byte_code (bytestr, vector, maxdepth);
+}
+
+/* Evaluate FORM, the body of a `catch' or `condition-case' in
+   byte-code.  The byte compiler makes such a body a call to
+   `byte-code' with a constant string, vector and depth, so run that
+   directly instead of going through eval_sub and Fbyte_code.  Any
+   other form is evaluated normally.  */
+
+Lisp_Object
+eval_byte_code_body (form)
+     Lisp_Object form;
+{
+  if (CONSP (form) && EQ (XCAR (form), Qbytecode))
+    {
+      Lisp_Object fun = XSYMBOL (Qbytecode)->function;
+      Lisp_Object args = XCDR (form);
+
+      if (SUBRP (fun) && XSUBR (fun) == &Sbyte_code
+	  && CONSP (args) && STRINGP (XCAR (args))
+	  && CONSP (XCDR (args)) && VECTORP (XCAR (XCDR (args)))
+	  && CONSP (XCDR (XCDR (args)))
+	  && NATNUMP (XCAR (XCDR (XCDR (args))))
+	  && NILP (XCDR (XCDR (XCDR (args)))))
+	return exec_byte_code (XCAR (args), XCAR (XCDR (args)),
+			       XCAR (XCDR (XCDR (args))));
+    }
+  return eval_sub (form);
+}
+
+/* Execute the byte-code in BYTESTR.  VECTOR is the constant vector,
+   and MAXDEPTH the maximum stack depth used.  */
+
+Lisp_Object
+exec_byte_code (bytestr, vector, maxdepth)
+     Lisp_Object bytestr, vector, maxdepth;
 {
   int count = SPECPDL_INDEX ();
-#ifdef BYTE_CODE_METER
-  int this_op = 0;
-  int prev_op;
-#endif
+  /* Whether this call is metered, and if so, the previous instruction
+     and the class that was being timed on entry.  */
+  int metering = byte_metering_on;
+  int prev_op = 0;
+  int outer_class = -1;
   int op;
   /* Lisp_Object v1, v2; */
   Lisp_Object *vectorp;
@@ -422,6 +538,155 @@ If the third argument is incorrect, Emacs may crash.  */)
   Lisp_Object *top;
   Lisp_Object result;
 
+#ifdef BYTE_CODE_THREADED
+  /* Opcodes without a handler of their own, including the ones that
+     push a constant, share the default case; the initializers after
+     the first override it.  */
+  static const void *const targets[256] =
+    {
+      [0 ... 255] = &&insn_default,
+      [Bvarref + 7] = &&insn_Bvarref_7,
+      [Bvarref ... Bvarref + 5] = &&insn_Bvarref,
+      [Bvarref + 6] = &&insn_Bvarref_6,
+      [Bgotoifnil] = &&insn_Bgotoifnil,
+      [Bcar] = &&insn_Bcar,
+      [Beq] = &&insn_Beq,
+      [Bmemq] = &&insn_Bmemq,
+      [Bcdr] = &&insn_Bcdr,
+      [Bvarset ... Bvarset + 5] = &&insn_Bvarset,
+      [Bvarset + 7] = &&insn_Bvarset_7,
+      [Bvarset + 6] = &&insn_Bvarset_6,
+      [Bdup] = &&insn_Bdup,
+      [Bvarbind + 6] = &&insn_Bvarbind_6,
+      [Bvarbind + 7] = &&insn_Bvarbind_7,
+      [Bvarbind ... Bvarbind + 5] = &&insn_Bvarbind,
+      [Bcall + 6] = &&insn_Bcall_6,
+      [Bcall + 7] = &&insn_Bcall_7,
+      [Bcall ... Bcall + 5] = &&insn_Bcall,
+      [Bunbind + 6] = &&insn_Bunbind_6,
+      [Bunbind + 7] = &&insn_Bunbind_7,
+      [Bunbind ... Bunbind + 5] = &&insn_Bunbind,
+      [Bunbind_all] = &&insn_Bunbind_all,
+      [Bgoto] = &&insn_Bgoto,
+      [Bgotoifnonnil] = &&insn_Bgotoifnonnil,
+      [Bgotoifnilelsepop] = &&insn_Bgotoifnilelsepop,
+      [Bgotoifnonnilelsepop] = &&insn_Bgotoifnonnilelsepop,
+      [BRgoto] = &&insn_BRgoto,
+      [BRgotoifnil] = &&insn_BRgotoifnil,
+      [BRgotoifnonnil] = &&insn_BRgotoifnonnil,
+      [BRgotoifnilelsepop] = &&insn_BRgotoifnilelsepop,
+      [BRgotoifnonnilelsepop] = &&insn_BRgotoifnonnilelsepop,
+      [Breturn] = &&insn_Breturn,
+      [Bdiscard] = &&insn_Bdiscard,
+      [Bconstant2] = &&insn_Bconstant2,
+      [Bsave_excursion] = &&insn_Bsave_excursion,
+      [Bsave_current_buffer] = &&insn_Bsave_current_buffer,
+      [Bsave_current_buffer_1] = &&insn_Bsave_current_buffer_1,
+      [Bsave_window_excursion] = &&insn_Bsave_window_excursion,
+      [Bsave_restriction] = &&insn_Bsave_restriction,
+      [Bcatch] = &&insn_Bcatch,
+      [Bunwind_protect] = &&insn_Bunwind_protect,
+      [Bcondition_case] = &&insn_Bcondition_case,
+      [Btemp_output_buffer_setup] = &&insn_Btemp_output_buffer_setup,
+      [Btemp_output_buffer_show] = &&insn_Btemp_output_buffer_show,
+      [Bnth] = &&insn_Bnth,
+      [Bsymbolp] = &&insn_Bsymbolp,
+      [Bconsp] = &&insn_Bconsp,
+      [Bstringp] = &&insn_Bstringp,
+      [Blistp] = &&insn_Blistp,
+      [Bnot] = &&insn_Bnot,
+      [Bcons] = &&insn_Bcons,
+      [Blist1] = &&insn_Blist1,
+      [Blist2] = &&insn_Blist2,
+      [Blist3] = &&insn_Blist3,
+      [Blist4] = &&insn_Blist4,
+      [BlistN] = &&insn_BlistN,
+      [Blength] = &&insn_Blength,
+      [Baref] = &&insn_Baref,
+      [Baset] = &&insn_Baset,
+      [Bsymbol_value] = &&insn_Bsymbol_value,
+      [Bsymbol_function] = &&insn_Bsymbol_function,
+      [Bset] = &&insn_Bset,
+      [Bfset] = &&insn_Bfset,
+      [Bget] = &&insn_Bget,
+      [Bsubstring] = &&insn_Bsubstring,
+      [Bconcat2] = &&insn_Bconcat2,
+      [Bconcat3] = &&insn_Bconcat3,
+      [Bconcat4] = &&insn_Bconcat4,
+      [BconcatN] = &&insn_BconcatN,
+      [Bsub1] = &&insn_Bsub1,
+      [Badd1] = &&insn_Badd1,
+      [Beqlsign] = &&insn_Beqlsign,
+      [Bgtr] = &&insn_Bgtr,
+      [Blss] = &&insn_Blss,
+      [Bleq] = &&insn_Bleq,
+      [Bgeq] = &&insn_Bgeq,
+      [Bdiff] = &&insn_Bdiff,
+      [Bnegate] = &&insn_Bnegate,
+      [Bplus] = &&insn_Bplus,
+      [Bmax] = &&insn_Bmax,
+      [Bmin] = &&insn_Bmin,
+      [Bmult] = &&insn_Bmult,
+      [Bquo] = &&insn_Bquo,
+      [Brem] = &&insn_Brem,
+      [Bpoint] = &&insn_Bpoint,
+      [Bgoto_char] = &&insn_Bgoto_char,
+      [Binsert] = &&insn_Binsert,
+      [BinsertN] = &&insn_BinsertN,
+      [Bpoint_max] = &&insn_Bpoint_max,
+      [Bpoint_min] = &&insn_Bpoint_min,
+      [Bchar_after] = &&insn_Bchar_after,
+      [Bfollowing_char] = &&insn_Bfollowing_char,
+      [Bpreceding_char] = &&insn_Bpreceding_char,
+      [Bcurrent_column] = &&insn_Bcurrent_column,
+      [Bindent_to] = &&insn_Bindent_to,
+      [Beolp] = &&insn_Beolp,
+      [Beobp] = &&insn_Beobp,
+      [Bbolp] = &&insn_Bbolp,
+      [Bbobp] = &&insn_Bbobp,
+      [Bcurrent_buffer] = &&insn_Bcurrent_buffer,
+      [Bset_buffer] = &&insn_Bset_buffer,
+      [Binteractive_p] = &&insn_Binteractive_p,
+      [Bforward_char] = &&insn_Bforward_char,
+      [Bforward_word] = &&insn_Bforward_word,
+      [Bskip_chars_forward] = &&insn_Bskip_chars_forward,
+      [Bskip_chars_backward] = &&insn_Bskip_chars_backward,
+      [Bforward_line] = &&insn_Bforward_line,
+      [Bchar_syntax] = &&insn_Bchar_syntax,
+      [Bbuffer_substring] = &&insn_Bbuffer_substring,
+      [Bdelete_region] = &&insn_Bdelete_region,
+      [Bnarrow_to_region] = &&insn_Bnarrow_to_region,
+      [Bwiden] = &&insn_Bwiden,
+      [Bend_of_line] = &&insn_Bend_of_line,
+      [Bset_marker] = &&insn_Bset_marker,
+      [Bmatch_beginning] = &&insn_Bmatch_beginning,
+      [Bmatch_end] = &&insn_Bmatch_end,
+      [Bupcase] = &&insn_Bupcase,
+      [Bdowncase] = &&insn_Bdowncase,
+      [Bstringeqlsign] = &&insn_Bstringeqlsign,
+      [Bstringlss] = &&insn_Bstringlss,
+      [Bequal] = &&insn_Bequal,
+      [Bnthcdr] = &&insn_Bnthcdr,
+      [Belt] = &&insn_Belt,
+      [Bmember] = &&insn_Bmember,
+      [Bassq] = &&insn_Bassq,
+      [Bnreverse] = &&insn_Bnreverse,
+      [Bsetcar] = &&insn_Bsetcar,
+      [Bsetcdr] = &&insn_Bsetcdr,
+      [Bcar_safe] = &&insn_Bcar_safe,
+      [Bcdr_safe] = &&insn_Bcdr_safe,
+      [Bnconc] = &&insn_Bnconc,
+      [Bnumberp] = &&insn_Bnumberp,
+      [Bintegerp] = &&insn_Bintegerp,
+      [0] = &&insn_0
+    };
+  static const void *const meter_targets[256] =
+    {
+      [0 ... 255] = &&insn_meter
+    };
+  const void *const *dispatch = metering ? meter_targets : targets;
+#endif
+
 #if 0 /* CHECK_FRAME_FONT */
  {
    struct frame *f = SELECTED_FRAME ();
@@ -461,6 +726,24 @@ If the third argument is incorrect, Emacs may crash.  */)
   stacke = stack.bottom - 1 + XFASTINT (maxdepth);
 #endif
 
+  if (metering)
+    {
+      /* Time spent since byte-code last ran at top level was not
+	 spent in byte-code.  */
+      if (!stack.next)
+	byte_meter_class = -1;
+      outer_class = byte_meter_class;
+    }
+  else if (native_code_loaded)
+    {
+      native_function fn = lookup_native_function (bytestr);
+      if (fn)
+	{
+	  result = (*fn) (&stack, vectorp, top);
+	  goto exit;
+	}
+    }
+
   while (1)
     {
 #ifdef BYTE_CODE_SAFE
@@ -470,21 +753,27 @@ If the third argument is incorrect, Emacs may crash.  */)
 	abort ();
 #endif
 
-#ifdef BYTE_CODE_METER
-      prev_op = this_op;
-      this_op = op = FETCH;
-      METER_CODE (prev_op, op);
-#else
       op = FETCH;
-#endif
+      if (metering)
+	{
+	  byte_meter_code (prev_op, op);
+	  prev_op = op;
+	}
 
       switch (op)
 	{
-	case Bvarref + 7:
+#ifdef BYTE_CODE_THREADED
+	insn_meter:
+	  byte_meter_code (prev_op, op);
+	  prev_op = op;
+	  goto *(targets[op]);
+#endif
+
+	CASE_OFFSET (Bvarref, 7):
 	  op = FETCH2;
 	  goto varref;
 
-	case Bvarref:
+	CASE (Bvarref):
 	case Bvarref + 1:
 	case Bvarref + 2:
 	case Bvarref + 3:
@@ -495,7 +784,7 @@ If the third argument is incorrect, Emacs may crash.  */)
 
 	/* This seems to be the most frequently executed byte-code
 	   among the Bvarref's, so avoid a goto here.  */
-	case Bvarref+6:
+	CASE_OFFSET (Bvarref, 6):
 	  op = FETCH;
 	varref:
 	  {
@@ -505,6 +794,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 	    if (SYMBOLP (v1))
 	      {
 		v2 = SYMBOL_VALUE (v1);
+		/* A variable defined with DEFVAR_LISP and not made
+		   buffer-local forwards straight to its C variable.  */
+		if (OBJFWDP (v2))
+		  v2 = *XOBJFWD (v2)->objvar;
 		if (MISCP (v2) || EQ (v2, Qunbound))
 		  {
 		    BEFORE_POTENTIAL_GC ();
@@ -519,10 +812,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 		AFTER_POTENTIAL_GC ();
 	      }
 	    PUSH (v2);
-	    break;
+	    NEXT;
 	  }
 
-	case Bgotoifnil:
+	CASE (Bgotoifnil):
 	  {
 	    Lisp_Object v1;
 	    MAYBE_GC ();
@@ -534,44 +827,44 @@ If the third argument is incorrect, Emacs may crash.  */)
 		CHECK_RANGE (op);
 		stack.pc = stack.byte_string_start + op;
 	      }
-	    break;
+	    NEXT;
 	  }
 
-	case Bcar:
+	CASE (Bcar):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
 	    TOP = CAR (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Beq:
+	CASE (Beq):
 	  {
 	    Lisp_Object v1;
 	    v1 = POP;
 	    TOP = EQ (v1, TOP) ? Qt : Qnil;
-	    break;
+	    NEXT;
 	  }
 
-	case Bmemq:
+	CASE (Bmemq):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fmemq (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bcdr:
+	CASE (Bcdr):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
 	    TOP = CDR (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bvarset:
+	CASE (Bvarset):
 	case Bvarset+1:
 	case Bvarset+2:
 	case Bvarset+3:
@@ -580,11 +873,11 @@ If the third argument is incorrect, Emacs may crash.  */)
 	  op -= Bvarset;
 	  goto varset;
 
-	case Bvarset+7:
+	CASE_OFFSET (Bvarset, 7):
 	  op = FETCH2;
 	  goto varset;
 
-	case Bvarset+6:
+	CASE_OFFSET (Bvarset, 6):
 	  op = FETCH;
 	varset:
 	  {
@@ -608,27 +901,27 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      }
 	  }
 	  (void) POP;
-	  break;
+	  NEXT;
 
-	case Bdup:
+	CASE (Bdup):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
 	/* ------------------ */
 
-	case Bvarbind+6:
+	CASE_OFFSET (Bvarbind, 6):
 	  op = FETCH;
 	  goto varbind;
 
-	case Bvarbind+7:
+	CASE_OFFSET (Bvarbind, 7):
 	  op = FETCH2;
 	  goto varbind;
 
-	case Bvarbind:
+	CASE (Bvarbind):
 	case Bvarbind+1:
 	case Bvarbind+2:
 	case Bvarbind+3:
@@ -640,17 +933,17 @@ If the third argument is incorrect, Emacs may crash.  */)
 	  BEFORE_POTENTIAL_GC ();
 	  specbind (vectorp[op], POP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bcall+6:
+	CASE_OFFSET (Bcall, 6):
 	  op = FETCH;
 	  goto docall;
 
-	case Bcall+7:
+	CASE_OFFSET (Bcall, 7):
 	  op = FETCH2;
 	  goto docall;
 
-	case Bcall:
+	CASE (Bcall):
 	case Bcall+1:
 	case Bcall+2:
 	case Bcall+3:
@@ -661,35 +954,22 @@ If the third argument is incorrect, Emacs may crash.  */)
 	  {
 	    BEFORE_POTENTIAL_GC ();
 	    DISCARD (op);
-#ifdef BYTE_CODE_METER
-	    if (byte_metering_on && SYMBOLP (TOP))
-	      {
-		Lisp_Object v1, v2;
-
-		v1 = TOP;
-		v2 = Fget (v1, Qbyte_code_meter);
-		if (INTEGERP (v2)
-		    && XINT (v2) < MOST_POSITIVE_FIXNUM)
-		  {
-		    XSETINT (v2, XINT (v2) + 1);
-		    Fput (v1, Qbyte_code_meter, v2);
-		  }
-	      }
-#endif
+	    if (metering && SYMBOLP (TOP))
+	      byte_meter_call (TOP);
 	    TOP = Ffuncall (op + 1, &TOP);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bunbind+6:
+	CASE_OFFSET (Bunbind, 6):
 	  op = FETCH;
 	  goto dounbind;
 
-	case Bunbind+7:
+	CASE_OFFSET (Bunbind, 7):
 	  op = FETCH2;
 	  goto dounbind;
 
-	case Bunbind:
+	CASE (Bunbind):
 	case Bunbind+1:
 	case Bunbind+2:
 	case Bunbind+3:
@@ -700,25 +980,25 @@ If the third argument is incorrect, Emacs may crash.  */)
 	  BEFORE_POTENTIAL_GC ();
 	  unbind_to (SPECPDL_INDEX () - op, Qnil);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bunbind_all:
+	CASE (Bunbind_all):
 	  /* To unbind back to the beginning of this frame.  Not used yet,
 	     but will be needed for tail-recursion elimination.  */
 	  BEFORE_POTENTIAL_GC ();
 	  unbind_to (count, Qnil);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bgoto:
+	CASE (Bgoto):
 	  MAYBE_GC ();
 	  BYTE_CODE_QUIT;
 	  op = FETCH2;    /* pc = FETCH2 loses since FETCH2 contains pc++ */
 	  CHECK_RANGE (op);
 	  stack.pc = stack.byte_string_start + op;
-	  break;
+	  NEXT;
 
-	case Bgotoifnonnil:
+	CASE (Bgotoifnonnil):
 	  {
 	    Lisp_Object v1;
 	    MAYBE_GC ();
@@ -730,10 +1010,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 		CHECK_RANGE (op);
 		stack.pc = stack.byte_string_start + op;
 	      }
-	    break;
+	    NEXT;
 	  }
 
-	case Bgotoifnilelsepop:
+	CASE (Bgotoifnilelsepop):
 	  MAYBE_GC ();
 	  op = FETCH2;
 	  if (NILP (TOP))
@@ -743,9 +1023,9 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      stack.pc = stack.byte_string_start + op;
 	    }
 	  else DISCARD (1);
-	  break;
+	  NEXT;
 
-	case Bgotoifnonnilelsepop:
+	CASE (Bgotoifnonnilelsepop):
 	  MAYBE_GC ();
 	  op = FETCH2;
 	  if (!NILP (TOP))
@@ -755,15 +1035,15 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      stack.pc = stack.byte_string_start + op;
 	    }
 	  else DISCARD (1);
-	  break;
+	  NEXT;
 
-	case BRgoto:
+	CASE (BRgoto):
 	  MAYBE_GC ();
 	  BYTE_CODE_QUIT;
 	  stack.pc += (int) *stack.pc - 127;
-	  break;
+	  NEXT;
 
-	case BRgotoifnil:
+	CASE (BRgotoifnil):
 	  {
 	    Lisp_Object v1;
 	    MAYBE_GC ();
@@ -774,10 +1054,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 		stack.pc += (int) *stack.pc - 128;
 	      }
 	    stack.pc++;
-	    break;
+	    NEXT;
 	  }
 
-	case BRgotoifnonnil:
+	CASE (BRgotoifnonnil):
 	  {
 	    Lisp_Object v1;
 	    MAYBE_GC ();
@@ -788,10 +1068,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 		stack.pc += (int) *stack.pc - 128;
 	      }
 	    stack.pc++;
-	    break;
+	    NEXT;
 	  }
 
-	case BRgotoifnilelsepop:
+	CASE (BRgotoifnilelsepop):
 	  MAYBE_GC ();
 	  op = *stack.pc++;
 	  if (NILP (TOP))
@@ -800,9 +1080,9 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      stack.pc += op - 128;
 	    }
 	  else DISCARD (1);
-	  break;
+	  NEXT;
 
-	case BRgotoifnonnilelsepop:
+	CASE (BRgotoifnonnilelsepop):
 	  MAYBE_GC ();
 	  op = *stack.pc++;
 	  if (!NILP (TOP))
@@ -811,56 +1091,55 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      stack.pc += op - 128;
 	    }
 	  else DISCARD (1);
-	  break;
+	  NEXT;
 
-	case Breturn:
+	CASE (Breturn):
 	  result = POP;
 	  goto exit;
 
-	case Bdiscard:
+	CASE (Bdiscard):
 	  DISCARD (1);
-	  break;
+	  NEXT;
 
-	case Bconstant2:
+	CASE (Bconstant2):
 	  PUSH (vectorp[FETCH2]);
-	  break;
+	  NEXT;
 
-	case Bsave_excursion:
-	  record_unwind_protect (save_excursion_restore,
-				 save_excursion_save ());
-	  break;
+	CASE (Bsave_excursion):
+	  record_unwind_save_excursion ();
+	  NEXT;
 
-	case Bsave_current_buffer:
-	case Bsave_current_buffer_1:
+	CASE (Bsave_current_buffer):
+	CASE (Bsave_current_buffer_1):
 	  record_unwind_protect (set_buffer_if_live, Fcurrent_buffer ());
-	  break;
+	  NEXT;
 
-	case Bsave_window_excursion:
+	CASE (Bsave_window_excursion):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fsave_window_excursion (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bsave_restriction:
+	CASE (Bsave_restriction):
 	  record_unwind_protect (save_restriction_restore,
 				 save_restriction_save ());
-	  break;
+	  NEXT;
 
-	case Bcatch:
+	CASE (Bcatch):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
-	    TOP = internal_catch (TOP, Feval, v1);
+	    TOP = internal_catch (TOP, eval_byte_code_body, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bunwind_protect:
+	CASE (Bunwind_protect):
 	  record_unwind_protect (Fprogn, POP);
-	  break;
+	  NEXT;
 
-	case Bcondition_case:
+	CASE (Bcondition_case):
 	  {
 	    Lisp_Object handlers, body;
 	    handlers = POP;
@@ -868,18 +1147,18 @@ If the third argument is incorrect, Emacs may crash.  */)
 	    BEFORE_POTENTIAL_GC ();
 	    TOP = internal_lisp_condition_case (TOP, body, handlers);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Btemp_output_buffer_setup:
+	CASE (Btemp_output_buffer_setup):
 	  BEFORE_POTENTIAL_GC ();
 	  CHECK_STRING (TOP);
 	  temp_output_buffer_setup (SDATA (TOP));
 	  AFTER_POTENTIAL_GC ();
 	  TOP = Vstandard_output;
-	  break;
+	  NEXT;
 
-	case Btemp_output_buffer_show:
+	CASE (Btemp_output_buffer_show):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
@@ -889,10 +1168,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 	    /* pop binding of standard-output */
 	    unbind_to (SPECPDL_INDEX () - 1, Qnil);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bnth:
+	CASE (Bnth):
 	  {
 	    Lisp_Object v1, v2;
 	    BEFORE_POTENTIAL_GC ();
@@ -906,173 +1185,173 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      v1 = XCDR (v1);
 	    immediate_quit = 0;
 	    TOP = CAR (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bsymbolp:
+	CASE (Bsymbolp):
 	  TOP = SYMBOLP (TOP) ? Qt : Qnil;
-	  break;
+	  NEXT;
 
-	case Bconsp:
+	CASE (Bconsp):
 	  TOP = CONSP (TOP) ? Qt : Qnil;
-	  break;
+	  NEXT;
 
-	case Bstringp:
+	CASE (Bstringp):
 	  TOP = STRINGP (TOP) ? Qt : Qnil;
-	  break;
+	  NEXT;
 
-	case Blistp:
+	CASE (Blistp):
 	  TOP = CONSP (TOP) || NILP (TOP) ? Qt : Qnil;
-	  break;
+	  NEXT;
 
-	case Bnot:
+	CASE (Bnot):
 	  TOP = NILP (TOP) ? Qt : Qnil;
-	  break;
+	  NEXT;
 
-	case Bcons:
+	CASE (Bcons):
 	  {
 	    Lisp_Object v1;
 	    v1 = POP;
 	    TOP = Fcons (TOP, v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Blist1:
+	CASE (Blist1):
 	  TOP = Fcons (TOP, Qnil);
-	  break;
+	  NEXT;
 
-	case Blist2:
+	CASE (Blist2):
 	  {
 	    Lisp_Object v1;
 	    v1 = POP;
 	    TOP = Fcons (TOP, Fcons (v1, Qnil));
-	    break;
+	    NEXT;
 	  }
 
-	case Blist3:
+	CASE (Blist3):
 	  DISCARD (2);
 	  TOP = Flist (3, &TOP);
-	  break;
+	  NEXT;
 
-	case Blist4:
+	CASE (Blist4):
 	  DISCARD (3);
 	  TOP = Flist (4, &TOP);
-	  break;
+	  NEXT;
 
-	case BlistN:
+	CASE (BlistN):
 	  op = FETCH;
 	  DISCARD (op - 1);
 	  TOP = Flist (op, &TOP);
-	  break;
+	  NEXT;
 
-	case Blength:
+	CASE (Blength):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Flength (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Baref:
+	CASE (Baref):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Faref (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Baset:
+	CASE (Baset):
 	  {
 	    Lisp_Object v1, v2;
 	    BEFORE_POTENTIAL_GC ();
 	    v2 = POP; v1 = POP;
 	    TOP = Faset (TOP, v1, v2);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bsymbol_value:
+	CASE (Bsymbol_value):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fsymbol_value (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bsymbol_function:
+	CASE (Bsymbol_function):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fsymbol_function (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bset:
+	CASE (Bset):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fset (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bfset:
+	CASE (Bfset):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Ffset (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bget:
+	CASE (Bget):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fget (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bsubstring:
+	CASE (Bsubstring):
 	  {
 	    Lisp_Object v1, v2;
 	    BEFORE_POTENTIAL_GC ();
 	    v2 = POP; v1 = POP;
 	    TOP = Fsubstring (TOP, v1, v2);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bconcat2:
+	CASE (Bconcat2):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fconcat (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bconcat3:
+	CASE (Bconcat3):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (2);
 	  TOP = Fconcat (3, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bconcat4:
+	CASE (Bconcat4):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (3);
 	  TOP = Fconcat (4, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case BconcatN:
+	CASE (BconcatN):
 	  op = FETCH;
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (op - 1);
 	  TOP = Fconcat (op, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bsub1:
+	CASE (Bsub1):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
@@ -1087,10 +1366,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 		TOP = Fsub1 (v1);
 		AFTER_POTENTIAL_GC ();
 	      }
-	    break;
+	    NEXT;
 	  }
 
-	case Badd1:
+	CASE (Badd1):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
@@ -1105,10 +1384,10 @@ If the third argument is incorrect, Emacs may crash.  */)
 		TOP = Fadd1 (v1);
 		AFTER_POTENTIAL_GC ();
 	      }
-	    break;
+	    NEXT;
 	  }
 
-	case Beqlsign:
+	CASE (Beqlsign):
 	  {
 	    Lisp_Object v1, v2;
 	    BEFORE_POTENTIAL_GC ();
@@ -1126,57 +1405,57 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      }
 	    else
 	      TOP = (XINT (v1) == XINT (v2) ? Qt : Qnil);
-	    break;
+	    NEXT;
 	  }
 
-	case Bgtr:
+	CASE (Bgtr):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fgtr (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Blss:
+	CASE (Blss):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Flss (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bleq:
+	CASE (Bleq):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fleq (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bgeq:
+	CASE (Bgeq):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fgeq (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bdiff:
+	CASE (Bdiff):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fminus (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bnegate:
+	CASE (Bnegate):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
@@ -1191,209 +1470,209 @@ If the third argument is incorrect, Emacs may crash.  */)
 		TOP = Fminus (1, &TOP);
 		AFTER_POTENTIAL_GC ();
 	      }
-	    break;
+	    NEXT;
 	  }
 
-	case Bplus:
+	CASE (Bplus):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fplus (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bmax:
+	CASE (Bmax):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fmax (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bmin:
+	CASE (Bmin):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fmin (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bmult:
+	CASE (Bmult):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Ftimes (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bquo:
+	CASE (Bquo):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fquo (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Brem:
+	CASE (Brem):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Frem (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bpoint:
+	CASE (Bpoint):
 	  {
 	    Lisp_Object v1;
 	    XSETFASTINT (v1, PT);
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bgoto_char:
+	CASE (Bgoto_char):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fgoto_char (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Binsert:
+	CASE (Binsert):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Finsert (1, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case BinsertN:
+	CASE (BinsertN):
 	  op = FETCH;
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (op - 1);
 	  TOP = Finsert (op, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bpoint_max:
+	CASE (Bpoint_max):
 	  {
 	    Lisp_Object v1;
 	    XSETFASTINT (v1, ZV);
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bpoint_min:
+	CASE (Bpoint_min):
 	  {
 	    Lisp_Object v1;
 	    XSETFASTINT (v1, BEGV);
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bchar_after:
+	CASE (Bchar_after):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fchar_after (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bfollowing_char:
+	CASE (Bfollowing_char):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = Ffollowing_char ();
 	    AFTER_POTENTIAL_GC ();
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bpreceding_char:
+	CASE (Bpreceding_char):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = Fprevious_char ();
 	    AFTER_POTENTIAL_GC ();
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bcurrent_column:
+	CASE (Bcurrent_column):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    XSETFASTINT (v1, (int) current_column ()); /* iftc */
 	    AFTER_POTENTIAL_GC ();
 	    PUSH (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bindent_to:
+	CASE (Bindent_to):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Findent_to (TOP, Qnil);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Beolp:
+	CASE (Beolp):
 	  PUSH (Feolp ());
-	  break;
+	  NEXT;
 
-	case Beobp:
+	CASE (Beobp):
 	  PUSH (Feobp ());
-	  break;
+	  NEXT;
 
-	case Bbolp:
+	CASE (Bbolp):
 	  PUSH (Fbolp ());
-	  break;
+	  NEXT;
 
-	case Bbobp:
+	CASE (Bbobp):
 	  PUSH (Fbobp ());
-	  break;
+	  NEXT;
 
-	case Bcurrent_buffer:
+	CASE (Bcurrent_buffer):
 	  PUSH (Fcurrent_buffer ());
-	  break;
+	  NEXT;
 
-	case Bset_buffer:
+	CASE (Bset_buffer):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fset_buffer (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Binteractive_p:
+	CASE (Binteractive_p):
 	  PUSH (Finteractive_p ());
-	  break;
+	  NEXT;
 
-	case Bforward_char:
+	CASE (Bforward_char):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fforward_char (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bforward_word:
+	CASE (Bforward_word):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fforward_word (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bskip_chars_forward:
+	CASE (Bskip_chars_forward):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fskip_chars_forward (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bskip_chars_backward:
+	CASE (Bskip_chars_backward):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fskip_chars_backward (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bforward_line:
+	CASE (Bforward_line):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fforward_line (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bchar_syntax:
+	CASE (Bchar_syntax):
 	  {
 	    int c;
 
@@ -1405,51 +1684,51 @@ If the third argument is incorrect, Emacs may crash.  */)
 	      MAKE_CHAR_MULTIBYTE (c);
 	    XSETFASTINT (TOP, syntax_code_spec[(int) SYNTAX (c)]);
 	  }
-	  break;
+	  NEXT;
 
-	case Bbuffer_substring:
+	CASE (Bbuffer_substring):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fbuffer_substring (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bdelete_region:
+	CASE (Bdelete_region):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fdelete_region (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bnarrow_to_region:
+	CASE (Bnarrow_to_region):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fnarrow_to_region (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bwiden:
+	CASE (Bwiden):
 	  BEFORE_POTENTIAL_GC ();
 	  PUSH (Fwiden ());
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bend_of_line:
+	CASE (Bend_of_line):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fend_of_line (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bset_marker:
+	CASE (Bset_marker):
 	  {
 	    Lisp_Object v1, v2;
 	    BEFORE_POTENTIAL_GC ();
@@ -1457,72 +1736,72 @@ If the third argument is incorrect, Emacs may crash.  */)
 	    v2 = POP;
 	    TOP = Fset_marker (TOP, v2, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bmatch_beginning:
+	CASE (Bmatch_beginning):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fmatch_beginning (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bmatch_end:
+	CASE (Bmatch_end):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fmatch_end (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bupcase:
+	CASE (Bupcase):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fupcase (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bdowncase:
+	CASE (Bdowncase):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fdowncase (TOP);
 	  AFTER_POTENTIAL_GC ();
-	break;
+	  NEXT;
 
-	case Bstringeqlsign:
+	CASE (Bstringeqlsign):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fstring_equal (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bstringlss:
+	CASE (Bstringlss):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fstring_lessp (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bequal:
+	CASE (Bequal):
 	  {
 	    Lisp_Object v1;
 	    v1 = POP;
 	    TOP = Fequal (TOP, v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bnthcdr:
+	CASE (Bnthcdr):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fnthcdr (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Belt:
+	CASE (Belt):
 	  {
 	    Lisp_Object v1, v2;
 	    if (CONSP (TOP))
@@ -1547,104 +1826,104 @@ If the third argument is incorrect, Emacs may crash.  */)
 		TOP = Felt (TOP, v1);
 		AFTER_POTENTIAL_GC ();
 	      }
-	    break;
+	    NEXT;
 	  }
 
-	case Bmember:
+	CASE (Bmember):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fmember (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bassq:
+	CASE (Bassq):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fassq (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bnreverse:
+	CASE (Bnreverse):
 	  BEFORE_POTENTIAL_GC ();
 	  TOP = Fnreverse (TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bsetcar:
+	CASE (Bsetcar):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fsetcar (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bsetcdr:
+	CASE (Bsetcdr):
 	  {
 	    Lisp_Object v1;
 	    BEFORE_POTENTIAL_GC ();
 	    v1 = POP;
 	    TOP = Fsetcdr (TOP, v1);
 	    AFTER_POTENTIAL_GC ();
-	    break;
+	    NEXT;
 	  }
 
-	case Bcar_safe:
+	CASE (Bcar_safe):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
 	    TOP = CAR_SAFE (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bcdr_safe:
+	CASE (Bcdr_safe):
 	  {
 	    Lisp_Object v1;
 	    v1 = TOP;
 	    TOP = CDR_SAFE (v1);
-	    break;
+	    NEXT;
 	  }
 
-	case Bnconc:
+	CASE (Bnconc):
 	  BEFORE_POTENTIAL_GC ();
 	  DISCARD (1);
 	  TOP = Fnconc (2, &TOP);
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 
-	case Bnumberp:
+	CASE (Bnumberp):
 	  TOP = (NUMBERP (TOP) ? Qt : Qnil);
-	  break;
+	  NEXT;
 
-	case Bintegerp:
+	CASE (Bintegerp):
 	  TOP = INTEGERP (TOP) ? Qt : Qnil;
-	  break;
+	  NEXT;
 
 #ifdef BYTE_CODE_SAFE
-	case Bset_mark:
+	CASE (Bset_mark):
 	  BEFORE_POTENTIAL_GC ();
 	  error ("set-mark is an obsolete bytecode");
 	  AFTER_POTENTIAL_GC ();
-	  break;
-	case Bscan_buffer:
+	  NEXT;
+	CASE (Bscan_buffer):
 	  BEFORE_POTENTIAL_GC ();
 	  error ("scan-buffer is an obsolete bytecode");
 	  AFTER_POTENTIAL_GC ();
-	  break;
+	  NEXT;
 #endif
 
-	case 0:
+	CASE (0):
 	  abort ();
 
 	case 255:
-	default:
+	CASE_DEFAULT:
 #ifdef BYTE_CODE_SAFE
 	  if (op < Bconstant)
 	    {
@@ -1658,11 +1937,16 @@ If the third argument is incorrect, Emacs may crash.  */)
 #else
 	  PUSH (vectorp[op - Bconstant]);
 #endif
+	  NEXT;
 	}
     }
 
  exit:
 
+  /* Go back to timing the instruction that called this function.  */
+  if (metering && byte_metering_on)
+    byte_meter_charge (outer_class);
+
   byte_stack_list = byte_stack_list->next;
 
   /* Binds and unbinds are supposed to be compiled balanced.  */
@@ -1684,7 +1968,15 @@ syms_of_bytecode ()
 
   defsubr (&Sbyte_code);
 
-#ifdef BYTE_CODE_METER
+  defsubr (&Sbyte_code_meter_start);
+  defsubr (&Sbyte_code_meter_stop);
+  defsubr (&Sbyte_code_meter_reset);
+  defsubr (&Sbyte_code_meter_times);
+  defsubr (&Sbyte_code_meter_calls);
+
+  byte_meter_calls = Qnil;
+  staticpro (&byte_meter_calls);
+  byte_meter_class = -1;
 
   DEFVAR_LISP ("byte-code-meter", &Vbyte_code_meter,
 	       doc: /* A vector of vectors which holds a histogram of byte-code usage.
@@ -1692,25 +1984,19 @@ syms_of_bytecode ()
 opcode CODE has been executed.
 \(aref (aref byte-code-meter CODE1) CODE2), where CODE1 is not 0,
 indicates how many times the byte opcodes CODE1 and CODE2 have been
-executed in succession.  */);
+executed in succession.
+It is nil until `byte-code-meter-start' is first called.  */);
 
   DEFVAR_BOOL ("byte-metering-on", &byte_metering_on,
 	       doc: /* If non-nil, keep profiling information on byte code usage.
-The variable byte-code-meter indicates how often each byte opcode is used.
-If a symbol has a property named `byte-code-meter' whose value is an
-integer, it is incremented each time that symbol's function is called.  */);
+The variable `byte-code-meter' indicates how often each byte opcode is
+used, `byte-code-meter-times' how long each class of opcodes took, and
+`byte-code-meter-calls' how often byte-code called each function.
+A byte-code function is metered if this is non-nil when it is entered.
+Use `byte-code-meter-start' and `byte-code-meter-stop' to set it.  */);
 
   byte_metering_on = 0;
-  Vbyte_code_meter = Fmake_vector (make_number (256), make_number (0));
-  Qbyte_code_meter = intern ("byte-code-meter");
-  staticpro (&Qbyte_code_meter);
-  {
-    int i = 256;
-    while (i--)
-      XVECTOR (Vbyte_code_meter)->contents[i] =
-	Fmake_vector (make_number (256), make_number (0));
-  }
-#endif
+  Vbyte_code_meter = Qnil;
 }
 
 /* arch-tag: b9803b6f-1ed6-4190-8adf-33fd3a9d10e9
@@ -0,0 +1,227 @@
+/* Byte-code opcodes and execution stacks.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GNU Emacs.
+
+GNU Emacs is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+GNU Emacs is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* This is shared by the byte-code interpreter in bytecode.c and by
+   the C code that byte-native.el translates byte-code into.  */
+
+/*  Byte codes: */
+
+#define Bvarref 010
+#define Bvarset 020
+#define Bvarbind 030
+#define Bcall 040
+#define Bunbind 050
+
+#define Bnth 070
+#define Bsymbolp 071
+#define Bconsp 072
+#define Bstringp 073
+#define Blistp 074
+#define Beq 075
+#define Bmemq 076
+#define Bnot 077
+#define Bcar 0100
+#define Bcdr 0101
+#define Bcons 0102
+#define Blist1 0103
+#define Blist2 0104
+#define Blist3 0105
+#define Blist4 0106
+#define Blength 0107
+#define Baref 0110
+#define Baset 0111
+#define Bsymbol_value 0112
+#define Bsymbol_function 0113
+#define Bset 0114
+#define Bfset 0115
+#define Bget 0116
+#define Bsubstring 0117
+#define Bconcat2 0120
+#define Bconcat3 0121
+#define Bconcat4 0122
+#define Bsub1 0123
+#define Badd1 0124
+#define Beqlsign 0125
+#define Bgtr 0126
+#define Blss 0127
+#define Bleq 0130
+#define Bgeq 0131
+#define Bdiff 0132
+#define Bnegate 0133
+#define Bplus 0134
+#define Bmax 0135
+#define Bmin 0136
+#define Bmult 0137
+
+#define Bpoint 0140
+/* Was Bmark in v17.  */
+#define Bsave_current_buffer 0141
+#define Bgoto_char 0142
+#define Binsert 0143
+#define Bpoint_max 0144
+#define Bpoint_min 0145
+#define Bchar_after 0146
+#define Bfollowing_char 0147
+#define Bpreceding_char 0150
+#define Bcurrent_column 0151
+#define Bindent_to 0152
+#define Bscan_buffer 0153 /* No longer generated as of v18 */
+#define Beolp 0154
+#define Beobp 0155
+#define Bbolp 0156
+#define Bbobp 0157
+#define Bcurrent_buffer 0160
+#define Bset_buffer 0161
+#define Bsave_current_buffer_1 0162 /* Replacing Bsave_current_buffer.  */
+#define Bread_char 0162 /* No longer generated as of v19 */
+#define Bset_mark 0163 /* this loser is no longer generated as of v18 */
+#define Binteractive_p 0164 /* Needed since interactive-p takes unevalled args */
+
+#define Bforward_char 0165
+#define Bforward_word 0166
+#define Bskip_chars_forward 0167
+#define Bskip_chars_backward 0170
+#define Bforward_line 0171
+#define Bchar_syntax 0172
+#define Bbuffer_substring 0173
+#define Bdelete_region 0174
+#define Bnarrow_to_region 0175
+#define Bwiden 0176
+#define Bend_of_line 0177
+
+#define Bconstant2 0201
+#define Bgoto 0202
+#define Bgotoifnil 0203
+#define Bgotoifnonnil 0204
+#define Bgotoifnilelsepop 0205
+#define Bgotoifnonnilelsepop 0206
+#define Breturn 0207
+#define Bdiscard 0210
+#define Bdup 0211
+
+#define Bsave_excursion 0212
+#define Bsave_window_excursion 0213
+#define Bsave_restriction 0214
+#define Bcatch 0215
+
+#define Bunwind_protect 0216
+#define Bcondition_case 0217
+#define Btemp_output_buffer_setup 0220
+#define Btemp_output_buffer_show 0221
+
+#define Bunbind_all 0222
+
+#define Bset_marker 0223
+#define Bmatch_beginning 0224
+#define Bmatch_end 0225
+#define Bupcase 0226
+#define Bdowncase 0227
+
+#define Bstringeqlsign 0230
+#define Bstringlss 0231
+#define Bequal 0232
+#define Bnthcdr 0233
+#define Belt 0234
+#define Bmember 0235
+#define Bassq 0236
+#define Bnreverse 0237
+#define Bsetcar 0240
+#define Bsetcdr 0241
+#define Bcar_safe 0242
+#define Bcdr_safe 0243
+#define Bnconc 0244
+#define Bquo 0245
+#define Brem 0246
+#define Bnumberp 0247
+#define Bintegerp 0250
+
+#define BRgoto 0252
+#define BRgotoifnil 0253
+#define BRgotoifnonnil 0254
+#define BRgotoifnilelsepop 0255
+#define BRgotoifnonnilelsepop 0256
+
+#define BlistN 0257
+#define BconcatN 0260
+#define BinsertN 0261
+
+#define Bconstant 0300
+#define CONSTANTLIM 0100
+
+
+/* Structure describing a value stack used during byte-code execution
+   in Fbyte_code.  */
+
+struct byte_stack
+{
+  /* Program counter.  This points into the byte_string below
+     and is relocated when that string is relocated.  */
+  const unsigned char *pc;
+
+  /* Top and bottom of stack.  The bottom points to an area of memory
+     allocated with alloca in Fbyte_code.  */
+  Lisp_Object *top, *bottom;
+
+  /* The string containing the byte-code, and its current address.
+     Storing this here protects it from GC because mark_byte_stack
+     marks it.  */
+  Lisp_Object byte_string;
+  const unsigned char *byte_string_start;
+
+  /* The vector of constants used during byte-code execution.  Storing
+     this here protects it from GC because mark_byte_stack marks it.  */
+  Lisp_Object constants;
+
+  /* Next entry in byte_stack_list.  */
+  struct byte_stack *next;
+};
+
+
+/* Native code.
+
+   A shared object made by byte-native.el from a .elc file defines one
+   C function for each byte-code string it could translate.
+   exec_byte_code calls that function instead of interpreting the
+   string, with the stack it has set up: TOP points to the last
+   argument pushed (or below BOTTOM), and VECTORP to the contents of
+   the constants vector.  The function returns the value of the
+   byte-code, and maintains STACK->top around anything that can GC
+   like the interpreter does.  */
+
+typedef Lisp_Object (*native_function) P_ ((struct byte_stack *stack,
+					    Lisp_Object *vectorp,
+					    Lisp_Object *top));
+
+/* The shared object exports an array of these called
+   `emacs_native_functions', ended by an entry whose BYTECODE is null,
+   `emacs_native_abi_version', which must be NATIVE_ABI_VERSION, and
+   `emacs_native_emacs_version', the value of `emacs-version' of the
+   Emacs it was made for.  BYTECODE and LENGTH are the byte-code string the function was
+   translated from.  */
+
+struct native_function_entry
+{
+  const char *bytecode;
+  int length;
+  native_function function;
+};
+
+#define NATIVE_ABI_VERSION 1
+
+/* Defined in native.c.  */
+extern native_function lookup_native_function P_ ((Lisp_Object));
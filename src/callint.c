@@ -357,12 +357,16 @@ invoke it.  If KEYS is omitted or nil, the return value of
     }
   else
     {
-      Lisp_Object input;
+      Lisp_Object input, funval;
       i = num_input_events;
       input = specs;
-      /* Compute the arg values using the user's expression.  */
+      /* Compute the arg values using the user's expression, in the
+	 lexical environment of FUNCTION if it is a closure.  */
       GCPRO2 (input, filter_specs);
-      specs = Feval (specs);
+      funval = indirect_function (function);
+      specs = Feval (specs,
+		     CONSP (funval) && EQ (XCAR (funval), Qclosure)
+		     ? CAR_SAFE (XCDR (funval)) : Qnil);
       UNGCPRO;
       if (i != num_input_events || !NILP (record_flag))
 	{
@@ -2336,6 +2336,70 @@ init_charset_once ()
 
 #ifdef emacs
 
+/* Save the table of charsets, which is not made of Lisp objects, in
+   a portable dump.  */
+
+static void
+charset_dump_save ()
+{
+  Lisp_Object tail;
+  int i, id;
+
+  pdump_write_data (&charset_table_used, sizeof charset_table_used);
+  pdump_write_data (charset_table,
+		    sizeof (struct charset) * charset_table_used);
+  for (i = 0; i < charset_table_used; i++)
+    if (! charset_table[i].code_linear_p)
+      pdump_write_data (charset_table[i].code_space_mask, 256);
+  for (i = 0; i < 256; i++)
+    {
+      id = emacs_mule_charset[i] ? emacs_mule_charset[i]->id : -1;
+      pdump_write_data (&id, sizeof id);
+    }
+
+  /* Vcharset_non_preferred_head is a tail of Vcharset_ordered_list.  */
+  for (i = 0, tail = Vcharset_ordered_list;
+       CONSP (tail) && !EQ (tail, Vcharset_non_preferred_head);
+       i++, tail = XCDR (tail))
+    ;
+  if (!EQ (tail, Vcharset_non_preferred_head))
+    i = -1;
+  pdump_write_data (&i, sizeof i);
+}
+
+/* Restore what charset_dump_save saved.  */
+
+static void
+charset_dump_load ()
+{
+  int i, id, used;
+
+  pdump_read_data (&used, sizeof used);
+  if (used > charset_table_size)
+    {
+      charset_table_size = used + 16;
+      charset_table = ((struct charset *)
+		       xmalloc (sizeof (struct charset) * charset_table_size));
+    }
+  charset_table_used = used;
+  pdump_read_data (charset_table, sizeof (struct charset) * used);
+  for (i = 0; i < used; i++)
+    if (! charset_table[i].code_linear_p)
+      {
+	charset_table[i].code_space_mask = (unsigned char *) xmalloc (256);
+	pdump_read_data (charset_table[i].code_space_mask, 256);
+      }
+  for (i = 0; i < 256; i++)
+    {
+      pdump_read_data (&id, sizeof id);
+      emacs_mule_charset[i] = id < 0 ? NULL : CHARSET_FROM_ID (id);
+    }
+
+  pdump_read_data (&i, sizeof i);
+  Vcharset_non_preferred_head
+    = i < 0 ? Qnil : Fnthcdr (make_number (i), Vcharset_ordered_list);
+}
+
 void
 syms_of_charset ()
 {
@@ -2376,6 +2440,22 @@ syms_of_charset ()
 		   xmalloc (sizeof (struct charset) * charset_table_size));
   charset_table_used = 0;
 
+  pdump_remember_scalar (&charset_ascii, sizeof charset_ascii);
+  pdump_remember_scalar (&charset_eight_bit, sizeof charset_eight_bit);
+  pdump_remember_scalar (&charset_iso_8859_1, sizeof charset_iso_8859_1);
+  pdump_remember_scalar (&charset_unicode, sizeof charset_unicode);
+  pdump_remember_scalar (&charset_emacs, sizeof charset_emacs);
+  pdump_remember_scalar (&charset_jisx0201_roman,
+			 sizeof charset_jisx0201_roman);
+  pdump_remember_scalar (&charset_jisx0208_1978, sizeof charset_jisx0208_1978);
+  pdump_remember_scalar (&charset_jisx0208, sizeof charset_jisx0208);
+  pdump_remember_scalar (&charset_ksc5601, sizeof charset_ksc5601);
+  pdump_remember_scalar (&charset_unibyte, sizeof charset_unibyte);
+  pdump_remember_scalar (&charset_ordered_list_tick,
+			 sizeof charset_ordered_list_tick);
+  pdump_remember_scalar (iso_charset_table, sizeof iso_charset_table);
+  pdump_add_hooks (charset_dump_save, charset_dump_load);
+
   defsubr (&Scharsetp);
   defsubr (&Smap_charset_chars);
   defsubr (&Sdefine_charset_internal);
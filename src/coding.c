@@ -10394,6 +10394,36 @@ init_coding_once ()
 
 #ifdef emacs
 
+/* Save the coding system of each category in a portable dump.  */
+
+static void
+coding_dump_save ()
+{
+  int i;
+
+  for (i = 0; i < coding_category_max; i++)
+    pdump_write_data (&coding_categories[i].id, sizeof (int));
+}
+
+/* Set up the coding systems of the categories again from the ids
+   coding_dump_save saved; the rest of struct coding_system is not
+   worth saving, as setup_coding_system computes it.  */
+
+static void
+coding_dump_load ()
+{
+  int i, id;
+
+  for (i = 0; i < coding_category_max; i++)
+    {
+      pdump_read_data (&id, sizeof id);
+      if (id >= 0)
+	setup_coding_system (CODING_ID_NAME (id), &coding_categories[i]);
+      else
+	coding_categories[i].id = -1;
+    }
+}
+
 void
 syms_of_coding ()
 {
@@ -10405,6 +10435,10 @@ syms_of_coding ()
     Vcoding_system_hash_table = Fmake_hash_table (2, args);
   }
 
+  pdump_remember_scalar (coding_priorities, sizeof coding_priorities);
+  pdump_remember_scalar (emacs_mule_bytes, sizeof emacs_mule_bytes);
+  pdump_add_hooks (coding_dump_save, coding_dump_load);
+
   staticpro (&Vsjis_coding_system);
   Vsjis_coding_system = Qnil;
 
@@ -397,10 +397,14 @@ string is passed through `substitute-command-keys'.  */)
       else if (EQ (funcar, Qkeymap))
 	return build_string ("Prefix command (definition is a keymap associating keystrokes with commands).");
       else if (EQ (funcar, Qlambda)
+	       || EQ (funcar, Qclosure)
 	       || EQ (funcar, Qautoload))
 	{
 	  Lisp_Object tem1;
 	  tem1 = Fcdr (Fcdr (fun));
+	  /* Skip the environment of a closure.  */
+	  if (EQ (funcar, Qclosure))
+	    tem1 = Fcdr (tem1);
 	  tem = Fcar (tem1);
 	  if (STRINGP (tem))
 	    doc = tem;
@@ -505,7 +509,7 @@ aren't strings.  */)
     }
   else if (!STRINGP (tem))
     /* Feval protects its argument.  */
-    tem = Feval (tem);
+    tem = Feval (tem, Qnil);
 
   if (NILP (raw) && STRINGP (tem))
     tem = Fsubstitute_command_keys (tem);
@@ -540,6 +544,12 @@ store_function_docstring (fun, offset)
 	  if (CONSP (tem) && INTEGERP (XCAR (tem)))
 	    XSETCARFASTINT (tem, offset);
 	}
+      else if (EQ (tem, Qclosure))
+	{
+	  tem = Fcdr (Fcdr (Fcdr (fun)));
+	  if (CONSP (tem) && INTEGERP (XCAR (tem)))
+	    XSETCARFASTINT (tem, offset);
+	}
       else if (EQ (tem, Qmacro))
 	store_function_docstring (XCDR (fun), offset);
     }
@@ -985,6 +985,24 @@ save_excursion_restore (info)
   return Qnil;
 }
 
+/* Free INFO, made by save_excursion_save, once save_excursion_restore
+   has used it.  Only for INFO that nothing else can refer to.  */
+
+void
+free_save_excursion (info)
+     Lisp_Object info;
+{
+  Lisp_Object tail, next;
+
+  free_marker (XCAR (info));
+  free_marker (XCAR (XCDR (info)));
+  for (tail = info; CONSP (tail); tail = next)
+    {
+      next = XCDR (tail);
+      free_cons (XCONS (tail));
+    }
+}
+
 DEFUN ("save-excursion", Fsave_excursion, Ssave_excursion, 0, UNEVALLED, 0,
        doc: /* Save point, mark, and current buffer; execute BODY; restore those things.
 Executes BODY just like `progn'.
@@ -1004,7 +1022,7 @@ usage: (save-excursion &rest BODY)  */)
   register Lisp_Object val;
   int count = SPECPDL_INDEX ();
 
-  record_unwind_protect (save_excursion_restore, save_excursion_save ());
+  record_unwind_save_excursion ();
 
   val = Fprogn (args);
   return unbind_to (count, val);
@@ -271,6 +271,7 @@ Initialization options:\n\
 --daemon                    start a server in the background\n\
 --debug-init                enable Emacs Lisp debugger for init file\n\
 --display, -d DISPLAY       use X server DISPLAY\n\
+--dump-file FILE            load the Lisp state from portable dump FILE\n\
 --no-desktop                do not load a saved desktop\n\
 --no-init-file, -q          load neither ~/.emacs nor default.el\n\
 --no-shared-memory, -nl     do not use shared memory\n\
@@ -781,6 +782,39 @@ bug_reporting_address ()
 }
 
 
+/* Load the portable dump FILE, a Lisp string, into the Emacs starting
+   instead of loading loadup.el, and compute again what depends on how
+   and where this Emacs runs rather than on the one that wrote the
+   dump.  Exit if FILE cannot be loaded.  */
+
+static void
+load_portable_dump (file, argc, argv, skip_args)
+     Lisp_Object file;
+     int argc;
+     char **argv;
+     int skip_args;
+{
+  char *error = pdump_load ((char *) SDATA (ENCODE_FILE (file)));
+
+  if (error)
+    fatal ("%s: %s\n", SDATA (file), error);
+
+  initialized = 1;
+  noninteractive1 = noninteractive;
+  Vprocess_environment = Qnil;
+  set_initial_environment ();
+  init_buffer ();
+  init_callproc_1 ();
+  init_cmdargs (argc, argv, skip_args);
+  init_callproc ();
+  init_lread ();
+  pdump_after_load ();
+
+  /* Buffers are not dumped; make *Messages*, which an unexeced Emacs
+     has had since loadup and which startup.el expects to exist.  */
+  Fget_buffer_create (build_string ("*Messages*"));
+}
+
 /* ARGSUSED */
 int
 main (int argc, char **argv)
@@ -798,6 +832,7 @@ main (int argc, char **argv)
   struct rlimit rlim;
 #endif
   int no_loadup = 0;
+  char *dump_file = 0;
   char *junk = 0;
   char *dname_arg = 0;
 #ifdef NS_IMPL_COCOA
@@ -1468,6 +1503,7 @@ main (int argc, char **argv)
 	}
     }
 
+  argmatch (argv, argc, "-dump-file", "--dump-file", 6, &dump_file, &skip_args);
   no_loadup
     = argmatch (argv, argc, "-nl", "--no-loadup", 6, NULL, &skip_args);
 
@@ -1642,7 +1678,10 @@ main (int argc, char **argv)
       syms_of_macros ();
       syms_of_marker ();
       syms_of_minibuf ();
+      syms_of_native ();
+      syms_of_pdump ();
       syms_of_process ();
+      syms_of_profiler ();
       syms_of_search ();
       syms_of_frame ();
       syms_of_syntax ();
@@ -1729,6 +1768,24 @@ main (int argc, char **argv)
 #endif  /* HAVE_NTGUI */
     }
 
+  if (!initialized && !no_loadup)
+    {
+      /* Load the portable dump named on the command line, or else the
+	 one made for this executable, if there is one.  temacs never
+	 looks for one by itself, since it is what makes them.  */
+      Lisp_Object file = Qnil;
+
+      if (dump_file)
+	file = build_string (dump_file);
+      else if (strncmp ((char *) SDATA (Vinvocation_name), "temacs", 6))
+	file = pdump_default_file ();
+      if (!NILP (file))
+	load_portable_dump (file, argc, argv, skip_args);
+    }
+  else if (initialized && dump_file)
+    fatal ("--dump-file: Emacs was dumped with unexec and cannot load %s\n",
+	   dump_file);
+
   init_charset ();
 
   init_editfns (); /* init_process uses Voperating_system_release. */
@@ -1859,6 +1916,7 @@ struct standard_args standard_args[] =
   { "-multibyte", "--multibyte", 82, 0 },
   { "-unibyte", "--unibyte", 81, 0 },
   { "-no-multibyte", "--no-multibyte", 80, 0 },
+  { "-dump-file", "--dump-file", 71, 1 },
   { "-nl", "--no-loadup", 70, 0 },
   /* -d must come last before the options handled in startup.el.  */
   { "-d", "--display", 60, 1 },
@@ -34,19 +34,6 @@ along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
 /* This definition is duplicated in alloc.c and keyboard.c */
 /* Putting it in lisp.h makes cc bomb out! */
 
-struct backtrace
-{
-  struct backtrace *next;
-  Lisp_Object *function;
-  Lisp_Object *args;	/* Points to vector of args. */
-  int nargs;		/* Length of vector.
-			   If nargs is UNEVALLED, args points to slot holding
-			   list of unevalled args */
-  char evalargs;
-  /* Nonzero means call value of debugger when done with this operation. */
-  char debug_on_exit;
-};
-
 struct backtrace *backtrace_list;
 
 struct catchtag *catchlist;
@@ -62,8 +49,18 @@ Lisp_Object Qand_rest, Qand_optional;
 Lisp_Object Qdebug_on_error;
 Lisp_Object Qdeclare;
 Lisp_Object Qdebug;
+Lisp_Object Qclosure;
 extern Lisp_Object Qinteractive_form;
 
+/* The lexical environment of the code being interpreted: nil when
+   variables are bound dynamically, or a list of (SYMBOL . VALUE)
+   lexical bindings.  The list can also contain symbols, which are
+   declared locally special, and ends in t when nothing else is in
+   it.  */
+
+Lisp_Object Vinternal_interpreter_environment;
+Lisp_Object Qinternal_interpreter_environment;
+
 /* This holds either the symbol `run-hooks' or nil.
    It is nil at an early stage of startup, and when Emacs
    is shutting down.  */
@@ -308,7 +305,7 @@ usage: (or CONDITIONS...)  */)
 
   while (CONSP (args))
     {
-      val = Feval (XCAR (args));
+      val = eval_sub (XCAR (args));
       if (!NILP (val))
 	break;
       args = XCDR (args);
@@ -333,7 +330,7 @@ usage: (and CONDITIONS...)  */)
 
   while (CONSP (args))
     {
-      val = Feval (XCAR (args));
+      val = eval_sub (XCAR (args));
       if (NILP (val))
 	break;
       args = XCDR (args);
@@ -356,11 +353,11 @@ usage: (if COND THEN ELSE...)  */)
   struct gcpro gcpro1;
 
   GCPRO1 (args);
-  cond = Feval (Fcar (args));
+  cond = eval_sub (Fcar (args));
   UNGCPRO;
 
   if (!NILP (cond))
-    return Feval (Fcar (Fcdr (args)));
+    return eval_sub (Fcar (Fcdr (args)));
   return Fprogn (Fcdr (Fcdr (args)));
 }
 
@@ -385,7 +382,7 @@ usage: (cond CLAUSES...)  */)
   while (!NILP (args))
     {
       clause = Fcar (args);
-      val = Feval (Fcar (clause));
+      val = eval_sub (Fcar (clause));
       if (!NILP (val))
 	{
 	  if (!EQ (XCDR (clause), Qnil))
@@ -412,7 +409,7 @@ usage: (progn BODY...)  */)
 
   while (CONSP (args))
     {
-      val = Feval (XCAR (args));
+      val = eval_sub (XCAR (args));
       args = XCDR (args);
     }
 
@@ -443,9 +440,9 @@ usage: (prog1 FIRST BODY...)  */)
   do
     {
       if (!(argnum++))
-        val = Feval (Fcar (args_left));
+        val = eval_sub (Fcar (args_left));
       else
-	Feval (Fcar (args_left));
+	eval_sub (Fcar (args_left));
       args_left = Fcdr (args_left);
     }
   while (!NILP(args_left));
@@ -479,9 +476,9 @@ usage: (prog2 FORM1 FORM2 BODY...)  */)
   do
     {
       if (!(argnum++))
-        val = Feval (Fcar (args_left));
+        val = eval_sub (Fcar (args_left));
       else
-	Feval (Fcar (args_left));
+	eval_sub (Fcar (args_left));
       args_left = Fcdr (args_left);
     }
   while (!NILP (args_left));
@@ -514,9 +511,20 @@ usage: (setq [SYM VAL]...)  */)
 
   do
     {
-      val = Feval (Fcar (Fcdr (args_left)));
+      Lisp_Object lex_binding;
+
+      val = eval_sub (Fcar (Fcdr (args_left)));
       sym = Fcar (args_left);
-      Fset (sym, val);
+
+      /* Whether SYM is special was checked when it was let-bound.  */
+      lex_binding = (SYMBOLP (sym)
+		     && !NILP (Vinternal_interpreter_environment)
+		     ? Fassq (sym, Vinternal_interpreter_environment)
+		     : Qnil);
+      if (CONSP (lex_binding))
+	XSETCDR (lex_binding, val);
+      else
+	Fset (sym, val);
       args_left = Fcdr (Fcdr (args_left));
     }
   while (!NILP(args_left));
@@ -539,14 +547,22 @@ usage: (quote ARG)  */)
 DEFUN ("function", Ffunction, Sfunction, 1, UNEVALLED, 0,
        doc: /* Like `quote', but preferred for objects which are functions.
 In byte compilation, `function' causes its argument to be compiled.
-`quote' cannot do that.
+`quote' cannot do that.  In lexically scoped code, a lambda expression
+evaluates to a closure over the current lexical environment.
 usage: (function ARG)  */)
      (args)
      Lisp_Object args;
 {
+  Lisp_Object quoted = Fcar (args);
+
   if (!NILP (Fcdr (args)))
     xsignal2 (Qwrong_number_of_arguments, Qfunction, Flength (args));
-  return Fcar (args);
+
+  if (!NILP (Vinternal_interpreter_environment)
+      && CONSP (quoted) && EQ (XCAR (quoted), Qlambda))
+    return Fcons (Qclosure,
+		  Fcons (Vinternal_interpreter_environment, XCDR (quoted)));
+  return quoted;
 }
 
 
@@ -653,7 +669,8 @@ interactive_p (exclude_subrs_p)
 
 DEFUN ("defun", Fdefun, Sdefun, 2, UNEVALLED, 0,
        doc: /* Define NAME as a function.
-The definition is (lambda ARGLIST [DOCSTRING] BODY...).
+The definition is (lambda ARGLIST [DOCSTRING] BODY...), or a closure
+with that argument list and body in lexically scoped code.
 See also the function `interactive'.
 usage: (defun NAME ARGLIST [DOCSTRING] BODY...)  */)
      (args)
@@ -665,6 +682,10 @@ usage: (defun NAME ARGLIST [DOCSTRING] BODY...)  */)
   fn_name = Fcar (args);
   CHECK_SYMBOL (fn_name);
   defn = Fcons (Qlambda, Fcdr (args));
+  /* In lexically scoped code, the function is a closure.  */
+  if (!NILP (Vinternal_interpreter_environment))
+    defn = Fcons (Qclosure, Fcons (Vinternal_interpreter_environment,
+				   XCDR (defn)));
   if (!NILP (Vpurify_flag))
     defn = Fpurecopy (defn);
   if (CONSP (XSYMBOL (fn_name)->function)
@@ -737,7 +758,12 @@ usage: (defmacro NAME ARGLIST [DOCSTRING] [DECL] BODY...)  */)
     tail = Fcons (lambda_list, tail);
   else
     tail = Fcons (lambda_list, Fcons (doc, tail));
-  defn = Fcons (Qmacro, Fcons (Qlambda, tail));
+  if (!NILP (Vinternal_interpreter_environment))
+    defn = Fcons (Qmacro, Fcons (Qclosure,
+				 Fcons (Vinternal_interpreter_environment,
+					tail)));
+  else
+    defn = Fcons (Qmacro, Fcons (Qlambda, tail));
 
   if (!NILP (Vpurify_flag))
     defn = Fpurecopy (defn);
@@ -778,6 +804,8 @@ The return value is BASE-VARIABLE.  */)
   if (NILP (Fboundp (base_variable)) && !NILP (Fboundp (new_alias)))
     XSYMBOL(base_variable)->value = sym->value;
   sym->indirect_variable = 1;
+  sym->declared_special = 1;
+  XSYMBOL (base_variable)->declared_special = 1;
   sym->value = base_variable;
   sym->constant = SYMBOL_CONSTANT_P (base_variable);
   LOADHIST_ATTACH (new_alias);
@@ -837,15 +865,16 @@ usage: (defvar SYMBOL &optional INITVALUE DOCSTRING)  */)
 		   SDATA (SYMBOL_NAME (sym)));
 	}
 
+      XSYMBOL (sym)->declared_special = 1;
       if (NILP (tem))
-	Fset_default (sym, Feval (Fcar (tail)));
+	Fset_default (sym, eval_sub (Fcar (tail)));
       else
 	{ /* Check if there is really a global binding rather than just a let
 	     binding that shadows the global unboundness of the var.  */
 	  volatile struct specbinding *pdl = specpdl_ptr;
 	  while (--pdl >= specpdl)
 	    {
-	      if (EQ (pdl->symbol, sym) && !pdl->func
+	      if (pdl->kind == SPECPDL_LET && EQ (pdl->symbol, sym)
 		  && EQ (pdl->old_value, Qunbound))
 		{
 		  message_with_string ("Warning: defvar ignored because %s is let-bound",
@@ -864,6 +893,12 @@ usage: (defvar SYMBOL &optional INITVALUE DOCSTRING)  */)
 	}
       LOADHIST_ATTACH (sym);
     }
+  else if (!NILP (Vinternal_interpreter_environment)
+	   && SYMBOLP (sym) && !XSYMBOL (sym)->declared_special)
+    /* A simple (defvar <var>) makes <var> special only in the scope
+       of the current lexical environment.  */
+    Vinternal_interpreter_environment
+      = Fcons (sym, Vinternal_interpreter_environment);
   else
     /* Simple (defvar <var>) should not count as a definition at all.
        It could get in the way of other definitions, and unloading this
@@ -894,10 +929,11 @@ usage: (defconst SYMBOL INITVALUE [DOCSTRING])  */)
   if (!NILP (Fcdr (Fcdr (Fcdr (args)))))
     error ("Too many arguments");
 
-  tem = Feval (Fcar (Fcdr (args)));
+  tem = eval_sub (Fcar (Fcdr (args)));
   if (!NILP (Vpurify_flag))
     tem = Fpurecopy (tem);
   Fset_default (sym, tem);
+  XSYMBOL (sym)->declared_special = 1;
   tem = Fcar (Fcdr (Fcdr (args)));
   if (!NILP (tem))
     {
@@ -910,6 +946,17 @@ usage: (defconst SYMBOL INITVALUE [DOCSTRING])  */)
   return sym;
 }
 
+DEFUN ("special-variable-p", Fspecial_variable_p, Sspecial_variable_p, 1, 1, 0,
+       doc: /* Return non-nil if SYMBOL's global binding has been declared special.
+A special variable is one that will be bound dynamically, even in a
+context where binding is lexical by default.  */)
+     (symbol)
+     Lisp_Object symbol;
+{
+  CHECK_SYMBOL (symbol);
+  return XSYMBOL (symbol)->declared_special ? Qt : Qnil;
+}
+
 /* Error handler used in Fuser_variable_p.  */
 static Lisp_Object
 user_variable_p_eh (ignore)
@@ -986,26 +1033,49 @@ usage: (let* VARLIST BODY...)  */)
      (args)
      Lisp_Object args;
 {
-  Lisp_Object varlist, val, elt;
+  Lisp_Object varlist, var, val, elt, lexenv;
   int count = SPECPDL_INDEX ();
   struct gcpro gcpro1, gcpro2, gcpro3;
 
   GCPRO3 (args, elt, varlist);
 
+  lexenv = Vinternal_interpreter_environment;
+
   varlist = Fcar (args);
   while (!NILP (varlist))
     {
       QUIT;
       elt = Fcar (varlist);
       if (SYMBOLP (elt))
-	specbind (elt, Qnil);
+	{
+	  var = elt;
+	  val = Qnil;
+	}
       else if (! NILP (Fcdr (Fcdr (elt))))
 	signal_error ("`let' bindings can have only one value-form", elt);
       else
 	{
-	  val = Feval (Fcar (Fcdr (elt)));
-	  specbind (Fcar (elt), val);
+	  var = Fcar (elt);
+	  val = eval_sub (Fcar (Fcdr (elt)));
+	}
+
+      if (!NILP (lexenv) && SYMBOLP (var)
+	  && !XSYMBOL (var)->declared_special
+	  && NILP (Fmemq (var, Vinternal_interpreter_environment)))
+	{
+	  /* Bind VAR lexically, in an environment that the following
+	     value forms already see.  The first such binding rebinds
+	     the environment; later ones just extend it.  */
+	  Lisp_Object newenv
+	    = Fcons (Fcons (var, val), Vinternal_interpreter_environment);
+	  if (EQ (Vinternal_interpreter_environment, lexenv))
+	    specbind (Qinternal_interpreter_environment, newenv);
+	  else
+	    Vinternal_interpreter_environment = newenv;
 	}
+      else
+	specbind (var, val);
+
       varlist = Fcdr (varlist);
     }
   UNGCPRO;
@@ -1023,7 +1093,7 @@ usage: (let VARLIST BODY...)  */)
      (args)
      Lisp_Object args;
 {
-  Lisp_Object *temps, tem;
+  Lisp_Object *temps, tem, lexenv;
   register Lisp_Object elt, varlist;
   int count = SPECPDL_INDEX ();
   register int argnum;
@@ -1049,22 +1119,36 @@ usage: (let VARLIST BODY...)  */)
       else if (! NILP (Fcdr (Fcdr (elt))))
 	signal_error ("`let' bindings can have only one value-form", elt);
       else
-	temps [argnum++] = Feval (Fcar (Fcdr (elt)));
+	temps [argnum++] = eval_sub (Fcar (Fcdr (elt)));
       gcpro2.nvars = argnum;
     }
   UNGCPRO;
 
+  lexenv = Vinternal_interpreter_environment;
+
   varlist = Fcar (args);
   for (argnum = 0; CONSP (varlist); varlist = XCDR (varlist))
     {
+      Lisp_Object var;
+
       elt = XCAR (varlist);
+      var = SYMBOLP (elt) ? elt : Fcar (elt);
       tem = temps[argnum++];
-      if (SYMBOLP (elt))
-	specbind (elt, tem);
+
+      if (!NILP (lexenv) && SYMBOLP (var)
+	  && !XSYMBOL (var)->declared_special
+	  && NILP (Fmemq (var, Vinternal_interpreter_environment)))
+	/* Lexically bind VAR by adding it to the lexenv alist.  */
+	lexenv = Fcons (Fcons (var, tem), lexenv);
       else
-	specbind (Fcar (elt), tem);
+	/* Dynamically bind VAR.  */
+	specbind (var, tem);
     }
 
+  if (!EQ (lexenv, Vinternal_interpreter_environment))
+    /* Instantiate a new lexical environment.  */
+    specbind (Qinternal_interpreter_environment, lexenv);
+
   elt = Fprogn (Fcdr (args));
   return unbind_to (count, elt);
 }
@@ -1084,7 +1168,7 @@ usage: (while TEST BODY...)  */)
 
   test = Fcar (args);
   body = Fcdr (args);
-  while (!NILP (Feval (test)))
+  while (!NILP (eval_sub (test)))
     {
       QUIT;
       Fprogn (body);
@@ -1189,7 +1273,7 @@ usage: (catch TAG BODY...)  */)
   struct gcpro gcpro1;
 
   GCPRO1 (args);
-  tag = Feval (Fcar (args));
+  tag = eval_sub (Fcar (args));
   UNGCPRO;
   return internal_catch (tag, Fprogn, Fcdr (args));
 }
@@ -1329,7 +1413,7 @@ usage: (unwind-protect BODYFORM UNWINDFORMS...)  */)
   int count = SPECPDL_INDEX ();
 
   record_unwind_protect (Fprogn, Fcdr (args));
-  val = Feval (Fcar (args));
+  val = eval_sub (Fcar (args));
   return unbind_to (count, val);
 }
 
@@ -1377,14 +1461,16 @@ usage: (condition-case VAR BODYFORM &rest HANDLERS)  */)
 }
 
 /* Like Fcondition_case, but the args are separate
-   rather than passed in a list.  Used by Fbyte_code.  */
+   rather than passed in a list.  Used by Fbyte_code.
+   BODYFORM and the handler bodies are evaluated with
+   eval_byte_code_body, so that byte-compiled ones run directly.  */
 
 Lisp_Object
 internal_lisp_condition_case (var, bodyform, handlers)
      volatile Lisp_Object var;
      Lisp_Object bodyform, handlers;
 {
-  Lisp_Object val;
+  Lisp_Object val, tem;
   struct catchtag c;
   struct handler h;
 
@@ -1392,7 +1478,6 @@ internal_lisp_condition_case (var, bodyform, handlers)
 
   for (val = handlers; CONSP (val); val = XCDR (val))
     {
-      Lisp_Object tem;
       tem = XCAR (val);
       if (! (NILP (tem)
 	     || (CONSP (tem)
@@ -1414,8 +1499,19 @@ internal_lisp_condition_case (var, bodyform, handlers)
   if (_setjmp (c.jmp))
     {
       if (!NILP (h.var))
-        specbind (h.var, c.val);
-      val = Fprogn (Fcdr (h.chosen_clause));
+	{
+	  if (!NILP (Vinternal_interpreter_environment)
+	      && SYMBOLP (h.var) && !XSYMBOL (h.var)->declared_special
+	      && NILP (Fmemq (h.var, Vinternal_interpreter_environment)))
+	    specbind (Qinternal_interpreter_environment,
+		      Fcons (Fcons (h.var, c.val),
+			     Vinternal_interpreter_environment));
+	  else
+	    specbind (h.var, c.val);
+	}
+      val = Qnil;
+      for (tem = Fcdr (h.chosen_clause); CONSP (tem); tem = XCDR (tem))
+	val = eval_byte_code_body (XCAR (tem));
 
       /* Note that this just undoes the binding of h.var; whoever
 	 longjumped to us unwound the stack to c.pdlcount before
@@ -1432,7 +1528,7 @@ internal_lisp_condition_case (var, bodyform, handlers)
   h.tag = &c;
   handlerlist = &h;
 
-  val = Feval (bodyform);
+  val = eval_byte_code_body (bodyform);
   catchlist = c.next;
   handlerlist = h.next;
   return val;
@@ -2088,7 +2184,10 @@ then strings and vectors are not accepted.  */)
   if (!CONSP (fun))
     return Qnil;
   funcar = XCAR (fun);
-  if (EQ (funcar, Qlambda))
+  if (EQ (funcar, Qclosure))
+    return (!NILP (Fassq (Qinteractive, Fcdr (Fcdr (XCDR (fun)))))
+	    ? Qt : if_prop);
+  else if (EQ (funcar, Qlambda))
     return !NILP (Fassq (Qinteractive, Fcdr (XCDR (fun)))) ? Qt : if_prop;
   if (EQ (funcar, Qautoload))
     return !NILP (Fcar (Fcdr (Fcdr (XCDR (fun))))) ? Qt : if_prop;
@@ -2213,9 +2312,28 @@ do_autoload (fundef, funname)
 }
 
 
-DEFUN ("eval", Feval, Seval, 1, 1, 0,
-       doc: /* Evaluate FORM and return its value.  */)
-     (form)
+DEFUN ("eval", Feval, Seval, 1, 2, 0,
+       doc: /* Evaluate FORM and return its value.
+If LEXICAL is t, evaluate using lexical scoping.  LEXICAL can also be
+an actual lexical environment, an alist mapping symbols to their
+values.  */)
+     (form, lexical)
+     Lisp_Object form, lexical;
+{
+  int count = SPECPDL_INDEX ();
+
+  if (NILP (lexical) && NILP (Vinternal_interpreter_environment))
+    return eval_sub (form);
+  specbind (Qinternal_interpreter_environment,
+	    CONSP (lexical) || NILP (lexical) ? lexical : Fcons (Qt, Qnil));
+  return unbind_to (count, eval_sub (form));
+}
+
+/* Evaluate FORM, a subexpression of the form being evaluated, in the
+   current lexical environment.  */
+
+Lisp_Object
+eval_sub (form)
      Lisp_Object form;
 {
   Lisp_Object fun, val, original_fun, original_args;
@@ -2227,7 +2345,14 @@ DEFUN ("eval", Feval, Seval, 1, 1, 0,
     abort ();
 
   if (SYMBOLP (form))
-    return Fsymbol_value (form);
+    {
+      /* Look up its binding in the lexical environment first.  */
+      Lisp_Object lex_binding
+	= (!NILP (Vinternal_interpreter_environment)
+	   ? Fassq (form, Vinternal_interpreter_environment)
+	   : Qnil);
+      return CONSP (lex_binding) ? XCDR (lex_binding) : Fsymbol_value (form);
+    }
   if (!CONSP (form))
     return form;
 
@@ -2254,12 +2379,14 @@ DEFUN ("eval", Feval, Seval, 1, 1, 0,
   original_args = Fcdr (form);
 
   backtrace.next = backtrace_list;
-  backtrace_list = &backtrace;
   backtrace.function = &original_fun; /* This also protects them from gc */
   backtrace.args = &original_args;
   backtrace.nargs = UNEVALLED;
   backtrace.evalargs = 1;
   backtrace.debug_on_exit = 0;
+  /* Link the frame in only now, so that the profiler's signal
+     handler never sees it half filled in.  */
+  backtrace_list = &backtrace;
 
   if (debug_on_next_call)
     do_debug_on_call (Qt);
@@ -2311,7 +2438,7 @@ DEFUN ("eval", Feval, Seval, 1, 1, 0,
 
 	  while (!NILP (args_left))
 	    {
-	      vals[argnum++] = Feval (Fcar (args_left));
+	      vals[argnum++] = eval_sub (Fcar (args_left));
 	      args_left = Fcdr (args_left);
 	      gcpro3.nvars = argnum;
 	    }
@@ -2331,7 +2458,7 @@ DEFUN ("eval", Feval, Seval, 1, 1, 0,
       maxargs = XSUBR (fun)->max_args;
       for (i = 0; i < maxargs; args_left = Fcdr (args_left))
 	{
-	  argvals[i] = Feval (Fcar (args_left));
+	  argvals[i] = eval_sub (Fcar (args_left));
 	  gcpro3.nvars = ++i;
 	}
 
@@ -2404,8 +2531,16 @@ DEFUN ("eval", Feval, Seval, 1, 1, 0,
 	  goto retry;
 	}
       if (EQ (funcar, Qmacro))
-	val = Feval (apply1 (Fcdr (fun), original_args));
-      else if (EQ (funcar, Qlambda))
+	val = eval_sub (apply1 (Fcdr (fun), original_args));
+      else if (EQ (funcar, Qlambda)
+	       && !NILP (Vinternal_interpreter_environment))
+	/* A lambda expression in function position closes over the
+	   current lexical environment like #'(lambda ...) would.  */
+	val = apply_lambda (Fcons (Qclosure,
+				   Fcons (Vinternal_interpreter_environment,
+					  XCDR (fun))),
+			    original_args, 1);
+      else if (EQ (funcar, Qlambda) || EQ (funcar, Qclosure))
 	val = apply_lambda (fun, original_args, 1);
       else
 	xsignal1 (Qinvalid_function, original_fun);
@@ -2637,7 +2772,8 @@ run_hook_with_args (nargs, args, cond)
 
   if (EQ (val, Qunbound) || NILP (val))
     return ret;
-  else if (!CONSP (val) || EQ (XCAR (val), Qlambda))
+  else if (!CONSP (val) || EQ (XCAR (val), Qlambda)
+	   || EQ (XCAR (val), Qclosure))
     {
       args[0] = val;
       return Ffuncall (nargs, args);
@@ -2960,12 +3096,12 @@ usage: (funcall FUNCTION &rest ARGUMENTS)  */)
     }
 
   backtrace.next = backtrace_list;
-  backtrace_list = &backtrace;
   backtrace.function = &args[0];
   backtrace.args = &args[1];
   backtrace.nargs = nargs - 1;
   backtrace.evalargs = 0;
   backtrace.debug_on_exit = 0;
+  backtrace_list = &backtrace;
 
   if (debug_on_next_call)
     do_debug_on_call (Qlambda);
@@ -3071,7 +3207,7 @@ usage: (funcall FUNCTION &rest ARGUMENTS)  */)
       funcar = XCAR (fun);
       if (!SYMBOLP (funcar))
 	xsignal1 (Qinvalid_function, original_fun);
-      if (EQ (funcar, Qlambda))
+      if (EQ (funcar, Qlambda) || EQ (funcar, Qclosure))
 	val = funcall_lambda (fun, numargs, args + 1);
       else if (EQ (funcar, Qautoload))
 	{
@@ -3113,7 +3249,7 @@ apply_lambda (fun, args, eval_flag)
   for (i = 0; i < XINT (numargs);)
     {
       tem = Fcar (args_left), args_left = Fcdr (args_left);
-      if (eval_flag) tem = Feval (tem);
+      if (eval_flag) tem = eval_sub (tem);
       arg_vector[i++] = tem;
       gcpro1.nvars = i;
     }
@@ -3136,6 +3272,86 @@ apply_lambda (fun, args, eval_flag)
   return tem;
 }
 
+/* Descriptors of the argument lists of byte-code functions, so that
+   funcall_lambda needn't parse the list on every call.  SYMS holds
+   the NREQUIRED mandatory and NOPTIONAL optional arguments, followed
+   by the &rest argument if REST is non-zero.  An entry describes FUN
+   as long as FUN's arglist is still ARGLIST and no garbage collection
+   has happened since GCS was recorded: the entries don't protect the
+   objects they refer to.  Functions with more arguments than fit in
+   SYMS, or with an unusual argument list, aren't cached.  */
+
+#define ARGLIST_CACHE_SIZE 512
+#define ARGLIST_CACHE_MAX_ARGS 8
+
+struct arglist_descriptor
+{
+  Lisp_Object fun, arglist;
+  EMACS_INT gcs;
+  short nrequired, noptional;
+  char rest;
+  Lisp_Object syms[ARGLIST_CACHE_MAX_ARGS];
+};
+
+static struct arglist_descriptor arglist_cache[ARGLIST_CACHE_SIZE];
+
+/* Return the descriptor of the argument list of FUN, a byte-code
+   function whose arglist is a list, or 0 if it can't be cached.  */
+
+static struct arglist_descriptor *
+arglist_descriptor (fun)
+     Lisp_Object fun;
+{
+  Lisp_Object arglist = AREF (fun, COMPILED_ARGLIST), tail, sym;
+  struct arglist_descriptor *d
+    = &arglist_cache[(EMACS_UINT) XHASH (fun) / sizeof (Lisp_Object)
+		     % ARGLIST_CACHE_SIZE];
+  int n = 0, optional = 0, rest = 0;
+
+  if (d->gcs == gcs_done && EQ (d->fun, fun) && EQ (d->arglist, arglist))
+    return d;
+
+  d->fun = Qnil;
+  d->nrequired = 0;
+  for (tail = arglist; CONSP (tail); tail = XCDR (tail))
+    {
+      sym = XCAR (tail);
+      if (!SYMBOLP (sym) || rest > 1 || n == ARGLIST_CACHE_MAX_ARGS)
+	return 0;
+      if (EQ (sym, Qand_rest))
+	{
+	  if (rest)
+	    return 0;
+	  rest = 1;
+	}
+      else if (EQ (sym, Qand_optional))
+	{
+	  if (optional || rest)
+	    return 0;
+	  optional = 1;
+	  d->nrequired = n;
+	}
+      else
+	{
+	  d->syms[n++] = sym;
+	  if (rest)
+	    rest = 2;
+	}
+    }
+  /* `&rest' must be followed by exactly one symbol.  */
+  if (!NILP (tail) || rest == 1)
+    return 0;
+
+  if (!optional)
+    d->nrequired = n - (rest != 0);
+  d->noptional = n - (rest != 0) - d->nrequired;
+  d->rest = rest != 0;
+  d->fun = fun;
+  d->arglist = arglist;
+  d->gcs = gcs_done;
+  return d;
+}
+
 /* Apply a Lisp function FUN to the NARGS evaluated arguments in ARG_VECTOR
    and return the result of evaluation.
    FUN must be either a lambda-expression or a compiled-code object.  */
@@ -3146,12 +3362,24 @@ funcall_lambda (fun, nargs, arg_vector)
      int nargs;
      register Lisp_Object *arg_vector;
 {
-  Lisp_Object val, syms_left, next;
+  Lisp_Object val, syms_left, next, lexenv;
   int count = SPECPDL_INDEX ();
   int i, optional, rest;
+  struct arglist_descriptor *d;
 
   if (CONSP (fun))
     {
+      if (EQ (XCAR (fun), Qclosure))
+	{
+	  /* Drop `closure' and the environment, so that FUN looks
+	     like a lambda expression below.  */
+	  fun = XCDR (fun);
+	  if (!CONSP (fun))
+	    xsignal1 (Qinvalid_function, fun);
+	  lexenv = XCAR (fun);
+	}
+      else
+	lexenv = Qnil;
       syms_left = XCDR (fun);
       if (CONSP (syms_left))
 	syms_left = XCAR (syms_left);
@@ -3159,7 +3387,29 @@ funcall_lambda (fun, nargs, arg_vector)
 	xsignal1 (Qinvalid_function, fun);
     }
   else if (COMPILEDP (fun))
-    syms_left = AREF (fun, COMPILED_ARGLIST);
+    {
+      syms_left = AREF (fun, COMPILED_ARGLIST);
+      lexenv = Qnil;
+
+      /* Bind the arguments from the cached descriptor if there is
+	 one, instead of parsing the arglist below.  */
+      d = arglist_descriptor (fun);
+      if (d)
+	{
+	  int nparams = d->nrequired + d->noptional;
+
+	  if (nargs < d->nrequired || (!d->rest && nargs > nparams))
+	    xsignal2 (Qwrong_number_of_arguments, fun, make_number (nargs));
+	  for (i = 0; i < nparams; i++)
+	    specbind (d->syms[i], i < nargs ? arg_vector[i] : Qnil);
+	  if (d->rest)
+	    specbind (d->syms[nparams],
+		      (nargs > nparams
+		       ? Flist (nargs - nparams, arg_vector + nparams)
+		       : Qnil));
+	  goto bound;
+	}
+    }
   else
     abort ();
 
@@ -3176,17 +3426,30 @@ funcall_lambda (fun, nargs, arg_vector)
 	rest = 1;
       else if (EQ (next, Qand_optional))
 	optional = 1;
-      else if (rest)
+      else
 	{
-	  specbind (next, Flist (nargs - i, &arg_vector[i]));
-	  i = nargs;
+	  Lisp_Object arg;
+
+	  if (rest)
+	    {
+	      arg = Flist (nargs - i, &arg_vector[i]);
+	      i = nargs;
+	    }
+	  else if (i < nargs)
+	    arg = arg_vector[i++];
+	  else if (!optional)
+	    xsignal2 (Qwrong_number_of_arguments, fun, make_number (nargs));
+	  else
+	    arg = Qnil;
+
+	  /* The arguments of a closure are bound lexically, unless
+	     they are special like the variables of `let'.  */
+	  if (!NILP (lexenv) && !XSYMBOL (next)->declared_special
+	      && NILP (Fmemq (next, lexenv)))
+	    lexenv = Fcons (Fcons (next, arg), lexenv);
+	  else
+	    specbind (next, arg);
 	}
-      else if (i < nargs)
-	specbind (next, arg_vector[i++]);
-      else if (!optional)
-	xsignal2 (Qwrong_number_of_arguments, fun, make_number (nargs));
-      else
-	specbind (next, Qnil);
     }
 
   if (!NILP (syms_left))
@@ -3194,6 +3457,13 @@ funcall_lambda (fun, nargs, arg_vector)
   else if (i < nargs)
     xsignal2 (Qwrong_number_of_arguments, fun, make_number (nargs));
 
+
+ bound:
+  /* The body of a lambda expression or compiled function is
+     dynamically scoped, that of a closure sees its environment.  */
+  if (!EQ (lexenv, Vinternal_interpreter_environment))
+    specbind (Qinternal_interpreter_environment, lexenv);
+
   if (CONSP (fun))
     val = Fprogn (XCDR (XCDR (fun)));
   else
@@ -3212,7 +3482,9 @@ funcall_lambda (fun, nargs, arg_vector)
 
 DEFUN ("fetch-bytecode", Ffetch_bytecode, Sfetch_bytecode,
        1, 1, 0,
-       doc: /* If byte-compiled OBJECT is lazy-loaded, fetch it now.  */)
+       doc: /* If byte-compiled OBJECT is lazy-loaded, fetch it now.
+OBJECT is lazy-loaded if it was compiled with `byte-compile-dynamic',
+or loaded while `load-lazy-functions' was non-nil.  */)
      (object)
      Lisp_Object object;
 {
@@ -3220,7 +3492,13 @@ DEFUN ("fetch-bytecode", Ffetch_bytecode, Sfetch_bytecode,
 
   if (COMPILEDP (object) && CONSP (AREF (object, COMPILED_BYTECODE)))
     {
-      tem = read_doc_string (AREF (object, COMPILED_BYTECODE));
+      /* `load' leaves (FILE POSITION . LENGTH) there, and the byte
+	 compiler (FILE . POSITION).  */
+      tem = AREF (object, COMPILED_BYTECODE);
+      if (CONSP (XCDR (tem)))
+	tem = read_lazy_function (tem);
+      else
+	tem = read_doc_string (tem);
       if (!CONSP (tem))
 	{
 	  tem = AREF (object, COMPILED_BYTECODE);
@@ -3271,6 +3549,7 @@ specbind (symbol, value)
       specpdl_ptr->symbol = symbol;
       specpdl_ptr->old_value = valcontents;
       specpdl_ptr->func = NULL;
+      specpdl_ptr->kind = SPECPDL_LET;
       ++specpdl_ptr;
       SET_SYMBOL_VALUE (symbol, value);
     }
@@ -3278,6 +3557,7 @@ specbind (symbol, value)
     {
       Lisp_Object ovalue = find_symbol_value (symbol);
       specpdl_ptr->func = 0;
+      specpdl_ptr->kind = SPECPDL_LET;
       specpdl_ptr->old_value = ovalue;
 
       valcontents = XSYMBOL (symbol)->value;
@@ -3303,6 +3583,7 @@ specbind (symbol, value)
 	     structure because this would mean we have to do more
 	     work for simple variables.  */
 	  specpdl_ptr->symbol = Fcons (symbol, Fcons (where, current_buffer));
+	  specpdl_ptr->kind = SPECPDL_LET_LOCAL;
 
 	  /* If SYMBOL is a per-buffer variable which doesn't have a
 	     buffer-local value here, make the `let' change the global
@@ -3342,19 +3623,56 @@ record_unwind_protect (function, arg)
   if (specpdl_ptr == specpdl + specpdl_size)
     grow_specpdl ();
   specpdl_ptr->func = function;
+  specpdl_ptr->kind = SPECPDL_UNWIND;
   specpdl_ptr->symbol = Qnil;
   specpdl_ptr->old_value = arg;
   specpdl_ptr++;
 }
 
+/* Save point, mark and the current buffer, like
+   record_unwind_protect (save_excursion_restore, save_excursion_save ()).
+   The markers and conses that record them are known to be referenced
+   only from the specpdl, so unbind_to frees them once it has restored
+   what they say.  */
+
+void
+record_unwind_save_excursion ()
+{
+  eassert (!handling_signal);
+
+  if (specpdl_ptr == specpdl + specpdl_size)
+    grow_specpdl ();
+  specpdl_ptr->func = save_excursion_restore;
+  specpdl_ptr->kind = SPECPDL_SAVE_EXCURSION;
+  specpdl_ptr->symbol = Qnil;
+  specpdl_ptr->old_value = save_excursion_save ();
+  specpdl_ptr++;
+}
+
 Lisp_Object
 unbind_to (count, value)
      int count;
      Lisp_Object value;
 {
-  Lisp_Object quitf = Vquit_flag;
+  Lisp_Object quitf;
   struct gcpro gcpro1, gcpro2;
 
+  /* Undo plain bindings of variables that still have trivial values
+     first.  That runs no Lisp code and cannot GC, so neither VALUE
+     nor the quit flag need protecting, and a `let' at the end of a
+     loop often leaves nothing else to do.  No need to check for
+     constant symbols here, since that was already done by specbind.  */
+  while (specpdl_ptr != specpdl + count
+	 && specpdl_ptr[-1].kind == SPECPDL_LET
+	 && !MISCP (SYMBOL_VALUE (specpdl_ptr[-1].symbol)))
+    {
+      --specpdl_ptr;
+      SET_SYMBOL_VALUE (specpdl_ptr->symbol, specpdl_ptr->old_value);
+    }
+  if (specpdl_ptr == specpdl + count)
+    return value;
+
+  quitf = Vquit_flag;
   GCPRO2 (value, quitf);
   Vquit_flag = Qnil;
 
@@ -3369,38 +3687,58 @@ unbind_to (count, value)
       struct specbinding this_binding;
       this_binding = *--specpdl_ptr;
 
-      if (this_binding.func != 0)
-	(*this_binding.func) (this_binding.old_value);
-      /* If the symbol is a list, it is really (SYMBOL WHERE
-	 . CURRENT-BUFFER) where WHERE is either nil, a buffer, or a
-	 frame.  If WHERE is a buffer or frame, this indicates we
-	 bound a variable that had a buffer-local or frame-local
-	 binding.  WHERE nil means that the variable had the default
-	 value when it was bound.  CURRENT-BUFFER is the buffer that
-         was current when the variable was bound.  */
-      else if (CONSP (this_binding.symbol))
+      switch (this_binding.kind)
 	{
-	  Lisp_Object symbol, where;
+	case SPECPDL_UNWIND:
+	  (*this_binding.func) (this_binding.old_value);
+	  break;
 
-	  symbol = XCAR (this_binding.symbol);
-	  where = XCAR (XCDR (this_binding.symbol));
+	case SPECPDL_SAVE_EXCURSION:
+	  {
+	    /* The hooks save_excursion_restore runs can GC; keep
+	       everything in INFO alive until it is freed here.  */
+	    Lisp_Object info;
+	    struct gcpro gcpro1;
+
+	    info = this_binding.old_value;
+	    GCPRO1 (info);
+	    save_excursion_restore (info);
+	    UNGCPRO;
+	    free_save_excursion (info);
+	  }
+	  break;
 
-	  if (NILP (where))
-	    Fset_default (symbol, this_binding.old_value);
-	  else if (BUFFERP (where))
-	    set_internal (symbol, this_binding.old_value, XBUFFER (where), 1);
-	  else
-	    set_internal (symbol, this_binding.old_value, NULL, 1);
-	}
-      else
-	{
+	case SPECPDL_LET_LOCAL:
+	  /* The symbol is really (SYMBOL WHERE . CURRENT-BUFFER)
+	     where WHERE is either nil, a buffer, or a frame.  If
+	     WHERE is a buffer or frame, this indicates we bound a
+	     variable that had a buffer-local or frame-local binding.
+	     WHERE nil means that the variable had the default value
+	     when it was bound.  CURRENT-BUFFER is the buffer that was
+	     current when the variable was bound.  */
+	  {
+	    Lisp_Object symbol, where;
+
+	    symbol = XCAR (this_binding.symbol);
+	    where = XCAR (XCDR (this_binding.symbol));
+
+	    if (NILP (where))
+	      Fset_default (symbol, this_binding.old_value);
+	    else if (BUFFERP (where))
+	      set_internal (symbol, this_binding.old_value, XBUFFER (where), 1);
+	    else
+	      set_internal (symbol, this_binding.old_value, NULL, 1);
+	  }
+	  break;
+
+	case SPECPDL_LET:
 	  /* If variable has a trivial value (no forwarding), we can
-	     just set it.  No need to check for constant symbols here,
-	     since that was already done by specbind.  */
+	     just set it.  */
 	  if (!MISCP (SYMBOL_VALUE (this_binding.symbol)))
 	    SET_SYMBOL_VALUE (this_binding.symbol, this_binding.old_value);
 	  else
 	    set_internal (this_binding.symbol, this_binding.old_value, 0, 1);
+	  break;
 	}
     }
 
@@ -3410,7 +3748,7 @@ unbind_to (count, value)
   UNGCPRO;
   return value;
 }
-
+
 DEFUN ("backtrace-debug", Fbacktrace_debug, Sbacktrace_debug, 2, 2, 0,
        doc: /* Set the debug-on-exit flag of eval frame LEVEL levels down to FLAG.
 The debugger is entered when that frame exits, if the flag is non-nil.  */)
@@ -3624,6 +3962,13 @@ before making `inhibit-quit' nil.  */);
   Qdebug = intern ("debug");
   staticpro (&Qdebug);
 
+  Qclosure = intern ("closure");
+  staticpro (&Qclosure);
+
+  Qinternal_interpreter_environment
+    = intern ("internal-interpreter-environment");
+  staticpro (&Qinternal_interpreter_environment);
+
   DEFVAR_LISP ("stack-trace-on-error", &Vstack_trace_on_error,
 	       doc: /* *Non-nil means errors display a backtrace buffer.
 More precisely, this happens for any error that is handled
@@ -3696,6 +4041,16 @@ DECL is a list `(declare ...)' containing the declarations.
 The value the function returns is not used.  */);
   Vmacro_declaration_function = Qnil;
 
+  DEFVAR_LISP ("internal-interpreter-environment",
+	       &Vinternal_interpreter_environment,
+	       doc: /* If non-nil, the current lexical environment of the Lisp interpreter.
+When lexical binding is not being used, this variable is nil.
+A value of `(t)' indicates an empty environment, otherwise it is an
+alist of active lexical bindings.  This is an internal variable; use
+the `lexical-binding' variable and the LEXICAL argument of `eval'
+to control scoping.  */);
+  Vinternal_interpreter_environment = Qnil;
+
   Vrun_hooks = intern ("run-hooks");
   staticpro (&Vrun_hooks);
 
@@ -3719,6 +4074,7 @@ The value the function returns is not used.  */);
   defsubr (&Sdefvar);
   defsubr (&Sdefvaralias);
   defsubr (&Sdefconst);
+  defsubr (&Sspecial_variable_p);
   defsubr (&Suser_variable_p);
   defsubr (&Slet);
   defsubr (&SletX);
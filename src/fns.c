@@ -4387,32 +4387,329 @@ sweep_weak_table (h, remove_entries_p)
   return marked;
 }
 
-/* Remove elements from weak hash tables that don't survive the
-   current garbage collection.  Remove weak tables that don't survive
-   from Vweak_hash_tables.  Called from gc_sweep.  */
+/* Marking the keys and values of weak hash tables that are in use
+   must go on until there is no more change.  This is necessary for
+   cases like value-weak table A containing an entry X -> Y, where Y
+   is used in a key-weak table B, Z -> Y.  If B comes after A in the
+   list of weak tables, X -> Y might be removed from A, although when
+   looking at B one finds that it shouldn't.
+
+   Rescanning all weak tables until nothing changes takes time
+   quadratic in the number of entries when entries depend on each
+   other in long chains.  Instead, an entry whose fate depends on an
+   object that isn't marked yet is recorded as waiting for that
+   object, and so is a weak table that isn't marked yet.  mark_object
+   calls weak_hash_object_marked for each object it marks while there
+   are waiters, which moves the waiters for that object to a list of
+   waiters that are ready to be looked at again.  This way, each
+   entry is looked at a bounded number of times.  */
+
+struct weak_waiter
+{
+  /* The weak table, and the index of the entry in it, or -1 if the
+     table itself waits for being marked.  */
+  struct Lisp_Hash_Table *h;
+  int i;
+
+  /* Index of the next waiter for the same object, or -1.  */
+  int next;
+};
+
+/* All waiters recorded in this GC.  */
+
+static struct weak_waiter *weak_waiters;
+static int weak_waiters_used, weak_waiters_size;
+
+/* Open hash table mapping objects waited for to the index of their
+   first waiter in weak_waiters.  A head of -1 means the object has
+   been marked, -2 means the slot is unused.  WEAK_WAIT_SIZE is a
+   power of 2.  */
+
+static Lisp_Object *weak_wait_objects;
+static int *weak_wait_heads;
+static int weak_wait_size, weak_wait_count;
+
+/* Stack of indices of waiters that are ready to be looked at.  */
+
+static int *weak_ready;
+static int weak_ready_used, weak_ready_size;
+
+/* Non-zero while there are waiters.  Checked by mark_object.  */
+
+int weak_hash_waiting;
+
+/* Value is the slot of OBJ in weak_wait_objects, or the free slot
+   where it belongs.  */
+
+static int
+weak_wait_slot (obj)
+     Lisp_Object obj;
+{
+  EMACS_UINT hash = (EMACS_UINT) XHASH (obj);
+  int mask = weak_wait_size - 1;
+  int slot = (hash ^ (hash >> 7) ^ (hash >> 17)) & mask;
+
+  while (weak_wait_heads[slot] != -2
+	 && !EQ (weak_wait_objects[slot], obj))
+    slot = (slot + 1) & mask;
+  return slot;
+}
+
+/* Make room in the hash table for one more object.  */
+
+static void
+weak_wait_grow ()
+{
+  Lisp_Object *old_objects = weak_wait_objects;
+  int *old_heads = weak_wait_heads;
+  int old_size = weak_wait_size;
+  int i, slot;
+
+  if (2 * (weak_wait_count + 1) <= weak_wait_size)
+    return;
+
+  weak_wait_size = max (64, 2 * weak_wait_size);
+  weak_wait_objects
+    = (Lisp_Object *) xmalloc (weak_wait_size * sizeof *weak_wait_objects);
+  weak_wait_heads = (int *) xmalloc (weak_wait_size * sizeof *weak_wait_heads);
+  for (i = 0; i < weak_wait_size; i++)
+    weak_wait_heads[i] = -2;
+
+  for (i = 0; i < old_size; i++)
+    if (old_heads[i] != -2)
+      {
+	slot = weak_wait_slot (old_objects[i]);
+	weak_wait_objects[slot] = old_objects[i];
+	weak_wait_heads[slot] = old_heads[i];
+      }
+
+  if (old_size)
+    {
+      xfree (old_objects);
+      xfree (old_heads);
+    }
+}
+
+/* Record that entry I of weak table H, or H itself if I is -1,
+   waits for OBJ to be marked.  */
+
+static void
+weak_wait (obj, h, i)
+     Lisp_Object obj;
+     struct Lisp_Hash_Table *h;
+     int i;
+{
+  int slot;
+
+  if (weak_waiters_used == weak_waiters_size)
+    {
+      weak_waiters_size = max (256, 2 * weak_waiters_size);
+      weak_waiters = (struct weak_waiter *)
+	xrealloc (weak_waiters, weak_waiters_size * sizeof *weak_waiters);
+    }
+
+  weak_wait_grow ();
+  slot = weak_wait_slot (obj);
+  if (weak_wait_heads[slot] == -2)
+    {
+      weak_wait_objects[slot] = obj;
+      weak_wait_heads[slot] = -1;
+      weak_wait_count++;
+    }
+
+  weak_waiters[weak_waiters_used].h = h;
+  weak_waiters[weak_waiters_used].i = i;
+  weak_waiters[weak_waiters_used].next = weak_wait_heads[slot];
+  weak_wait_heads[slot] = weak_waiters_used++;
+  weak_hash_waiting = 1;
+}
+
+/* Put waiter W on the stack of ready waiters.  */
+
+static void
+weak_make_ready (w)
+     int w;
+{
+  if (weak_ready_used == weak_ready_size)
+    {
+      weak_ready_size = max (256, 2 * weak_ready_size);
+      weak_ready = (int *) xrealloc (weak_ready,
+				     weak_ready_size * sizeof *weak_ready);
+    }
+  weak_ready[weak_ready_used++] = w;
+}
+
+/* Called from mark_object when it is about to mark OBJ.  Make the
+   waiters for OBJ ready.  */
 
 void
-sweep_weak_hash_tables ()
+weak_hash_object_marked (obj)
+     Lisp_Object obj;
 {
-  struct Lisp_Hash_Table *h, *used, *next;
-  int marked;
-
-  /* Mark all keys and values that are in use.  Keep on marking until
-     there is no more change.  This is necessary for cases like
-     value-weak table A containing an entry X -> Y, where Y is used in a
-     key-weak table B, Z -> Y.  If B comes after A in the list of weak
-     tables, X -> Y might be removed from A, although when looking at B
-     one finds that it shouldn't.  */
+  int slot = weak_wait_slot (obj);
+  int w;
+
+  if (weak_wait_heads[slot] >= 0)
+    {
+      for (w = weak_wait_heads[slot]; w >= 0; w = weak_waiters[w].next)
+	weak_make_ready (w);
+      weak_wait_heads[slot] = -1;
+    }
+}
+
+/* Look at entry I of the marked weak table H.  If the entry survives
+   the current GC, mark its key and value.  If that depends on
+   objects not marked yet, wait for them.  */
+
+static void
+weak_entry_mark (h, i)
+     struct Lisp_Hash_Table *h;
+     int i;
+{
+  Lisp_Object key = HASH_KEY (h, i), value = HASH_VALUE (h, i);
+  int key_known_to_survive_p = survives_gc_p (key);
+  int value_known_to_survive_p = survives_gc_p (value);
+
+  if (EQ (h->weak, Qkey))
+    {
+      if (!key_known_to_survive_p)
+	weak_wait (key, h, i);
+      else if (!value_known_to_survive_p)
+	mark_object (value);
+    }
+  else if (EQ (h->weak, Qvalue))
+    {
+      if (!value_known_to_survive_p)
+	weak_wait (value, h, i);
+      else if (!key_known_to_survive_p)
+	mark_object (key);
+    }
+  else if (EQ (h->weak, Qkey_or_value))
+    {
+      if (!key_known_to_survive_p && !value_known_to_survive_p)
+	{
+	  weak_wait (key, h, i);
+	  weak_wait (value, h, i);
+	}
+      else if (!key_known_to_survive_p)
+	mark_object (key);
+      else if (!value_known_to_survive_p)
+	mark_object (value);
+    }
+  else if (EQ (h->weak, Qkey_and_value))
+    /* Such entries survive only if both key and value survive
+       anyway, so there is nothing to mark.  */
+    ;
+  else
+    abort ();
+}
+
+/* Look at all entries of the marked weak table H.  */
+
+static void
+weak_table_mark (h)
+     struct Lisp_Hash_Table *h;
+{
+  int i, n = ASIZE (h->next) & ~ARRAY_MARK_FLAG;
+
+  for (i = 0; i < n; ++i)
+    if (!NILP (HASH_HASH (h, i)))
+      weak_entry_mark (h, i);
+}
+
+/* Value is non-zero if waiter W can make progress now.  */
+
+static int
+weak_waiter_ready_p (w)
+     struct weak_waiter *w;
+{
+  struct Lisp_Hash_Table *h = w->h;
+
+  if (w->i < 0)
+    return (h->size & ARRAY_MARK_FLAG) != 0;
+  else if (EQ (h->weak, Qkey))
+    return survives_gc_p (HASH_KEY (h, w->i));
+  else if (EQ (h->weak, Qvalue))
+    return survives_gc_p (HASH_VALUE (h, w->i));
+  else
+    return (survives_gc_p (HASH_KEY (h, w->i))
+	    || survives_gc_p (HASH_VALUE (h, w->i)));
+}
+
+/* Mark all keys and values of weak hash tables that are in use.  */
+
+static void
+mark_weak_hash_tables ()
+{
+  struct Lisp_Hash_Table *h;
+  Lisp_Object table;
+  int w, n, i;
+
+  weak_waiters_used = weak_ready_used = 0;
+
+  for (h = weak_hash_tables; h; h = h->next_weak)
+    if (h->size & ARRAY_MARK_FLAG)
+      weak_table_mark (h);
+    else
+      {
+	XSET_HASH_TABLE (table, h);
+	weak_wait (table, h, -1);
+      }
+
   do
     {
-      marked = 0;
-      for (h = weak_hash_tables; h; h = h->next_weak)
+      while (weak_ready_used > 0)
 	{
-	  if (h->size & ARRAY_MARK_FLAG)
-	    marked |= sweep_weak_table (h, 0);
+	  struct weak_waiter *ww = &weak_waiters[weak_ready[--weak_ready_used]];
+
+	  if (ww->i < 0)
+	    weak_table_mark (ww->h);
+	  else
+	    weak_entry_mark (ww->h, ww->i);
 	}
+
+      /* Objects can be marked without mark_object seeing them, like
+	 the names of symbols.  Check that no waiter has been missed.  */
+      n = weak_waiters_used;
+      for (w = 0; w < n; w++)
+	if (weak_waiter_ready_p (&weak_waiters[w]))
+	  {
+	    struct Lisp_Hash_Table *wh = weak_waiters[w].h;
+	    Lisp_Object obj;
+
+	    if (weak_waiters[w].i < 0)
+	      XSET_HASH_TABLE (obj, wh);
+	    else if (EQ (wh->weak, Qvalue))
+	      obj = HASH_VALUE (wh, weak_waiters[w].i);
+	    else
+	      obj = HASH_KEY (wh, weak_waiters[w].i);
+	    weak_hash_object_marked (obj);
+	    if (EQ (wh->weak, Qkey_or_value))
+	      weak_hash_object_marked (HASH_VALUE (wh, weak_waiters[w].i));
+	  }
+    }
+  while (weak_ready_used > 0);
+
+  /* Forget the waiters.  */
+  weak_hash_waiting = 0;
+  if (weak_wait_count)
+    {
+      for (i = 0; i < weak_wait_size; i++)
+	weak_wait_heads[i] = -2;
+      weak_wait_count = 0;
     }
-  while (marked);
+}
+
+/* Remove elements from weak hash tables that don't survive the
+   current garbage collection.  Remove weak tables that don't survive
+   from Vweak_hash_tables.  Called from gc_sweep.  */
+
+void
+sweep_weak_hash_tables ()
+{
+  struct Lisp_Hash_Table *h, *used, *next;
+
+  mark_weak_hash_tables ();
 
   /* Remove tables and entries that aren't used.  */
   for (h = weak_hash_tables, used = NULL; h; h = next)
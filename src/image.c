@@ -886,7 +886,8 @@ parse_image_spec (spec, keywords, nkeywords, type)
 	  value = indirect_function (value);
 	  if (SUBRP (value)
 	      || COMPILEDP (value)
-	      || (CONSP (value) && EQ (XCAR (value), Qlambda)))
+	      || (CONSP (value) && (EQ (XCAR (value), Qlambda)
+				    || EQ (XCAR (value), Qclosure))))
 	    break;
 	  return 0;
 
@@ -316,6 +316,10 @@ static int last_non_minibuf_size;
 /* Number of idle seconds before an auto-save and garbage collection.  */
 static Lisp_Object Vauto_save_timeout;
 
+/* Number of seconds of idle time after which to collect garbage that
+   is due soon.  */
+static Lisp_Object Vgc_idle_delay;
+
 /* Total number of times read_char has returned.  */
 int num_input_events;
 
@@ -1364,7 +1368,7 @@ command_loop_2 ()
 Lisp_Object
 top_level_2 ()
 {
-  return Feval (Vtop_level);
+  return Feval (Vtop_level, Qnil);
 }
 
 Lisp_Object
@@ -1637,6 +1641,11 @@ command_loop_1 ()
       Vthis_original_command = Qnil;
       Vthis_command_keys_shift_translated = Qnil;
 
+      /* Unless the user is typing ahead, use the time before the next
+	 key sequence arrives to finish the work the last GC left.  */
+      if (!detect_input_pending ())
+	sweep_pending_conses ();
+
       /* Read next key sequence; i gets its length.  */
       i = read_key_sequence (keybuf, sizeof keybuf / sizeof keybuf[0],
 			     Qnil, 0, 1, 1);
@@ -2937,6 +2946,26 @@ read_char (commandflag, nmaps, maps, prev_event, used_mouse_menu, end_time)
       /* delay_level is 4 for files under around 50k, 7 at 100k,
 	 9 at 200k, 11 at 300k, and 12 at 500k.  It is 15 at 1 meg.  */
 
+      /* Garbage collect if that is due soon and Emacs has been idle
+	 for `gc-idle-delay' seconds.  */
+      if (commandflag != 0
+	  && NUMBERP (Vgc_idle_delay)
+	  && XFLOATINT (Vgc_idle_delay) > 0
+	  && gc_due_when_idle ())
+	{
+	  Lisp_Object tem0;
+
+	  save_getcjmp (save_jump);
+	  restore_getcjmp (local_getcjmp);
+	  tem0 = sit_for (Vgc_idle_delay, 1, 1);
+	  restore_getcjmp (save_jump);
+
+	  if (EQ (tem0, Qt)
+	      && ! CONSP (Vunread_command_events)
+	      && !detect_input_pending_run_timers (0))
+	    Fgarbage_collect ();
+	}
+
       /* Auto save if enough time goes by without input.  */
       if (commandflag != 0
 	  && num_nonmacro_input_events > last_auto_save
@@ -2960,7 +2989,7 @@ read_char (commandflag, nmaps, maps, prev_event, used_mouse_menu, end_time)
 		 available, garbage collect if there has been enough
 		 consing going on to make it worthwhile.  */
 	      if (!detect_input_pending_run_timers (0)
-		  && consing_since_gc > gc_cons_threshold / 2)
+		  && consing_since_gc > gc_threshold () / 2)
 		Fgarbage_collect ();
 
 	      redisplay ();
@@ -3398,7 +3427,7 @@ read_char (commandflag, nmaps, maps, prev_event, used_mouse_menu, end_time)
 		 help_form_saved_window_configs);
       record_unwind_protect (read_char_help_form_unwind, Qnil);
 
-      tem0 = Feval (Vhelp_form);
+      tem0 = Feval (Vhelp_form, Qnil);
       if (STRINGP (tem0))
 	internal_with_output_to_temp_buffer ("*Help*", print_help, tem0);
 
@@ -7857,7 +7886,8 @@ menu_item_eval_property (sexpr)
   int count = SPECPDL_INDEX ();
   Lisp_Object val;
   specbind (Qinhibit_redisplay, Qt);
-  val = internal_condition_case_1 (Feval, sexpr, Qerror,
+  specbind (Qinternal_interpreter_environment, Qnil);
+  val = internal_condition_case_1 (eval_sub, sexpr, Qerror,
 				   menu_item_eval_property_1);
   return unbind_to (count, val);
 }
@@ -12074,6 +12104,15 @@ After auto-saving due to this many seconds of idle time,
 Emacs also does a garbage collection if that seems to be warranted.  */);
   XSETFASTINT (Vauto_save_timeout, 30);
 
+  DEFVAR_LISP ("gc-idle-delay", &Vgc_idle_delay,
+	       doc: /* *Number of seconds idle time before collecting garbage that is due soon.
+When Emacs has waited this long for a command, it collects garbage if
+it has consed more than `gc-cons-idle-fraction' of what would trigger
+garbage collection.
+The value may be integer or floating point.
+Zero or nil means don't collect garbage due to idleness.  */);
+  XSETFASTINT (Vgc_idle_delay, 2);
+
   DEFVAR_LISP ("echo-keystrokes", &Vecho_keystrokes,
 	       doc: /* *Nonzero means echo unfinished commands after this many seconds of pause.
 The value may be integer or floating point.  */);
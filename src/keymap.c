@@ -817,9 +817,10 @@ get_keyelt (object, autoload)
 	/* This is really the value.  */
 	return object;
 
-      /* If the keymap contents looks like (keymap ...) or (lambda ...)
-	 then use itself. */
-      else if (EQ (XCAR (object), Qkeymap) || EQ (XCAR (object), Qlambda))
+      /* If the keymap contents looks like (keymap ...), (lambda ...)
+	 or (closure ...) then use itself. */
+      else if (EQ (XCAR (object), Qkeymap) || EQ (XCAR (object), Qlambda)
+	       || EQ (XCAR (object), Qclosure))
 	return object;
 
       /* If the keymap contents looks like (menu-item name . DEFN)
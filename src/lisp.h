@@ -959,6 +959,10 @@ struct Lisp_Symbol
      enum symbol_interned.  */
   unsigned interned : 2;
 
+  /* Non-zero means that this variable has been explicitly declared
+     special (with `defvar' etc), and shouldn't be lexically bound.  */
+  unsigned declared_special : 1;
+
   /* The symbol's name, as a Lisp string.
 
      The name "xname" is used to intentionally break code referring to
@@ -1783,27 +1787,42 @@ extern void defvar_kboard P_ ((char *, int));
    code to be executed for Lisp unwind-protect forms, and stores the C
    functions to be called for record_unwind_protect.
 
-   If func is non-zero, undoing this binding applies func to old_value;
+   The kind field says what an element is, so that unbind_to can
+   undo each kind directly:
+
+   SPECPDL_UNWIND: undoing it applies func to old_value.
       This implements record_unwind_protect.
 
-   Otherwise, the element is a variable binding.
+   SPECPDL_SAVE_EXCURSION: old_value was made by save_excursion_save,
+      and is passed to save_excursion_restore.  func is that function.
+      This implements record_unwind_save_excursion.
 
-   If the symbol field is a symbol, it is an ordinary variable binding.
+   SPECPDL_LET: an ordinary variable binding of the symbol field.
 
-   Otherwise, it should be a structure (SYMBOL WHERE
+   SPECPDL_LET_LOCAL: the symbol field is a structure (SYMBOL WHERE
    . CURRENT-BUFFER), which means having bound a local value while
    CURRENT-BUFFER was active.  If WHERE is nil this means we saw the
    default value when binding SYMBOL.  WHERE being a buffer or frame
    means we saw a buffer-local or frame-local value.  Other values of
-   WHERE mean an internal error.  */
+   WHERE mean an internal error.
+
+   func is null for variable bindings.  */
 
 typedef Lisp_Object (*specbinding_func) P_ ((Lisp_Object));
 
+enum specbind_tag
+  {
+    SPECPDL_UNWIND,
+    SPECPDL_SAVE_EXCURSION,
+    SPECPDL_LET,
+    SPECPDL_LET_LOCAL
+  };
+
 struct specbinding
   {
     Lisp_Object symbol, old_value;
     specbinding_func func;
-    Lisp_Object unused;		/* Dividing by 16 is faster than by 12 */
+    enum specbind_tag kind;	/* Also pads the struct to a power of 2.  */
   };
 
 extern struct specbinding *specpdl;
@@ -1875,6 +1894,22 @@ struct catchtag
 };
 
 extern struct catchtag *catchlist;
+
+/* An element of the stack of Lisp function calls, backtrace_list.  */
+
+struct backtrace
+{
+  struct backtrace *next;
+  Lisp_Object *function;
+  Lisp_Object *args;	/* Points to vector of args. */
+  int nargs;		/* Length of vector.
+			   If nargs is UNEVALLED, args points to slot holding
+			   list of unevalled args */
+  char evalargs;
+  /* Nonzero means call value of debugger when done with this operation. */
+  char debug_on_exit;
+};
+
 extern struct backtrace *backtrace_list;
 
 extern Lisp_Object memory_signal_data;
@@ -2394,6 +2429,8 @@ extern int use_dialog_box;
 extern int next_almost_prime P_ ((int));
 extern Lisp_Object larger_vector P_ ((Lisp_Object, int, Lisp_Object));
 extern void sweep_weak_hash_tables P_ ((void));
+extern int weak_hash_waiting;
+extern void weak_hash_object_marked P_ ((Lisp_Object));
 extern Lisp_Object Qstring_lessp;
 extern Lisp_Object Vfeatures;
 extern Lisp_Object QCtest, QCweakness, Qequal, Qeq;
@@ -2626,9 +2663,15 @@ extern void malloc_warning P_ ((char *));
 extern void memory_full P_ ((void)) NO_RETURN;
 extern void buffer_memory_full P_ ((void)) NO_RETURN;
 extern int survives_gc_p P_ ((Lisp_Object));
+extern void sweep_pending_conses P_ ((void));
+extern EMACS_INT gc_threshold P_ ((void));
+extern int gc_due_when_idle P_ ((void));
+extern EMACS_INT gcs_done;
 extern void mark_object P_ ((Lisp_Object));
 extern Lisp_Object Vpurify_flag;
 extern Lisp_Object Vmemory_full;
+extern Lisp_Object *staticvec[];
+extern int staticidx;
 EXFUN (Fcons, 2);
 EXFUN (list1, 1);
 EXFUN (list2, 2);
@@ -2751,6 +2794,7 @@ EXFUN (Fread_event, 3);
 extern Lisp_Object read_filtered_event P_ ((int, int, int, int, Lisp_Object));
 EXFUN (Feval_region, 4);
 extern Lisp_Object check_obarray P_ ((Lisp_Object));
+extern Lisp_Object read_lazy_function P_ ((Lisp_Object));
 extern Lisp_Object intern P_ ((const char *));
 extern Lisp_Object make_symbol P_ ((char *));
 extern Lisp_Object oblookup P_ ((Lisp_Object, const char *, int, int));
@@ -2770,9 +2814,12 @@ extern void init_lread P_ ((void));
 extern void syms_of_lread P_ ((void));
 
 /* Defined in eval.c */
+extern Lisp_Object Qand_rest, Qand_optional;
 extern Lisp_Object Qautoload, Qexit, Qinteractive, Qcommandp, Qdefun, Qmacro;
 extern Lisp_Object Vinhibit_quit, Qinhibit_quit, Vquit_flag;
 extern Lisp_Object Vautoload_queue;
+extern Lisp_Object Vinternal_interpreter_environment;
+extern Lisp_Object Qinternal_interpreter_environment, Qclosure;
 extern Lisp_Object Vdebug_on_error;
 extern Lisp_Object Vsignaling_function;
 extern int handling_signal;
@@ -2819,7 +2866,8 @@ extern void xsignal3 P_ ((Lisp_Object, Lisp_Object, Lisp_Object, Lisp_Object)) N
 extern void signal_error P_ ((char *, Lisp_Object)) NO_RETURN;
 EXFUN (Fautoload, 5);
 EXFUN (Fcommandp, 2);
-EXFUN (Feval, 1);
+EXFUN (Feval, 2);
+extern Lisp_Object eval_sub P_ ((Lisp_Object));
 EXFUN (Fapply, MANY);
 EXFUN (Ffuncall, MANY);
 EXFUN (Fbacktrace, 0);
@@ -2840,6 +2888,7 @@ extern Lisp_Object internal_condition_case_1 P_ ((Lisp_Object (*) (Lisp_Object),
 extern Lisp_Object internal_condition_case_2 P_ ((Lisp_Object (*) (int, Lisp_Object *), int, Lisp_Object *, Lisp_Object, Lisp_Object (*) (Lisp_Object)));
 extern void specbind P_ ((Lisp_Object, Lisp_Object));
 extern void record_unwind_protect P_ ((Lisp_Object (*) (Lisp_Object), Lisp_Object));
+extern void record_unwind_save_excursion P_ ((void));
 extern Lisp_Object unbind_to P_ ((int, Lisp_Object));
 extern void error P_ ((/* char *, ... */)) NO_RETURN;
 extern void do_autoload P_ ((Lisp_Object, Lisp_Object));
@@ -2886,6 +2935,7 @@ EXFUN (Fbuffer_string, 0);
 extern Lisp_Object save_excursion_save P_ ((void));
 extern Lisp_Object save_restriction_save P_ ((void));
 extern Lisp_Object save_excursion_restore P_ ((Lisp_Object));
+extern void free_save_excursion P_ ((Lisp_Object));
 extern Lisp_Object save_restriction_restore P_ ((Lisp_Object));
 EXFUN (Fchar_to_string, 1);
 EXFUN (Fdelete_region, 2);
@@ -3228,7 +3278,7 @@ extern void setup_process_coding_systems P_ ((Lisp_Object));
 /* defined in callproc.c */
 extern Lisp_Object Vexec_path, Vexec_suffixes,
                    Vexec_directory, Vdata_directory;
-extern Lisp_Object Vdoc_directory;
+extern Lisp_Object Vdoc_directory, Vprocess_environment;
 EXFUN (Fcall_process, MANY);
 extern int child_setup P_ ((int, int, int, char **, int, Lisp_Object));
 extern void init_callproc_1 P_ ((void));
@@ -3241,6 +3291,7 @@ extern Lisp_Object Vdoc_file_name;
 EXFUN (Fsubstitute_command_keys, 1);
 EXFUN (Fdocumentation, 2);
 EXFUN (Fdocumentation_property, 3);
+EXFUN (Fsnarf_documentation, 1);
 extern Lisp_Object read_doc_string P_ ((Lisp_Object));
 extern Lisp_Object get_doc_string P_ ((Lisp_Object, int, int));
 extern void syms_of_doc P_ ((void));
@@ -3249,11 +3300,49 @@ extern int read_bytecode_char P_ ((int));
 /* defined in bytecode.c */
 extern Lisp_Object Qbytecode;
 EXFUN (Fbyte_code, 3);
+extern Lisp_Object exec_byte_code P_ ((Lisp_Object, Lisp_Object,
+				       Lisp_Object));
+extern Lisp_Object eval_byte_code_body P_ ((Lisp_Object));
 extern void syms_of_bytecode P_ ((void));
 extern struct byte_stack *byte_stack_list;
 extern void mark_byte_stack P_ ((void));
 extern void unmark_byte_stack P_ ((void));
 
+/* defined in profiler.c */
+extern Lisp_Object Qautomatic_gc;
+EXFUN (Fprofiler_cpu_start, 1);
+EXFUN (Fprofiler_cpu_stop, 0);
+EXFUN (Fprofiler_cpu_log, 0);
+EXFUN (Fprofiler_memory_start, 1);
+EXFUN (Fprofiler_memory_stop, 0);
+EXFUN (Fprofiler_memory_log, 0);
+extern int profiler_memory_running;
+extern void malloc_probe P_ ((size_t));
+extern void mark_profiler P_ ((void));
+extern void syms_of_profiler P_ ((void));
+
+/* defined in native.c */
+extern Lisp_Object Vload_native_code, native_code_pending;
+extern int native_code_loaded;
+EXFUN (Fnative_code_function_p, 1);
+extern void native_load_file P_ ((Lisp_Object));
+extern void native_attach P_ ((Lisp_Object));
+extern void syms_of_native P_ ((void));
+
+/* defined in pdump.c */
+extern Lisp_Object Vportable_dump_file_name;
+EXFUN (Fdump_emacs_portable, 1);
+extern void pdump_remember_scalar P_ ((void *, int));
+extern void pdump_add_hooks P_ ((void (*) P_ ((void)), void (*) P_ ((void))));
+extern void pdump_write_data P_ ((void *, int));
+extern void pdump_write_object P_ ((Lisp_Object));
+extern void pdump_read_data P_ ((void *, int));
+extern int pdump_read_object P_ ((Lisp_Object *));
+extern char *pdump_load P_ ((char *));
+extern void pdump_after_load P_ ((void));
+extern Lisp_Object pdump_default_file P_ ((void));
+extern void syms_of_pdump P_ ((void));
+
 /* defined in macros.c */
 extern Lisp_Object Qexecute_kbd_macro;
 EXFUN (Fexecute_kbd_macro, 3);
@@ -68,12 +68,18 @@ along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
 #define O_RDONLY 0
 #endif
 
+/* openp keeps the listings of the directories it searches where file
+   names are case-sensitive and directories are read with dirent.h.  */
+#if defined (SYSV_SYSTEM_DIR) && !defined (DOS_NT) && !defined (DARWIN_OS)
+#define LOAD_DIRECTORY_CACHE
+#include <dirent.h>
+#include <time.h>
+#endif
+
 #ifdef HAVE_FSEEKO
 #define file_offset off_t
-#define file_tell ftello
 #else
 #define file_offset long
-#define file_tell ftell
 #endif
 
 #ifndef USE_CRT_DLL
@@ -134,6 +140,9 @@ Lisp_Object Vload_file_name;
 /* Function to use for reading, in `load' and friends.  */
 Lisp_Object Vload_read_function;
 
+/* Non-nil means code being loaded or evaluated uses lexical binding.  */
+Lisp_Object Vlexical_binding, Qlexical_binding;
+
 /* Non-nil means read recursive structures using #n= and #n# syntax.  */
 Lisp_Object Vread_circle;
 
@@ -146,6 +155,25 @@ Lisp_Object read_objects;
 /* Nonzero means load should forcibly load all dynamic doc strings.  */
 static int load_force_doc_strings;
 
+/* Nonzero means openp may look for files in the listings of their
+   directories.  */
+static int load_cache_directories;
+
+/* Nonzero means load should leave the byte-code strings and constants
+   vectors of the functions it defines in the file until they are
+   called.  */
+static int load_lazy_functions;
+
+/* Nonzero while reading a top-level `defalias' form from a file being
+   loaded, until the first byte-code object in it.  */
+static int read_lazy_defalias;
+
+/* Nonzero while reading a top-level form that starts with a #@ doc
+   string from a file being loaded, until the doc string is skipped.
+   The byte compiler puts the doc string of a function before the
+   `defalias' that defines it.  */
+static int read_lazy_docstring;
+
 /* Nonzero means read should convert strings to unibyte.  */
 static int load_convert_to_unibyte;
 
@@ -171,8 +199,25 @@ Lisp_Object Vread_symbol_positions_list;
 /* List of descriptors now open for Fload.  */
 static Lisp_Object load_descriptor_list;
 
-/* File for get_file_char to read from.  Use by load.  */
-static FILE *instream;
+/* The contents of a file being loaded.  `load' reads the whole file
+   into memory at once, so that the reader can take its bytes from
+   there without going through stdio, and blocking input, for each
+   one.  */
+
+struct load_input
+{
+  /* The stream the file was read from, closed when the load ends.  */
+  FILE *stream;
+
+  /* The contents, the next byte to read, and the end.  */
+  unsigned char *start, *pos, *end;
+
+  /* The input of the enclosing load, if any.  */
+  struct load_input *prev;
+};
+
+/* Input for get_file_char to read from.  Used by load.  */
+static struct load_input *instream;
 
 /* When nonzero, read conses in pure space */
 static int read_pure;
@@ -233,10 +278,13 @@ static Lisp_Object Vbytecomp_version_regexp;
 static int read_emacs_mule_char P_ ((int, int (*) (int, Lisp_Object),
 				     Lisp_Object));
 
-static void readevalloop P_ ((Lisp_Object, FILE*, Lisp_Object,
+static void readevalloop P_ ((Lisp_Object, struct load_input *, Lisp_Object,
 			      Lisp_Object (*) (), int,
 			      Lisp_Object, Lisp_Object,
 			      Lisp_Object, Lisp_Object));
+static void read_load_input P_ ((struct load_input *, Lisp_Object));
+static Lisp_Object read_lazy_byte_code P_ ((Lisp_Object));
+static unsigned char *skip_white_space P_ ((unsigned char *, unsigned char *));
 static Lisp_Object load_unwind P_ ((Lisp_Object));
 static Lisp_Object load_descriptor_unwind P_ ((Lisp_Object));
 
@@ -499,11 +547,7 @@ unreadchar (readcharfun, c)
 	   || EQ (readcharfun, Qget_emacs_mule_file_char))
     {
       if (load_each_byte)
-	{
-	  BLOCK_INPUT;
-	  ungetc (c, instream);
-	  UNBLOCK_INPUT;
-	}
+	instream->pos--;
       else
 	unread_char = c;
     }
@@ -527,30 +571,13 @@ readbyte_from_file (c, readcharfun)
 {
   if (c >= 0)
     {
-      BLOCK_INPUT;
-      ungetc (c, instream);
-      UNBLOCK_INPUT;
+      instream->pos--;
       return 0;
     }
 
-  BLOCK_INPUT;
-  c = getc (instream);
-
-#ifdef EINTR
-  /* Interrupted reads have been observed while reading over the network */
-  while (c == EOF && ferror (instream) && errno == EINTR)
-    {
-      UNBLOCK_INPUT;
-      QUIT;
-      BLOCK_INPUT;
-      clearerr (instream);
-      c = getc (instream);
-    }
-#endif
-
-  UNBLOCK_INPUT;
-
-  return (c == EOF ? -1 : c);
+  if (instream->pos >= instream->end)
+    return -1;
+  return *instream->pos++;
 }
 
 static int
@@ -866,11 +893,9 @@ DEFUN ("get-file-char", Fget_file_char, Sget_file_char, 0, 0, 0,
        doc: /* Don't use this yourself.  */)
      ()
 {
-  register Lisp_Object val;
-  BLOCK_INPUT;
-  XSETINT (val, getc (instream));
-  UNBLOCK_INPUT;
-  return val;
+  if (!instream || instream->pos >= instream->end)
+    return make_number (-1);
+  return make_number (*instream->pos++);
 }
 
 
@@ -971,6 +996,46 @@ This uses the variables `load-suffixes' and `load-file-rep-suffixes'.  */)
   return Fnreverse (lst);
 }
 
+/* Return non-zero if the first line of the text READCHARFUN reads
+   from is a comment whose `-*-' section sets `lexical-binding' to
+   something other than nil.  Consume the first line if it is a
+   comment; otherwise unread its first character.  */
+
+static int
+lisp_file_lexically_bound_p (readcharfun)
+     Lisp_Object readcharfun;
+{
+  char line[256];
+  char *beg, *end, *p;
+  int c, n = 0;
+
+  c = READCHAR;
+  if (c != ';')
+    {
+      UNREAD (c);
+      return 0;
+    }
+  while ((c = READCHAR) != '\n' && c != -1)
+    if (n < sizeof line - 1)
+      line[n++] = c;
+  line[n] = '\0';
+
+  beg = strstr (line, "-*-");
+  if (!beg || !(end = strstr (beg + 3, "-*-")))
+    return 0;
+  *end = '\0';
+  for (p = beg + 3; (p = strstr (p, "lexical-binding:")); p++)
+    if (p == beg + 3 || p[-1] == ' ' || p[-1] == '\t' || p[-1] == ';')
+      break;
+  if (!p)
+    return 0;
+  p += sizeof "lexical-binding:" - 1;
+  while (*p == ' ' || *p == '\t')
+    p++;
+  return !(strncmp (p, "nil", 3) == 0
+	   && (p[3] == '\0' || p[3] == ' ' || p[3] == '\t' || p[3] == ';'));
+}
+
 DEFUN ("load", Fload, Sload, 1, 5, 0,
        doc: /* Execute a file of Lisp code named FILE.
 First try FILE with `.elc' appended, then try with `.el',
@@ -1012,6 +1077,7 @@ Return t if the file exists and loads successfully.  */)
      Lisp_Object file, noerror, nomessage, nosuffix, must_suffix;
 {
   register FILE *stream;
+  struct load_input input;
   register int fd = -1;
   int count = SPECPDL_INDEX ();
   struct gcpro gcpro1, gcpro2, gcpro3;
@@ -1258,7 +1324,11 @@ Return t if the file exists and loads successfully.  */)
 	message_with_string ("Loading %s...", file, 1);
     }
 
-  record_unwind_protect (load_unwind, make_save_value (stream, 0));
+  input.stream = stream;
+  input.start = input.pos = input.end = NULL;
+  input.prev = instream;
+  record_unwind_protect (load_unwind, make_save_value (&input, 0));
+  read_load_input (&input, found);
   record_unwind_protect (load_descriptor_unwind, load_descriptor_list);
   specbind (Qload_file_name, found);
   specbind (Qinhibit_file_name_operation, Qnil);
@@ -1266,15 +1336,23 @@ Return t if the file exists and loads successfully.  */)
     = Fcons (make_number (fileno (stream)), load_descriptor_list);
   specbind (Qload_in_progress, Qt);
   if (! version || version >= 22)
-    readevalloop (Qget_file_char, stream, hist_file_name,
-		  Feval, 0, Qnil, Qnil, Qnil, Qnil);
+    {
+      instream = &input;
+      if (compiled)
+	native_load_file (found);
+      specbind (Qlexical_binding,
+		lisp_file_lexically_bound_p (Qget_file_char) ? Qt : Qnil);
+      readevalloop (Qget_file_char, &input, hist_file_name,
+		    eval_sub, 0, Qnil, Qnil, Qnil, Qnil);
+    }
   else
     {
       /* We can't handle a file which was compiled with
 	 byte-compile-dynamic by older version of Emacs.  */
       specbind (Qload_force_doc_strings, Qt);
-      readevalloop (Qget_emacs_mule_file_char, stream, hist_file_name, Feval,
-		    0, Qnil, Qnil, Qnil, Qnil);
+      specbind (Qlexical_binding, Qnil);
+      readevalloop (Qget_emacs_mule_file_char, &input, hist_file_name,
+		    eval_sub, 0, Qnil, Qnil, Qnil, Qnil);
     }
   unbind_to (count, Qnil);
 
@@ -1309,17 +1387,67 @@ Return t if the file exists and loads successfully.  */)
   return Qt;
 }
 
+/* Read the whole stream of INPUT into memory.  FILE is the name of the
+   file, for error messages.  */
+
+static void
+read_load_input (input, file)
+     struct load_input *input;
+     Lisp_Object file;
+{
+  struct stat st;
+  size_t size, length = 0, n;
+
+  /* One more byte than the file has lets the first fread see EOF.  */
+  if (fstat (fileno (input->stream), &st) == 0 && st.st_size > 0)
+    size = st.st_size + 1;
+  else
+    size = 16 * 1024;
+  input->start = (unsigned char *) xmalloc (size);
+
+  while (1)
+    {
+      BLOCK_INPUT;
+      n = fread (input->start + length, 1, size - length, input->stream);
+      UNBLOCK_INPUT;
+      length += n;
+      if (length < size)
+	{
+	  if (!ferror (input->stream))
+	    break;
+#ifdef EINTR
+	  /* Interrupted reads have been observed while reading over
+	     the network.  */
+	  if (errno == EINTR)
+	    {
+	      clearerr (input->stream);
+	      QUIT;
+	      continue;
+	    }
+#endif
+	  report_file_error ("Read error", Fcons (file, Qnil));
+	}
+      size *= 2;
+      input->start = (unsigned char *) xrealloc (input->start, size);
+    }
+
+  input->pos = input->start;
+  input->end = input->start + length;
+}
+
 static Lisp_Object
 load_unwind (arg)  /* used as unwind-protect function in load */
      Lisp_Object arg;
 {
-  FILE *stream = (FILE *) XSAVE_VALUE (arg)->pointer;
-  if (stream != NULL)
+  struct load_input *input = (struct load_input *) XSAVE_VALUE (arg)->pointer;
+  if (input->stream != NULL)
     {
       BLOCK_INPUT;
-      fclose (stream);
+      fclose (input->stream);
       UNBLOCK_INPUT;
     }
+  xfree (input->start);
+  instream = input->prev;
   return Qnil;
 }
 
@@ -1372,6 +1500,93 @@ in which case file-name-handlers are ignored.  */)
   return file;
 }
 
+#ifdef LOAD_DIRECTORY_CACHE
+
+/* An `equal' hash table of the directories openp has listed, or nil.
+   Each key is the encoded name of a directory, ending in a slash, and
+   each value is a vector [HIGH LOW NAMES]: HIGH and LOW make up the
+   modification time the directory had when it was listed, and NAMES is
+   an `equal' hash table of the names of the files in it.  */
+
+static Lisp_Object load_directory_cache;
+
+/* Return the names of the files in the directory whose encoded name is
+   the LEN bytes at DIR, which end in a slash, as an `equal' hash table.
+   List the directory again only if it has changed since it was last
+   listed.  Return nil if the names cannot be known that way.  */
+
+static Lisp_Object
+load_directory_files (dir, len)
+     const char *dir;
+     int len;
+{
+  struct Lisp_Hash_Table *h;
+  struct stat st;
+  struct dirent *dp;
+  DIR *d;
+  Lisp_Object key, entry, names, args[2];
+  unsigned hash;
+  char *name;
+  int i;
+
+  name = (char *) alloca (len + 1);
+  bcopy (dir, name, len);
+  name[len] = 0;
+  if (stat (name, &st) < 0)
+    return Qnil;
+
+  args[0] = QCtest;
+  args[1] = Qequal;
+  if (NILP (load_directory_cache))
+    load_directory_cache = Fmake_hash_table (2, args);
+  h = XHASH_TABLE (load_directory_cache);
+  key = make_unibyte_string (dir, len);
+  i = hash_lookup (h, key, &hash);
+  if (i >= 0)
+    {
+      entry = HASH_VALUE (h, i);
+      if (XINT (AREF (entry, 0)) == (st.st_mtime >> 16)
+	  && XINT (AREF (entry, 1)) == (st.st_mtime & 0xffff))
+	return AREF (entry, 2);
+    }
+
+  /* A file made in the same second as the listing need not change the
+     modification time of the directory, so don't list a directory
+     changed that recently.  */
+  if (st.st_mtime >= time (NULL) - 1)
+    return Qnil;
+
+  BLOCK_INPUT;
+  d = opendir (name);
+  UNBLOCK_INPUT;
+  if (!d)
+    return Qnil;
+
+  names = Fmake_hash_table (2, args);
+  errno = 0;
+  while ((dp = readdir (d)))
+    Fputhash (make_unibyte_string (dp->d_name, strlen (dp->d_name)),
+	      Qt, names);
+  if (errno)
+    names = Qnil;
+  BLOCK_INPUT;
+  closedir (d);
+  UNBLOCK_INPUT;
+  if (NILP (names))
+    return Qnil;
+
+  entry = Fmake_vector (make_number (3), Qnil);
+  ASET (entry, 0, make_number (st.st_mtime >> 16));
+  ASET (entry, 1, make_number (st.st_mtime & 0xffff));
+  ASET (entry, 2, names);
+  if (i >= 0)
+    HASH_VALUE (h, i) = entry;
+  else
+    hash_put (h, key, entry, hash);
+  return names;
+}
+
+#endif /* LOAD_DIRECTORY_CACHE */
 
 /* Search for a file whose name is STR, looking in directories
    in the Lisp list PATH, and trying suffixes from SUFFIX.
@@ -1391,7 +1606,10 @@ in which case file-name-handlers are ignored.  */)
    nil is stored there on failure.
 
    If the file we find is remote, return -2
-   but store the found remote file name in *STOREPTR.  */
+   but store the found remote file name in *STOREPTR.
+
+   If `load-cache-directories' is non-nil, look for local files in the
+   listings of their directories before checking that they exist.  */
 
 int
 openp (path, str, suffixes, storeptr, predicate)
@@ -1409,8 +1627,9 @@ openp (path, str, suffixes, storeptr, predicate)
   Lisp_Object filename;
   struct stat st;
   struct gcpro gcpro1, gcpro2, gcpro3, gcpro4, gcpro5, gcpro6;
-  Lisp_Object string, tail, encoded_fn;
+  Lisp_Object string, tail, encoded_fn, names;
   int max_suffix_len = 0;
+  int listed;
 
   CHECK_STRING (str);
 
@@ -1421,8 +1640,10 @@ openp (path, str, suffixes, storeptr, predicate)
 			    SBYTES (XCAR (tail)));
     }
 
-  string = filename = encoded_fn = Qnil;
-  GCPRO6 (str, string, filename, path, suffixes, encoded_fn);
+  /* ENCODED_FN need not be protected, since it is only used before
+     anything can GC.  */
+  string = filename = encoded_fn = names = Qnil;
+  GCPRO6 (str, string, filename, path, suffixes, names);
 
   if (storeptr)
     *storeptr = Qnil;
@@ -1450,6 +1671,11 @@ openp (path, str, suffixes, storeptr, predicate)
       if (fn_size < want_size)
 	fn = (char *) alloca (fn_size = 100 + want_size);
 
+      /* The suffixes don't change the directory, so it only needs to
+	 be listed once.  */
+      listed = 0;
+      names = Qnil;
+
       /* Loop over suffixes.  */
       for (tail = NILP (suffixes) ? Fcons (empty_unibyte_string, Qnil) : suffixes;
 	   CONSP (tail); tail = XCDR (tail))
@@ -1512,6 +1738,26 @@ openp (path, str, suffixes, storeptr, predicate)
 
 	      encoded_fn = ENCODE_FILE (string);
 	      pfn = SDATA (encoded_fn);
+
+#ifdef LOAD_DIRECTORY_CACHE
+	      if (load_cache_directories)
+		{
+		  const char *base = strrchr (pfn, '/');
+
+		  if (base && !listed)
+		    {
+		      names = load_directory_files (pfn, base + 1 - pfn);
+		      listed = 1;
+		    }
+		  if (base && HASH_TABLE_P (names)
+		      && hash_lookup (XHASH_TABLE (names),
+				      make_unibyte_string (base + 1,
+							   strlen (base + 1)),
+				      NULL) < 0)
+		    continue;
+		}
+#endif /* LOAD_DIRECTORY_CACHE */
+
 	      exists = (stat (pfn, &st) >= 0
 			&& (st.st_mode & S_IFMT) != S_IFDIR);
 	      if (exists)
@@ -1650,7 +1896,7 @@ static void
 readevalloop (readcharfun, stream, sourcename, evalfun,
 	      printflag, unibyte, readfun, start, end)
      Lisp_Object readcharfun;
-     FILE *stream;
+     struct load_input *stream;
      Lisp_Object sourcename;
      Lisp_Object (*evalfun) ();
      int printflag;
@@ -1658,7 +1904,7 @@ readevalloop (readcharfun, stream, sourcename, evalfun,
      Lisp_Object start, end;
 {
   register int c;
-  register Lisp_Object val;
+  register Lisp_Object val, lex_bound;
   int count = SPECPDL_INDEX ();
   struct gcpro gcpro1, gcpro2, gcpro3, gcpro4;
   struct buffer *b = 0;
@@ -1688,6 +1934,15 @@ readevalloop (readcharfun, stream, sourcename, evalfun,
   record_unwind_protect (readevalloop_1, load_convert_to_unibyte ? Qt : Qnil);
   load_convert_to_unibyte = !NILP (unibyte);
 
+  /* Evaluate in an empty lexical environment if `lexical-binding' is
+     non-nil here, whether `load' or `eval-buffer' bound it from the
+     file's first line or it is the buffer-local value of the buffer
+     being read.  */
+  lex_bound = find_symbol_value (Qlexical_binding);
+  specbind (Qinternal_interpreter_environment,
+	    NILP (lex_bound) || EQ (lex_bound, Qunbound)
+	    ? Qnil : Fcons (Qt, Qnil));
+
   GCPRO4 (sourcename, readfun, start, end);
 
   /* Try to ensure sourcename is a truename, except whilst preloading. */
@@ -1762,6 +2017,7 @@ readevalloop (readcharfun, stream, sourcename, evalfun,
 	{
 	  UNREAD (c);
 	  read_objects = Qnil;
+	  read_lazy_defalias = read_lazy_docstring = 0;
 	  if (!NILP (readfun))
 	    {
 	      val = call1 (readfun, readcharfun);
@@ -1779,7 +2035,22 @@ readevalloop (readcharfun, stream, sourcename, evalfun,
 	  else if (! NILP (Vload_read_function))
 	    val = call1 (Vload_read_function, readcharfun);
 	  else
-	    val = read_internal_start (readcharfun, Qnil, Qnil);
+	    {
+	      /* C is in unread_char, and what follows it is in the file:
+		 the function name of a defalias, or a #@ doc string
+		 that read1 skips before looking for the defalias.  */
+	      if (load_lazy_functions && EQ (readcharfun, Qget_file_char))
+		{
+		  read_lazy_defalias
+		    = (c == '(' && instream->end - instream->pos > 9
+		       && !bcmp (instream->pos, "defalias ", 9));
+		  read_lazy_docstring
+		    = (c == '#' && instream->pos < instream->end
+		       && *instream->pos == '@');
+		}
+	      val = read_internal_start (readcharfun, Qnil, Qnil);
+	      read_lazy_defalias = read_lazy_docstring = 0;
+	    }
 	}
 
       if (!NILP (start) && continue_reading_p)
@@ -1850,7 +2121,8 @@ This function preserves the position of point.  */)
   specbind (Qstandard_output, tem);
   record_unwind_protect (save_excursion_restore, save_excursion_save ());
   BUF_TEMP_SET_PT (XBUFFER (buf), BUF_BEGV (XBUFFER (buf)));
-  readevalloop (buf, 0, filename, Feval,
+  specbind (Qlexical_binding, lisp_file_lexically_bound_p (buf) ? Qt : Qnil);
+  readevalloop (buf, 0, filename, eval_sub,
 		!NILP (printflag), unibyte, Qnil, Qnil, Qnil);
   unbind_to (count, Qnil);
 
@@ -1885,7 +2157,7 @@ This function does not move point.  */)
   specbind (Qeval_buffer_list, Fcons (cbuf, Veval_buffer_list));
 
   /* readevalloop calls functions which check the type of start and end.  */
-  readevalloop (cbuf, 0, XBUFFER (cbuf)->filename, Feval,
+  readevalloop (cbuf, 0, XBUFFER (cbuf)->filename, eval_sub,
 		!NILP (printflag), Qnil, read_function,
 		start, end);
 
@@ -2496,7 +2768,12 @@ read1 (readcharfun, pch, first_in_list)
 	  /* Accept compiled functions at read-time so that we don't have to
 	     build them using function calls.  */
 	  Lisp_Object tmp;
-	  tmp = read_vector (readcharfun, 1);
+	  if (read_lazy_defalias)
+	    tmp = read_lazy_byte_code (readcharfun);
+	  else
+	    tmp = read_vector (readcharfun, 1);
+	  if (XVECTOR (tmp)->size > COMPILED_BYTECODE)
+	    native_attach (AREF (tmp, COMPILED_BYTECODE));
 	  return Fmake_byte_code (XVECTOR (tmp)->size,
 				  XVECTOR (tmp)->contents);
 	}
@@ -2537,7 +2814,7 @@ read1 (readcharfun, pch, first_in_list)
 	 and function definitions.  */
       if (c == '@')
 	{
-	  int i, nskip = 0;
+	  int i, nskip = 0, from_file;
 
 	  load_each_byte = 1;
 	  /* Read a decimal integer.  */
@@ -2550,9 +2827,13 @@ read1 (readcharfun, pch, first_in_list)
 	  if (c >= 0)
 	    UNREAD (c);
 
-	  if (load_force_doc_strings
-	      && (EQ (readcharfun, Qget_file_char)
-		  || EQ (readcharfun, Qget_emacs_mule_file_char)))
+	  from_file = (EQ (readcharfun, Qget_file_char)
+		       || EQ (readcharfun, Qget_emacs_mule_file_char));
+	  if (from_file
+	      && nskip > instream->end - instream->pos)
+	    nskip = instream->end - instream->pos;
+
+	  if (load_force_doc_strings && from_file)
 	    {
 	      /* If we are supposed to force doc strings into core right now,
 		 record the last string that we skipped,
@@ -2589,14 +2870,17 @@ read1 (readcharfun, pch, first_in_list)
 							saved_doc_string_size);
 		}
 
-	      saved_doc_string_position = file_tell (instream);
+	      saved_doc_string_position = instream->pos - instream->start;
 
 	      /* Copy that many characters into saved_doc_string.  */
-	      for (i = 0; i < nskip && c >= 0; i++)
-		saved_doc_string[i] = c = READCHAR;
+	      bcopy (instream->pos, saved_doc_string, nskip);
+	      instream->pos += nskip;
 
-	      saved_doc_string_length = i;
+	      saved_doc_string_length = nskip;
 	    }
+	  else if (from_file)
+	    /* Skip that many characters.  */
+	    instream->pos += nskip;
 	  else
 	    {
 	      /* Skip that many characters.  */
@@ -2604,6 +2888,17 @@ read1 (readcharfun, pch, first_in_list)
 		c = READCHAR;
 	    }
 
+	  /* If this doc string started a top-level form, the form is
+	     what follows it, and may be the defalias it documents.  */
+	  if (read_lazy_docstring && from_file)
+	    {
+	      unsigned char *p = skip_white_space (instream->pos,
+						   instream->end);
+	      read_lazy_defalias = (instream->end - p > 10
+				    && !bcmp (p, "(defalias ", 10));
+	    }
+	  read_lazy_docstring = 0;
+
 	  load_each_byte = 0;
 	  goto retry;
 	}
@@ -3389,6 +3684,206 @@ read_vector (readcharfun, bytecodeflag)
   return vector;
 }
 
+/* Return the first address from P on, before END, that is not white
+   space.  */
+
+static unsigned char *
+skip_white_space (p, end)
+     unsigned char *p, *end;
+{
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'
+		     || *p == '\f'))
+    p++;
+  return p;
+}
+
+/* Skip the printed object at P, after any white space, which ends
+   before END, and return the address after it.  Return 0 if it is
+   not there, or if it contains anything that cannot be read on its
+   own: a comment, a #N= or #N# reference to another part of the
+   form, or a #@ doc string.  */
+
+static unsigned char *
+skip_printed_object (p, end)
+     unsigned char *p, *end;
+{
+  int depth = 0;
+
+  p = skip_white_space (p, end);
+  do
+    {
+      if (p >= end)
+	return 0;
+      switch (*p)
+	{
+	case '"':
+	  for (p++; p < end && *p != '"'; p++)
+	    if (*p == '\\')
+	      p++;
+	  if (p >= end)
+	    return 0;
+	  p++;
+	  break;
+
+	case '(': case '[':
+	  depth++;
+	  p++;
+	  break;
+
+	case ')': case ']':
+	  if (depth == 0)
+	    return 0;
+	  depth--;
+	  p++;
+	  break;
+
+	case ';':
+	  return 0;
+
+	case '#':
+	  if (p + 1 < end && (p[1] == '@' || (p[1] >= '0' && p[1] <= '9')))
+	    return 0;
+	  p++;
+	  break;
+
+	case '\\':
+	  p += 2;
+	  break;
+
+	default:
+	  p++;
+	  /* An atom outside of any list ends at a delimiter.  */
+	  if (depth == 0)
+	    {
+	      while (p < end && *p != ' ' && *p != '\t' && *p != '\n'
+		     && *p != '\r' && *p != '\f' && *p != '"' && *p != ';'
+		     && *p != '(' && *p != ')' && *p != '[' && *p != ']')
+		p += *p == '\\' ? 2 : 1;
+	      if (p > end)
+		return 0;
+	    }
+	}
+    }
+  while (depth > 0);
+
+  return p;
+}
+
+/* Read the rest of a byte-code object that a top-level `defalias' in
+   the file being loaded defines a function as, after its `#['.  Leave
+   its byte-code string and constants vector in the file: put (FILE
+   POSITION . LENGTH) in its byte-code slot instead, for `fetch-bytecode'
+   to read them when the function is first called.  If that cannot be
+   done, read the whole object.  */
+
+static Lisp_Object
+read_lazy_byte_code (readcharfun)
+     Lisp_Object readcharfun;
+{
+  unsigned char *p, *body, *body_end, *end = instream ? instream->end : 0;
+  Lisp_Object args, filepos, tem;
+  struct gcpro gcpro1, gcpro2;
+
+  read_lazy_defalias = 0;
+
+  /* Native code is attached by the byte-code string, and pure objects
+     cannot be changed when they are fetched.  */
+  if (!EQ (readcharfun, Qget_file_char) || !instream || unread_char >= 0
+      || load_force_doc_strings || read_pure || !NILP (Vpurify_flag)
+      || !NILP (native_code_pending) || !STRINGP (Vload_file_name))
+    return read_vector (readcharfun, 1);
+
+  /* Find the byte-code string and the constants vector after the
+     argument list.  */
+  p = skip_printed_object (instream->pos, end);
+  body = p ? skip_white_space (p, end) : end;
+  p = (body < end && *body == '"') ? skip_printed_object (body, end) : 0;
+  p = p ? skip_white_space (p, end) : end;
+  body_end = (p < end && *p == '[') ? skip_printed_object (p, end) : 0;
+  if (!body_end)
+    return read_vector (readcharfun, 1);
+
+  args = read0 (readcharfun);
+  /* The argument list ends before the byte-code string, so only white
+     space can have been unread after it.  */
+  unread_char = -1;
+  filepos = Fcons (Vload_file_name,
+		   Fcons (make_number (body - instream->start),
+			  make_number (body_end - body)));
+  instream->pos = body_end;
+
+  GCPRO2 (args, filepos);
+  tem = read_list (1, readcharfun);
+  UNGCPRO;
+
+  tem = Fcons (args, Fcons (filepos, Fcons (Qnil, tem)));
+  return Fvconcat (1, &tem);
+}
+
+/* Return the byte-code string and constants vector of a function that
+   `load' left in the file, as a cons.  FILEPOS is (FILE POSITION
+   . LENGTH), and says where their text is.  Return nil if the file no
+   longer has them there.  */
+
+Lisp_Object
+read_lazy_function (filepos)
+     Lisp_Object filepos;
+{
+  struct load_input input;
+  Lisp_Object file, bytestr, constants, encoded, saved_read_objects;
+  int count = SPECPDL_INDEX ();
+  int fd, position, length, saved_unread_char;
+
+  file = XCAR (filepos);
+  if (!STRINGP (file) || !CONSP (XCDR (filepos))
+      || !INTEGERP (XCAR (XCDR (filepos)))
+      || !INTEGERP (XCDR (XCDR (filepos))))
+    return Qnil;
+  position = XINT (XCAR (XCDR (filepos)));
+  length = XINT (XCDR (XCDR (filepos)));
+  if (position < 0 || length <= 0)
+    return Qnil;
+
+  encoded = ENCODE_FILE (file);
+  fd = emacs_open ((char *) SDATA (encoded), O_RDONLY, 0);
+  if (fd < 0)
+    report_file_error ("Opening lazily loaded function", Fcons (file, Qnil));
+
+  input.stream = NULL;
+  input.start = input.pos = (unsigned char *) xmalloc (length);
+  input.end = input.start + length;
+  input.prev = instream;
+  record_unwind_protect (load_unwind, make_save_value (&input, 0));
+
+  if (lseek (fd, position, 0) != position
+      || emacs_read (fd, (char *) input.start, length) != length)
+    {
+      emacs_close (fd);
+      return unbind_to (count, Qnil);
+    }
+  emacs_close (fd);
+  if (input.start[0] != '"' || input.end[-1] != ']')
+    return unbind_to (count, Qnil);
+
+  /* This can be called while another form is being read.  */
+  saved_read_objects = read_objects;
+  saved_unread_char = unread_char;
+  unread_char = -1;
+  read_lazy_defalias = read_lazy_docstring = 0;
+  instream = &input;
+  specbind (Qload_file_name, file);
+  bytestr = read_internal_start (Qget_file_char, Qnil, Qnil);
+  constants = read_internal_start (Qget_file_char, Qnil, Qnil);
+  read_objects = saved_read_objects;
+  unread_char = saved_unread_char;
+
+  if (!STRINGP (bytestr) || !VECTORP (constants) || input.pos != input.end)
+    return unbind_to (count, Qnil);
+  if (STRING_MULTIBYTE (bytestr))
+    bytestr = Fstring_as_unibyte (bytestr);
+  return unbind_to (count, Fcons (bytestr, constants));
+}
+
 /* FLAG = 1 means check for ] to terminate rather than ) and .
    FLAG = -1 means check for starting with defun
     and make structure pure.  */
@@ -3584,7 +4079,7 @@ Lisp_Object initial_obarray;
 
 int oblookup_last_bucket_number;
 
-static int hash_string ();
+static unsigned hash_string ();
 
 /* Get an error if OBARRAY is not an obarray.
    If it is one, return it.  */
@@ -3821,23 +4316,26 @@ oblookup (obarray, ptr, size, size_byte)
   return tem;
 }
 
-static int
+/* Return the hash code of the LEN bytes at PTR.  This is the FNV-1a
+   hash, which mixes each byte into all the bits of the code, so that
+   names differing only in their last characters, as the names of
+   symbols often do, are spread over the buckets.  */
+
+static unsigned
 hash_string (ptr, len)
      const unsigned char *ptr;
      int len;
 {
   register const unsigned char *p = ptr;
   register const unsigned char *end = p + len;
-  register unsigned char c;
-  register int hash = 0;
+  register unsigned hash = 2166136261u;
 
   while (p != end)
     {
-      c = *p++;
-      if (c >= 0140) c -= 40;
-      hash = ((hash<<3) + (hash>>28) + c);
+      hash ^= *p++;
+      hash *= 16777619;
     }
-  return hash & 07777777777;
+  return hash;
 }
 
 void
@@ -3883,13 +4381,18 @@ OBARRAY defaults to the value of `obarray'.  */)
   return Qnil;
 }
 
-#define OBARRAY_SIZE 1511
+/* The standard obarray holds the symbols of Emacs and of every package
+   loaded in a session, which can be 60000 or more.  Obarrays do not
+   grow, because Lisp code may treat one as a vector whose elements are
+   its buckets, so start with enough buckets to keep chains short.  */
+
+#define OBARRAY_SIZE 16381
 
 void
 init_obarray ()
 {
   Lisp_Object oblength;
-  int hash;
+  unsigned hash;
   Lisp_Object *tem;
 
   XSETFASTINT (oblength, OBARRAY_SIZE);
@@ -3962,6 +4465,7 @@ defvar_int (namestring, address)
 {
   Lisp_Object sym, val;
   sym = intern (namestring);
+  XSYMBOL (sym)->declared_special = 1;
   val = allocate_misc ();
   XMISCTYPE (val) = Lisp_Misc_Intfwd;
   XINTFWD (val)->intvar = address;
@@ -3977,6 +4481,7 @@ defvar_bool (namestring, address)
 {
   Lisp_Object sym, val;
   sym = intern (namestring);
+  XSYMBOL (sym)->declared_special = 1;
   val = allocate_misc ();
   XMISCTYPE (val) = Lisp_Misc_Boolfwd;
   XBOOLFWD (val)->boolvar = address;
@@ -3996,6 +4501,7 @@ defvar_lisp_nopro (namestring, address)
 {
   Lisp_Object sym, val;
   sym = intern (namestring);
+  XSYMBOL (sym)->declared_special = 1;
   val = allocate_misc ();
   XMISCTYPE (val) = Lisp_Misc_Objfwd;
   XOBJFWD (val)->objvar = address;
@@ -4021,6 +4527,7 @@ defvar_kboard (namestring, offset)
 {
   Lisp_Object sym, val;
   sym = intern (namestring);
+  XSYMBOL (sym)->declared_special = 1;
   val = allocate_misc ();
   XMISCTYPE (val) = Lisp_Misc_Kboard_Objfwd;
   XKBOARD_OBJFWD (val)->offset = offset;
@@ -4219,6 +4726,11 @@ init_lread ()
 
   Vstandard_input = Qt;
   Vloads_in_progress = Qnil;
+
+#ifdef LOAD_DIRECTORY_CACHE
+  /* Don't trust listings made before Emacs was dumped.  */
+  load_directory_cache = Qnil;
+#endif
 }
 
 /* Print a warning, using format string FORMAT, that directory DIRNAME
@@ -4312,6 +4824,16 @@ Each element is a string (directory name) or nil (try default directory).
 Initialized based on EMACSLOADPATH environment variable, if any,
 otherwise to default specified by file `epaths.h' when Emacs was built.  */);
 
+  DEFVAR_BOOL ("load-cache-directories", &load_cache_directories,
+	       doc: /* *Non-nil means `load' remembers the files in the directories it searches.
+When it looks for a file in a directory of `load-path', it lists the
+directory, and after that only looks for the file, with each of its
+suffixes, in that listing.  A directory is listed again when its
+modification time changes.  Other functions that search a list of
+directories, such as `locate-file' and `call-process', do the same.
+This has no effect on systems whose file names are not case-sensitive.  */);
+  load_cache_directories = 1;
+
   DEFVAR_LISP ("load-suffixes", &Vload_suffixes,
 	       doc: /* List of suffixes for (compiled or source) Emacs Lisp files.
 This list should not include the empty string.
@@ -4334,6 +4856,24 @@ the loading functions recognize as compression suffixes, you should
 customize `jka-compr-load-suffixes' rather than the present variable.  */);
   Vload_file_rep_suffixes = Fcons (empty_unibyte_string, Qnil);
 
+  DEFVAR_LISP ("lexical-binding", &Vlexical_binding,
+	       doc: /* Whether to use lexical binding when evaluating code.
+Non-nil means that the code in the current buffer should be evaluated
+with lexical binding: `let', function arguments and `condition-case'
+variables are then bound lexically, unless they are declared special
+with `defvar' or `defconst', and `function' makes closures.
+`load' and `eval-buffer' set this from a `lexical-binding' setting in
+the `-*-' line at the start of a file.
+Lexical binding is experimental and works only in the interpreter; the
+byte compiler refuses a file that sets this, unless the file also sets
+`no-byte-compile'.
+This variable is automatically buffer-local.  */);
+  Vlexical_binding = Qnil;
+  Qlexical_binding = intern ("lexical-binding");
+  staticpro (&Qlexical_binding);
+  Fmake_variable_buffer_local (Qlexical_binding);
+  Fput (Qlexical_binding, intern ("safe-local-variable"), intern ("booleanp"));
+
   DEFVAR_BOOL ("load-in-progress", &load_in_progress,
 	       doc: /* Non-nil if inside of `load'.  */);
   Qload_in_progress = intern ("load-in-progress");
@@ -4410,6 +4950,16 @@ See `load' for the meaning of the remaining arguments.  */);
 This is useful when the file being loaded is a temporary copy.  */);
   load_force_doc_strings = 0;
 
+  DEFVAR_BOOL ("load-lazy-functions", &load_lazy_functions,
+	       doc: /* *Non-nil means `load' defers reading byte-compiled function bodies.
+When a byte-compiled file defines a function with `defalias', the
+byte-code string and constants vector of the function stay in the file
+until the function is first called, when `fetch-bytecode' reads them.
+This makes loading faster and uses less memory for functions that are
+never called, but a function fails to run if its file is changed
+meanwhile.  Files loaded with native code are read completely.  */);
+  load_lazy_functions = 0;
+
   DEFVAR_BOOL ("load-convert-to-unibyte", &load_convert_to_unibyte,
 	       doc: /* Non-nil means `read' converts strings to unibyte whenever possible.
 This is normally bound by `load' and `eval-buffer' to control `read',
@@ -4528,6 +5078,11 @@ to load.  See also `load-dangerous-libraries'.  */);
   Vloads_in_progress = Qnil;
   staticpro (&Vloads_in_progress);
 
+#ifdef LOAD_DIRECTORY_CACHE
+  load_directory_cache = Qnil;
+  staticpro (&load_directory_cache);
+#endif
+
   Qhash_table = intern ("hash-table");
   staticpro (&Qhash_table);
   Qdata = intern ("data");
@@ -0,0 +1,232 @@
+/* Loading byte-code functions translated to native code.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GNU Emacs.
+
+GNU Emacs is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+GNU Emacs is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* byte-native.el translates the byte-code functions of FOO.elc into C
+   and compiles them into a shared object FOO.eln.  When FOO.elc is
+   loaded, the shared object is loaded too, and each byte-code object
+   read whose byte-code string is one of those translated is given
+   the native function.  exec_byte_code then calls that function
+   instead of interpreting the byte-code.
+
+   The byte-code object itself is unchanged, so everything that looks
+   at it still works, and a function whose native code is not loaded
+   or not found simply runs in the interpreter.  */
+
+#include <config.h>
+#include <setjmp.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "lisp.h"
+#include "buffer.h"
+#include "character.h"
+#include "coding.h"
+#include "blockinput.h"
+#include "dispextern.h"
+#include "bytecode.h"
+
+#ifdef HAVE_DLOPEN
+#include <dlfcn.h>
+#endif
+
+/* Non-nil means load the native code of byte-compiled files.  */
+Lisp_Object Vload_native_code;
+
+/* Weak hash table mapping byte-code strings, by `eq', to the native
+   functions that execute them, each in a save-value.  */
+
+static Lisp_Object native_code_table;
+
+/* Non-zero once any native function is in native_code_table, so that
+   exec_byte_code need not look until then.  */
+
+int native_code_loaded;
+
+/* While a .elc file is being loaded, an `equal' hash table mapping
+   the byte-code strings translated in its .eln file to their native
+   functions.  Otherwise nil.  */
+
+Lisp_Object native_code_pending;
+
+static Lisp_Object Qemacs_version;
+
+static Lisp_Object
+native_load_unwind (old)
+     Lisp_Object old;
+{
+  native_code_pending = old;
+  return Qnil;
+}
+
+/* Load the native code for the byte-compiled file ELC, which is being
+   loaded, if there is any.  It is used for the byte-code objects read
+   until the enclosing load is unwound.  */
+
+void
+native_load_file (elc)
+     Lisp_Object elc;
+{
+#ifdef HAVE_DLOPEN
+  Lisp_Object eln, encoded, table;
+  struct native_function_entry *entries;
+  struct stat elc_stat, eln_stat;
+  int *abi_version;
+  const char *emacs_version;
+  void *handle;
+  Lisp_Object args[2];
+
+  if (NILP (Vload_native_code) || !NILP (Vpurify_flag)
+      || SBYTES (elc) < 4
+      || bcmp (SDATA (elc) + SBYTES (elc) - 4, ".elc", 4))
+    return;
+
+  eln = concat2 (Fsubstring (elc, make_number (0), make_number (-1)),
+		 build_string ("n"));
+  encoded = ENCODE_FILE (eln);
+
+  /* Native code older than the byte code was not made from it.  */
+  if (stat ((char *) SDATA (encoded), &eln_stat) < 0
+      || stat ((char *) SDATA (ENCODE_FILE (elc)), &elc_stat) < 0
+      || eln_stat.st_mtime < elc_stat.st_mtime)
+    return;
+
+  BLOCK_INPUT;
+  handle = dlopen ((char *) SDATA (encoded), RTLD_NOW | RTLD_LOCAL);
+  UNBLOCK_INPUT;
+  if (!handle)
+    {
+      add_to_log ("Cannot load native code %s: %s",
+		  eln, build_string (dlerror ()));
+      return;
+    }
+
+  abi_version = (int *) dlsym (handle, "emacs_native_abi_version");
+  emacs_version = (const char *) dlsym (handle, "emacs_native_emacs_version");
+  entries = ((struct native_function_entry *)
+	     dlsym (handle, "emacs_native_functions"));
+  if (!abi_version || *abi_version != NATIVE_ABI_VERSION
+      || !emacs_version || !entries
+      || NILP (Fequal (build_string (emacs_version),
+		       Fsymbol_value (Qemacs_version))))
+    {
+      add_to_log ("Native code %s was not made for this Emacs", eln, Qnil);
+      BLOCK_INPUT;
+      dlclose (handle);
+      UNBLOCK_INPUT;
+      return;
+    }
+
+  /* The shared object is never closed: the functions in it stay in
+     native_code_table as long as their byte-code strings live.  */
+
+  args[0] = QCtest;
+  args[1] = Qequal;
+  table = Fmake_hash_table (2, args);
+  for (; entries->bytecode; entries++)
+    Fputhash (make_unibyte_string (entries->bytecode, entries->length),
+	      make_save_value ((void *) entries->function, 0),
+	      table);
+
+  record_unwind_protect (native_load_unwind, native_code_pending);
+  native_code_pending = table;
+#endif /* HAVE_DLOPEN */
+}
+
+/* BYTESTR is the byte-code string of a byte-code object just read.
+   If the file being loaded came with native code for it, record
+   that.  */
+
+void
+native_attach (bytestr)
+     Lisp_Object bytestr;
+{
+  struct Lisp_Hash_Table *h;
+  int i;
+
+  if (NILP (native_code_pending)
+      || !STRINGP (bytestr) || STRING_MULTIBYTE (bytestr))
+    return;
+
+  h = XHASH_TABLE (native_code_pending);
+  i = hash_lookup (h, bytestr, NULL);
+  if (i >= 0)
+    {
+      Fputhash (bytestr, HASH_VALUE (h, i), native_code_table);
+      native_code_loaded = 1;
+    }
+}
+
+/* Return the native function for the byte-code string BYTESTR, or
+   null if it has none.  */
+
+native_function
+lookup_native_function (bytestr)
+     Lisp_Object bytestr;
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (native_code_table);
+  int i = hash_lookup (h, bytestr, NULL);
+
+  if (i < 0)
+    return NULL;
+  return (native_function) XSAVE_VALUE (HASH_VALUE (h, i))->pointer;
+}
+
+DEFUN ("native-code-function-p", Fnative_code_function_p,
+       Snative_code_function_p, 1, 1, 0,
+       doc: /* Return t if OBJECT is a byte-code function with native code.  */)
+     (object)
+     Lisp_Object object;
+{
+  if (COMPILEDP (object)
+      && native_code_loaded
+      && lookup_native_function (AREF (object, COMPILED_BYTECODE)))
+    return Qt;
+  return Qnil;
+}
+
+void
+syms_of_native ()
+{
+  Lisp_Object args[4];
+
+  Qemacs_version = intern ("emacs-version");
+  staticpro (&Qemacs_version);
+
+  args[0] = QCtest;
+  args[1] = Qeq;
+  args[2] = QCweakness;
+  args[3] = intern ("key");
+  native_code_table = Fmake_hash_table (4, args);
+  staticpro (&native_code_table);
+
+  native_code_pending = Qnil;
+  staticpro (&native_code_pending);
+
+  native_code_loaded = 0;
+
+  defsubr (&Snative_code_function_p);
+
+  DEFVAR_LISP ("load-native-code", &Vload_native_code,
+	       doc: /* *Non-nil means `load' uses native code made for byte-compiled files.
+When loading FOO.elc, if FOO.eln exists and is not older, it is loaded
+too, and the byte-code functions translated in it run as native code.
+See `byte-native-compile-file'.  */);
+  Vload_native_code = Qt;
+}
+
+/* arch-tag: 0c6f3b2e-9d41-4c7a-8b52-3e1f6a2d9c70
+   (do not change this comment) */
@@ -0,0 +1,523 @@
+/* Operations of C code translated from byte-code.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GNU Emacs.
+
+GNU Emacs is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+GNU Emacs is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* byte-native.el translates each instruction of a byte-code string
+   into one of the N_ macros below, named after the instruction, and
+   each jump into a C `goto'.  The macros do what the corresponding
+   case of exec_byte_code does, so keep the two in step.  They refer
+   to the arguments of the native function: STACK, VECTORP and TOP.
+
+   This is only included by the generated code, after config.h.  */
+
+#include <setjmp.h>
+#include "lisp.h"
+#include "buffer.h"
+#include "character.h"
+#include "syntax.h"
+#include "window.h"
+#include "bytecode.h"
+
+#define N_PUSH(x) (*++top = (x))
+#define N_POP (*top--)
+#define N_TOP (*top)
+
+#define N_BEFORE_GC() (stack->top = top)
+#define N_AFTER_GC() (stack->top = NULL)
+
+#define N_MAYBE_GC()					\
+  do {							\
+    if (consing_since_gc > gc_cons_threshold		\
+	&& consing_since_gc > gc_relative_threshold)	\
+      {							\
+	N_BEFORE_GC ();					\
+	Fgarbage_collect ();				\
+	N_AFTER_GC ();					\
+      }							\
+  } while (0)
+
+#define N_QUIT()					\
+  do {							\
+    if (!NILP (Vquit_flag) && NILP (Vinhibit_quit))	\
+      {							\
+	Lisp_Object flag = Vquit_flag;			\
+	Vquit_flag = Qnil;				\
+	N_BEFORE_GC ();					\
+	if (EQ (Vthrow_on_input, flag))			\
+	  Fthrow (Vthrow_on_input, Qt);			\
+	Fsignal (Qquit, Qnil);				\
+	N_AFTER_GC ();					\
+      }							\
+  } while (0)
+
+/* Replace the top N values with the value of F applied to them.  */
+
+#define N_CALL0(F)				\
+  do {						\
+    Lisp_Object v1;				\
+    N_BEFORE_GC ();				\
+    v1 = F ();					\
+    N_AFTER_GC ();				\
+    N_PUSH (v1);				\
+  } while (0)
+
+#define N_CALL1(F)				\
+  do {						\
+    N_BEFORE_GC ();				\
+    N_TOP = F (N_TOP);				\
+    N_AFTER_GC ();				\
+  } while (0)
+
+#define N_CALL2(F)				\
+  do {						\
+    Lisp_Object v1;				\
+    N_BEFORE_GC ();				\
+    v1 = N_POP;					\
+    N_TOP = F (N_TOP, v1);			\
+    N_AFTER_GC ();				\
+  } while (0)
+
+#define N_CALL3(F)				\
+  do {						\
+    Lisp_Object v1, v2;				\
+    N_BEFORE_GC ();				\
+    v2 = N_POP;					\
+    v1 = N_POP;					\
+    N_TOP = F (N_TOP, v1, v2);			\
+    N_AFTER_GC ();				\
+  } while (0)
+
+#define N_CALLN(F, n)				\
+  do {						\
+    N_BEFORE_GC ();				\
+    top -= (n) - 1;				\
+    N_TOP = F ((n), &N_TOP);			\
+    N_AFTER_GC ();				\
+  } while (0)
+
+#define N_PREDICATE(test) (N_TOP = (test) ? Qt : Qnil)
+
+
+/* Stack and constants.  */
+
+#define N_constant(n) N_PUSH (vectorp[n])
+#define N_dup() do { Lisp_Object v1 = N_TOP; N_PUSH (v1); } while (0)
+#define N_discard() (top--)
+
+
+/* Variables.  */
+
+#define N_varref(n)						\
+  do {								\
+    Lisp_Object v1 = vectorp[n], v2;				\
+    if (SYMBOLP (v1))						\
+      {								\
+	v2 = SYMBOL_VALUE (v1);					\
+	if (OBJFWDP (v2))					\
+	  v2 = *XOBJFWD (v2)->objvar;				\
+	if (MISCP (v2) || EQ (v2, Qunbound))			\
+	  {							\
+	    N_BEFORE_GC ();					\
+	    v2 = Fsymbol_value (v1);				\
+	    N_AFTER_GC ();					\
+	  }							\
+      }								\
+    else							\
+      {								\
+	N_BEFORE_GC ();						\
+	v2 = Fsymbol_value (v1);				\
+	N_AFTER_GC ();						\
+      }								\
+    N_PUSH (v2);						\
+  } while (0)
+
+#define N_varset(n)						\
+  do {								\
+    Lisp_Object sym = vectorp[n], val = N_TOP;			\
+    if (SYMBOLP (sym)						\
+	&& !EQ (val, Qunbound)					\
+	&& !XSYMBOL (sym)->indirect_variable			\
+	&& !SYMBOL_CONSTANT_P (sym)				\
+	&& !MISCP (XSYMBOL (sym)->value))			\
+      XSYMBOL (sym)->value = val;				\
+    else							\
+      {								\
+	N_BEFORE_GC ();						\
+	set_internal (sym, val, current_buffer, 0);		\
+	N_AFTER_GC ();						\
+      }								\
+    (void) N_POP;						\
+  } while (0)
+
+#define N_varbind(n)				\
+  do {						\
+    N_BEFORE_GC ();				\
+    specbind (vectorp[n], N_POP);		\
+    N_AFTER_GC ();				\
+  } while (0)
+
+#define N_unbind(n)					\
+  do {							\
+    N_BEFORE_GC ();					\
+    unbind_to (SPECPDL_INDEX () - (n), Qnil);		\
+    N_AFTER_GC ();					\
+  } while (0)
+
+
+/* Function calls.  */
+
+#define N_call(n)				\
+  do {						\
+    N_BEFORE_GC ();				\
+    top -= (n);					\
+    N_TOP = Ffuncall ((n) + 1, &N_TOP);		\
+    N_AFTER_GC ();				\
+  } while (0)
+
+
+/* Control flow.  */
+
+#define N_goto(label)				\
+  do {						\
+    N_MAYBE_GC ();				\
+    N_QUIT ();					\
+    goto label;					\
+  } while (0)
+
+#define N_gotoifnil(label)			\
+  do {						\
+    Lisp_Object v1;				\
+    N_MAYBE_GC ();				\
+    v1 = N_POP;					\
+    if (NILP (v1))				\
+      {						\
+	N_QUIT ();				\
+	goto label;				\
+      }						\
+  } while (0)
+
+#define N_gotoifnonnil(label)			\
+  do {						\
+    Lisp_Object v1;				\
+    N_MAYBE_GC ();				\
+    v1 = N_POP;					\
+    if (!NILP (v1))				\
+      {						\
+	N_QUIT ();				\
+	goto label;				\
+      }						\
+  } while (0)
+
+#define N_gotoifnilelsepop(label)		\
+  do {						\
+    N_MAYBE_GC ();				\
+    if (NILP (N_TOP))				\
+      {						\
+	N_QUIT ();				\
+	goto label;				\
+      }						\
+    top--;					\
+  } while (0)
+
+#define N_gotoifnonnilelsepop(label)		\
+  do {						\
+    N_MAYBE_GC ();				\
+    if (!NILP (N_TOP))				\
+      {						\
+	N_QUIT ();				\
+	goto label;				\
+      }						\
+    top--;					\
+  } while (0)
+
+#define N_return() return N_POP
+
+
+/* Special forms.  */
+
+#define N_save_excursion() record_unwind_save_excursion ()
+
+#define N_save_current_buffer()					\
+  record_unwind_protect (set_buffer_if_live, Fcurrent_buffer ())
+
+#define N_save_window_excursion() N_CALL1 (Fsave_window_excursion)
+
+#define N_save_restriction()					\
+  record_unwind_protect (save_restriction_restore,		\
+			 save_restriction_save ())
+
+#define N_catch()					\
+  do {							\
+    Lisp_Object v1;					\
+    N_BEFORE_GC ();					\
+    v1 = N_POP;						\
+    N_TOP = internal_catch (N_TOP, eval_byte_code_body, v1);	\
+    N_AFTER_GC ();					\
+  } while (0)
+
+#define N_unwind_protect() record_unwind_protect (Fprogn, N_POP)
+
+#define N_condition_case()					\
+  do {								\
+    Lisp_Object handlers, body;					\
+    handlers = N_POP;						\
+    body = N_POP;						\
+    N_BEFORE_GC ();						\
+    N_TOP = internal_lisp_condition_case (N_TOP, body, handlers);	\
+    N_AFTER_GC ();						\
+  } while (0)
+
+#define N_temp_output_buffer_setup()			\
+  do {							\
+    N_BEFORE_GC ();					\
+    CHECK_STRING (N_TOP);				\
+    temp_output_buffer_setup (SDATA (N_TOP));		\
+    N_AFTER_GC ();					\
+    N_TOP = Vstandard_output;				\
+  } while (0)
+
+#define N_temp_output_buffer_show()			\
+  do {							\
+    Lisp_Object v1;					\
+    N_BEFORE_GC ();					\
+    v1 = N_POP;						\
+    temp_output_buffer_show (N_TOP);			\
+    N_TOP = v1;						\
+    unbind_to (SPECPDL_INDEX () - 1, Qnil);		\
+    N_AFTER_GC ();					\
+  } while (0)
+
+#define N_interactive_p() N_PUSH (Finteractive_p ())
+
+
+/* Lists, sequences and symbols.  */
+
+#define N_car() (N_TOP = CAR (N_TOP))
+#define N_cdr() (N_TOP = CDR (N_TOP))
+#define N_car_safe() (N_TOP = CAR_SAFE (N_TOP))
+#define N_cdr_safe() (N_TOP = CDR_SAFE (N_TOP))
+#define N_cons() do { Lisp_Object v1 = N_POP; N_TOP = Fcons (N_TOP, v1); } while (0)
+#define N_list1() (N_TOP = Fcons (N_TOP, Qnil))
+#define N_list2() N_listN (2)
+#define N_list3() N_listN (3)
+#define N_list4() N_listN (4)
+#define N_listN(n) (top -= (n) - 1, N_TOP = Flist ((n), &N_TOP))
+
+#define N_eq() do { Lisp_Object v1 = N_POP; N_PREDICATE (EQ (v1, N_TOP)); } while (0)
+#define N_not() N_PREDICATE (NILP (N_TOP))
+#define N_symbolp() N_PREDICATE (SYMBOLP (N_TOP))
+#define N_consp() N_PREDICATE (CONSP (N_TOP))
+#define N_stringp() N_PREDICATE (STRINGP (N_TOP))
+#define N_listp() N_PREDICATE (CONSP (N_TOP) || NILP (N_TOP))
+#define N_numberp() N_PREDICATE (NUMBERP (N_TOP))
+#define N_integerp() N_PREDICATE (INTEGERP (N_TOP))
+
+#define N_nth()					\
+  do {						\
+    Lisp_Object v1, v2;				\
+    int n;					\
+    N_BEFORE_GC ();				\
+    v1 = N_POP;					\
+    v2 = N_TOP;					\
+    CHECK_NUMBER (v2);				\
+    N_AFTER_GC ();				\
+    n = XINT (v2);				\
+    immediate_quit = 1;				\
+    while (--n >= 0 && CONSP (v1))		\
+      v1 = XCDR (v1);				\
+    immediate_quit = 0;				\
+    N_TOP = CAR (v1);				\
+  } while (0)
+
+#define N_elt()					\
+  do {						\
+    if (CONSP (N_TOP))				\
+      {						\
+	Lisp_Object v1, v2;			\
+	int n;					\
+	N_BEFORE_GC ();				\
+	v2 = N_POP;				\
+	v1 = N_TOP;				\
+	CHECK_NUMBER (v2);			\
+	N_AFTER_GC ();				\
+	n = XINT (v2);				\
+	immediate_quit = 1;			\
+	while (--n >= 0 && CONSP (v1))		\
+	  v1 = XCDR (v1);			\
+	immediate_quit = 0;			\
+	N_TOP = CAR (v1);			\
+      }						\
+    else					\
+      N_CALL2 (Felt);				\
+  } while (0)
+
+#define N_memq() N_CALL2 (Fmemq)
+#define N_member() N_CALL2 (Fmember)
+#define N_assq() N_CALL2 (Fassq)
+#define N_nthcdr() N_CALL2 (Fnthcdr)
+#define N_length() N_CALL1 (Flength)
+#define N_aref() N_CALL2 (Faref)
+#define N_aset() N_CALL3 (Faset)
+#define N_nreverse() N_CALL1 (Fnreverse)
+#define N_setcar() N_CALL2 (Fsetcar)
+#define N_setcdr() N_CALL2 (Fsetcdr)
+#define N_nconc() N_CALLN (Fnconc, 2)
+#define N_equal() do { Lisp_Object v1 = N_POP; N_TOP = Fequal (N_TOP, v1); } while (0)
+#define N_symbol_value() N_CALL1 (Fsymbol_value)
+#define N_symbol_function() N_CALL1 (Fsymbol_function)
+#define N_set() N_CALL2 (Fset)
+#define N_fset() N_CALL2 (Ffset)
+#define N_get() N_CALL2 (Fget)
+
+
+/* Strings.  */
+
+#define N_substring() N_CALL3 (Fsubstring)
+#define N_concat2() N_CALLN (Fconcat, 2)
+#define N_concat3() N_CALLN (Fconcat, 3)
+#define N_concat4() N_CALLN (Fconcat, 4)
+#define N_concatN(n) N_CALLN (Fconcat, n)
+#define N_upcase() N_CALL1 (Fupcase)
+#define N_downcase() N_CALL1 (Fdowncase)
+#define N_stringeqlsign() N_CALL2 (Fstring_equal)
+#define N_stringlss() N_CALL2 (Fstring_lessp)
+
+
+/* Arithmetic.  */
+
+#define N_INT_OR(expr, slow)			\
+  do {						\
+    Lisp_Object v1 = N_TOP;			\
+    if (INTEGERP (v1))				\
+      {						\
+	XSETINT (v1, expr);			\
+	N_TOP = v1;				\
+      }						\
+    else					\
+      {						\
+	N_BEFORE_GC ();				\
+	N_TOP = slow;				\
+	N_AFTER_GC ();				\
+      }						\
+  } while (0)
+
+#define N_sub1() N_INT_OR (XINT (v1) - 1, Fsub1 (v1))
+#define N_add1() N_INT_OR (XINT (v1) + 1, Fadd1 (v1))
+#define N_negate() N_INT_OR (- XINT (v1), Fminus (1, &N_TOP))
+
+#define N_eqlsign()						\
+  do {								\
+    Lisp_Object v1, v2;						\
+    N_BEFORE_GC ();						\
+    v2 = N_POP; v1 = N_TOP;					\
+    CHECK_NUMBER_OR_FLOAT_COERCE_MARKER (v1);			\
+    CHECK_NUMBER_OR_FLOAT_COERCE_MARKER (v2);			\
+    N_AFTER_GC ();						\
+    if (FLOATP (v1) || FLOATP (v2))				\
+      {								\
+	double f1, f2;						\
+	f1 = (FLOATP (v1) ? XFLOAT_DATA (v1) : XINT (v1));	\
+	f2 = (FLOATP (v2) ? XFLOAT_DATA (v2) : XINT (v2));	\
+	N_PREDICATE (f1 == f2);					\
+      }								\
+    else							\
+      N_PREDICATE (XINT (v1) == XINT (v2));			\
+  } while (0)
+
+#define N_gtr() N_CALL2 (Fgtr)
+#define N_lss() N_CALL2 (Flss)
+#define N_leq() N_CALL2 (Fleq)
+#define N_geq() N_CALL2 (Fgeq)
+#define N_diff() N_CALLN (Fminus, 2)
+#define N_plus() N_CALLN (Fplus, 2)
+#define N_max() N_CALLN (Fmax, 2)
+#define N_min() N_CALLN (Fmin, 2)
+#define N_mult() N_CALLN (Ftimes, 2)
+#define N_quo() N_CALLN (Fquo, 2)
+#define N_rem() N_CALL2 (Frem)
+
+
+/* Buffers.  */
+
+#define N_point() do { Lisp_Object v1; XSETFASTINT (v1, PT); N_PUSH (v1); } while (0)
+#define N_point_max() do { Lisp_Object v1; XSETFASTINT (v1, ZV); N_PUSH (v1); } while (0)
+#define N_point_min() do { Lisp_Object v1; XSETFASTINT (v1, BEGV); N_PUSH (v1); } while (0)
+#define N_goto_char() N_CALL1 (Fgoto_char)
+#define N_insert() N_CALLN (Finsert, 1)
+#define N_insertN(n) N_CALLN (Finsert, n)
+#define N_char_after() N_CALL1 (Fchar_after)
+#define N_following_char() N_CALL0 (Ffollowing_char)
+#define N_preceding_char() N_CALL0 (Fprevious_char)
+#define N_current_column()				\
+  do {							\
+    Lisp_Object v1;					\
+    N_BEFORE_GC ();					\
+    XSETFASTINT (v1, (int) current_column ());		\
+    N_AFTER_GC ();					\
+    N_PUSH (v1);					\
+  } while (0)
+#define N_indent_to()				\
+  do {						\
+    N_BEFORE_GC ();				\
+    N_TOP = Findent_to (N_TOP, Qnil);		\
+    N_AFTER_GC ();				\
+  } while (0)
+#define N_eolp() N_PUSH (Feolp ())
+#define N_eobp() N_PUSH (Feobp ())
+#define N_bolp() N_PUSH (Fbolp ())
+#define N_bobp() N_PUSH (Fbobp ())
+#define N_current_buffer() N_PUSH (Fcurrent_buffer ())
+#define N_set_buffer() N_CALL1 (Fset_buffer)
+#define N_forward_char() N_CALL1 (Fforward_char)
+#define N_forward_word() N_CALL1 (Fforward_word)
+#define N_skip_chars_forward() N_CALL2 (Fskip_chars_forward)
+#define N_skip_chars_backward() N_CALL2 (Fskip_chars_backward)
+#define N_forward_line() N_CALL1 (Fforward_line)
+#define N_end_of_line() N_CALL1 (Fend_of_line)
+#define N_buffer_substring() N_CALL2 (Fbuffer_substring)
+#define N_delete_region() N_CALL2 (Fdelete_region)
+#define N_narrow_to_region() N_CALL2 (Fnarrow_to_region)
+#define N_widen() N_CALL0 (Fwiden)
+#define N_match_beginning() N_CALL1 (Fmatch_beginning)
+#define N_match_end() N_CALL1 (Fmatch_end)
+
+#define N_set_mark() \
+  (N_BEFORE_GC (), error ("set-mark is an obsolete bytecode"))
+#define N_scan_buffer() \
+  (N_BEFORE_GC (), error ("scan-buffer is an obsolete bytecode"))
+
+#define N_set_marker()					\
+  do {							\
+    Lisp_Object v1, v2;					\
+    N_BEFORE_GC ();					\
+    v1 = N_POP;						\
+    v2 = N_POP;						\
+    N_TOP = Fset_marker (N_TOP, v2, v1);		\
+    N_AFTER_GC ();					\
+  } while (0)
+
+#define N_char_syntax()						\
+  do {								\
+    int c;							\
+    N_BEFORE_GC ();						\
+    CHECK_CHARACTER (N_TOP);					\
+    N_AFTER_GC ();						\
+    c = XFASTINT (N_TOP);					\
+    if (NILP (current_buffer->enable_multibyte_characters))	\
+      MAKE_CHAR_MULTIBYTE (c);					\
+    XSETFASTINT (N_TOP, syntax_code_spec[(int) SYNTAX (c)]);	\
+  } while (0)
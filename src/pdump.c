@@ -0,0 +1,1794 @@
+/* Portable dumping of the Lisp heap.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GNU Emacs.
+
+GNU Emacs is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+GNU Emacs is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* `dump-emacs-portable' writes the Lisp objects reachable from the
+   obarray and from the staticpro'd variables to a file, and a newly
+   started Emacs that has not been dumped with unexec can load that
+   file at startup instead of loading loadup.el.
+
+   The file does not depend on the addresses at which anything was
+   allocated.  Each object is a record in a table, and objects refer
+   to each other by their index in that table.  Loading maps the file,
+   makes a new object for each record with the ordinary allocators,
+   and then fills in the references, so the objects end up in the
+   heap like any others and the garbage collector needs to know
+   nothing about them.
+
+   Symbols are written by name and interned again when loaded, and
+   subrs are found through the symbols naming them, so a dump can
+   only be loaded by the executable that wrote it.  The loader checks
+   this by comparing the relative addresses of the staticpro'd
+   variables.
+
+   Buffers, markers, windows, frames, processes and the like cannot be
+   dumped.  A reference to one of them is omitted, and so is every
+   object that refers to one directly or indirectly, except that a
+   symbol only loses the value, function or property list that does.
+   A staticpro'd variable whose value is omitted keeps the value
+   computed while Emacs started.
+
+   C variables that are not Lisp objects but are changed from Lisp,
+   like the table of charsets, are saved by the files defining them,
+   which register them with pdump_remember_scalar, or with
+   pdump_add_hooks for anything more involved.  */
+
+#include <config.h>
+#include <stdio.h>
+#include <errno.h>
+#include <setjmp.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "lisp.h"
+#include "intervals.h"
+#include "buffer.h"
+#include "character.h"
+#include "coding.h"
+
+#ifndef O_RDONLY
+#define O_RDONLY 0
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/* Increment this whenever the format of the file changes.  */
+#define PDUMP_VERSION 1
+
+static char pdump_magic[12] = "EMACS-PDUMP";
+
+/* The kinds of records in the object table.  */
+
+enum pdump_kind
+{
+  PDUMP_END = 0,
+  PDUMP_SYMBOL,
+  PDUMP_STRING,
+  PDUMP_FLOAT,
+  PDUMP_CONS,
+  PDUMP_VECTOR,
+  PDUMP_BOOL_VECTOR,
+  PDUMP_HASH_TABLE,
+  PDUMP_SUBR,
+  PDUMP_OBARRAY
+};
+
+/* The tags of references to Lisp values.  */
+
+enum pdump_ref_tag
+{
+  /* No value, e.g. a string without text properties.  */
+  PDUMP_REF_NONE = 0,
+  /* An integer, which follows.  */
+  PDUMP_REF_INT,
+  /* The object whose index follows.  */
+  PDUMP_REF_OBJECT,
+  /* Qunbound.  */
+  PDUMP_REF_UNBOUND,
+  /* An object that cannot be dumped.  */
+  PDUMP_REF_OMITTED
+};
+
+/* How a symbol's value is written.  */
+
+enum pdump_value_kind
+{
+  /* The value itself.  */
+  PDUMP_VALUE_PLAIN = 0,
+  /* The default value of a variable forwarded to C.  */
+  PDUMP_VALUE_FORWARDED,
+  /* The default value of a variable that becomes buffer-local
+     whenever it is set.  */
+  PDUMP_VALUE_LOCAL_IF_SET,
+  /* The default value of a variable with buffer-local bindings.  */
+  PDUMP_VALUE_LOCALIZED
+};
+
+/* Bits of the flags of a symbol record.  */
+
+#define PDUMP_SYMBOL_INTERNED_MASK 3
+#define PDUMP_SYMBOL_CONSTANT 4
+#define PDUMP_SYMBOL_INDIRECT 8
+#define PDUMP_SYMBOL_SPECIAL 16
+
+/* The header at the start of the file.  */
+
+struct pdump_header
+{
+  char magic[sizeof pdump_magic];
+  int version;
+  int word_size;
+  int double_size;
+};
+
+/* C variables and hooks registered by the files defining them.  */
+
+#define PDUMP_MAX_SCALARS 64
+#define PDUMP_MAX_HOOKS 16
+
+static struct
+{
+  void *address;
+  int size;
+} pdump_scalars[PDUMP_MAX_SCALARS];
+
+static int pdump_nscalars;
+
+static struct
+{
+  void (*save) P_ ((void));
+  void (*load) P_ ((void));
+} pdump_hooks[PDUMP_MAX_HOOKS];
+
+static int pdump_nhooks;
+
+/* Name of the file loaded at startup, or nil.  */
+
+Lisp_Object Vportable_dump_file_name;
+
+/* Register the SIZE bytes of C data at ADDRESS to be saved in a
+   dump, and restored when it is loaded.  This must be done while
+   Emacs initializes, before the dump is loaded.  */
+
+void
+pdump_remember_scalar (address, size)
+     void *address;
+     int size;
+{
+  if (pdump_nscalars >= PDUMP_MAX_SCALARS)
+    abort ();
+  pdump_scalars[pdump_nscalars].address = address;
+  pdump_scalars[pdump_nscalars].size = size;
+  pdump_nscalars++;
+}
+
+/* Register SAVE to be called when a dump is written, and LOAD when
+   it is loaded.  SAVE writes data with pdump_write_data and
+   pdump_write_object, and LOAD reads them back in the same order
+   with pdump_read_data and pdump_read_object.  The LOAD functions
+   are called in the order they were registered, after all Lisp
+   objects and scalars have been restored.  */
+
+void
+pdump_add_hooks (save, load)
+     void (*save) P_ ((void));
+     void (*load) P_ ((void));
+{
+  if (pdump_nhooks >= PDUMP_MAX_HOOKS)
+    abort ();
+  pdump_hooks[pdump_nhooks].save = save;
+  pdump_hooks[pdump_nhooks].load = load;
+  pdump_nhooks++;
+}
+
+
+/***********************************************************************
+			     Writing a dump
+ ***********************************************************************/
+
+/* A growable buffer of bytes to write.  */
+
+struct pdump_buffer
+{
+  unsigned char *data;
+  int used, size;
+};
+
+/* The records and sections not yet written to the file.  */
+
+static struct pdump_buffer pdump_out;
+
+/* The data written by the save hooks.  They run before the objects
+   are written, because they may add objects.  */
+
+static struct pdump_buffer pdump_hook_data;
+
+/* The buffer pdump_write_data writes to.  */
+
+static struct pdump_buffer *pdump_target;
+
+static FILE *pdump_stream;
+static Lisp_Object pdump_file;
+
+/* Hash table mapping each object to be dumped, by `eq', to its index
+   in pdump_objects.  */
+
+static Lisp_Object pdump_index;
+
+/* The objects to be dumped, in the order they were found.  */
+
+static Lisp_Object *pdump_objects;
+static int pdump_nobjects, pdump_objects_size;
+
+static void
+pdump_grow (buffer, nbytes)
+     struct pdump_buffer *buffer;
+     int nbytes;
+{
+  if (buffer->used + nbytes > buffer->size)
+    {
+      buffer->size = max (2 * buffer->size, buffer->used + nbytes + 4096);
+      buffer->data = (unsigned char *) xrealloc (buffer->data, buffer->size);
+    }
+}
+
+static void
+pdump_put_bytes (buffer, data, nbytes)
+     struct pdump_buffer *buffer;
+     const void *data;
+     int nbytes;
+{
+  pdump_grow (buffer, nbytes);
+  bcopy (data, buffer->data + buffer->used, nbytes);
+  buffer->used += nbytes;
+}
+
+static void
+pdump_put_byte (buffer, c)
+     struct pdump_buffer *buffer;
+     int c;
+{
+  pdump_grow (buffer, 1);
+  buffer->data[buffer->used++] = c;
+}
+
+static void
+pdump_put_int (buffer, i)
+     struct pdump_buffer *buffer;
+     int i;
+{
+  pdump_put_bytes (buffer, &i, sizeof i);
+}
+
+static void
+pdump_put_word (buffer, w)
+     struct pdump_buffer *buffer;
+     EMACS_INT w;
+{
+  pdump_put_bytes (buffer, &w, sizeof w);
+}
+
+/* Write the NCHARS characters in the NBYTES bytes at DATA.  */
+
+static void
+pdump_put_name (buffer, data, nchars, nbytes, multibyte)
+     struct pdump_buffer *buffer;
+     const unsigned char *data;
+     int nchars, nbytes, multibyte;
+{
+  pdump_put_int (buffer, nchars);
+  pdump_put_int (buffer, nbytes);
+  pdump_put_byte (buffer, multibyte);
+  pdump_put_bytes (buffer, data, nbytes);
+}
+
+/* Write what is buffered in pdump_out to the file.  */
+
+static void
+pdump_flush ()
+{
+  if (pdump_out.used
+      && fwrite (pdump_out.data, 1, pdump_out.used, pdump_stream)
+	 != pdump_out.used)
+    report_file_error ("Writing dump file", Fcons (pdump_file, Qnil));
+  pdump_out.used = 0;
+}
+
+/* Return the kind of record OBJ is written as, or PDUMP_END if it
+   cannot be dumped.  OBJ is not an integer.  */
+
+static int
+pdump_object_kind (obj)
+     Lisp_Object obj;
+{
+  if (SYMBOLP (obj))
+    return PDUMP_SYMBOL;
+  if (STRINGP (obj))
+    return PDUMP_STRING;
+  if (FLOATP (obj))
+    return PDUMP_FLOAT;
+  if (CONSP (obj))
+    return PDUMP_CONS;
+  if (VECTORLIKEP (obj))
+    {
+      if (EQ (obj, initial_obarray))
+	return PDUMP_OBARRAY;
+      if (SUBRP (obj))
+	return PDUMP_SUBR;
+      if (BOOL_VECTOR_P (obj))
+	return PDUMP_BOOL_VECTOR;
+      if (HASH_TABLE_P (obj))
+	return PDUMP_HASH_TABLE;
+      if (!(XVECTOR (obj)->size & PSEUDOVECTOR_FLAG)
+	  || COMPILEDP (obj) || CHAR_TABLE_P (obj) || SUB_CHAR_TABLE_P (obj))
+	return PDUMP_VECTOR;
+    }
+  return PDUMP_END;
+}
+
+/* Write a reference to OBJ to BUFFER, adding OBJ to the objects to
+   dump if it is not there yet.  */
+
+static void
+pdump_put_ref (buffer, obj)
+     struct pdump_buffer *buffer;
+     Lisp_Object obj;
+{
+  Lisp_Object index;
+
+  if (INTEGERP (obj))
+    {
+      pdump_put_byte (buffer, PDUMP_REF_INT);
+      pdump_put_word (buffer, XINT (obj));
+      return;
+    }
+  if (EQ (obj, Qunbound))
+    {
+      pdump_put_byte (buffer, PDUMP_REF_UNBOUND);
+      return;
+    }
+  if (pdump_object_kind (obj) == PDUMP_END)
+    {
+      pdump_put_byte (buffer, PDUMP_REF_OMITTED);
+      return;
+    }
+
+  index = Fgethash (obj, pdump_index, Qnil);
+  if (NILP (index))
+    {
+      if (pdump_nobjects == pdump_objects_size)
+	{
+	  pdump_objects_size = max (2 * pdump_objects_size, 0x10000);
+	  pdump_objects = ((Lisp_Object *)
+			   xrealloc (pdump_objects,
+				     pdump_objects_size * sizeof *pdump_objects));
+	}
+      XSETFASTINT (index, pdump_nobjects);
+      pdump_objects[pdump_nobjects++] = obj;
+      Fputhash (obj, index, pdump_index);
+    }
+  pdump_put_byte (buffer, PDUMP_REF_OBJECT);
+  pdump_put_word (buffer, XFASTINT (index));
+}
+
+/* Write the value cell of symbol SYM.  */
+
+static void
+pdump_put_symbol_value (buffer, sym)
+     struct pdump_buffer *buffer;
+     Lisp_Object sym;
+{
+  struct Lisp_Symbol *s = XSYMBOL (sym);
+  int kind;
+
+  if (s->indirect_variable || !MISCP (s->value))
+    {
+      pdump_put_byte (buffer, PDUMP_VALUE_PLAIN);
+      pdump_put_ref (buffer, s->value);
+      return;
+    }
+
+  switch (XMISCTYPE (s->value))
+    {
+    case Lisp_Misc_Buffer_Local_Value:
+      kind = (XBUFFER_LOCAL_VALUE (s->value)->local_if_set
+	      ? PDUMP_VALUE_LOCAL_IF_SET : PDUMP_VALUE_LOCALIZED);
+      break;
+    case Lisp_Misc_Intfwd:
+    case Lisp_Misc_Boolfwd:
+    case Lisp_Misc_Objfwd:
+    case Lisp_Misc_Buffer_Objfwd:
+    case Lisp_Misc_Kboard_Objfwd:
+      kind = PDUMP_VALUE_FORWARDED;
+      break;
+    default:
+      pdump_put_byte (buffer, PDUMP_VALUE_PLAIN);
+      pdump_put_byte (buffer, PDUMP_REF_OMITTED);
+      return;
+    }
+
+  pdump_put_byte (buffer, kind);
+  pdump_put_ref (buffer, (NILP (Fdefault_boundp (sym))
+			  ? Qunbound : Fdefault_value (sym)));
+}
+
+/* Write the record for OBJ.  Each record is its kind, the size of
+   what follows, any data that is not a reference, and then all the
+   references, so that the loader can look at the references of any
+   record the same way.  */
+
+static void
+pdump_put_object (obj)
+     Lisp_Object obj;
+{
+  struct pdump_buffer *b = &pdump_out;
+  int kind = pdump_object_kind (obj);
+  int start, i, n;
+
+  pdump_put_byte (b, kind);
+  start = b->used;
+  pdump_put_int (b, 0);
+
+  switch (kind)
+    {
+    case PDUMP_SYMBOL:
+      {
+	struct Lisp_Symbol *s = XSYMBOL (obj);
+	Lisp_Object name = SYMBOL_NAME (obj), next;
+
+	pdump_put_byte (b, (s->interned
+			    | (s->constant ? PDUMP_SYMBOL_CONSTANT : 0)
+			    | (s->indirect_variable ? PDUMP_SYMBOL_INDIRECT : 0)
+			    | (s->declared_special ? PDUMP_SYMBOL_SPECIAL : 0)));
+	pdump_put_name (b, SDATA (name), SCHARS (name), SBYTES (name),
+			STRING_MULTIBYTE (name));
+	pdump_put_symbol_value (b, obj);
+	pdump_put_ref (b, s->function);
+	pdump_put_ref (b, s->plist);
+	/* The next symbol in the bucket of an obarray other than the
+	   initial one, which is rebuilt by interning.  */
+	if (s->interned == SYMBOL_INTERNED && s->next)
+	  {
+	    XSETSYMBOL (next, s->next);
+	    pdump_put_ref (b, next);
+	  }
+	else
+	  pdump_put_byte (b, PDUMP_REF_NONE);
+      }
+      break;
+
+    case PDUMP_STRING:
+      pdump_put_name (b, SDATA (obj), SCHARS (obj), SBYTES (obj),
+		      STRING_MULTIBYTE (obj));
+      if (STRING_INTERVALS (obj))
+	pdump_put_ref (b, text_property_list (obj, make_number (0),
+					      make_number (SCHARS (obj)),
+					      Qnil));
+      else
+	pdump_put_byte (b, PDUMP_REF_NONE);
+      break;
+
+    case PDUMP_FLOAT:
+      {
+	double d = XFLOAT_DATA (obj);
+	pdump_put_bytes (b, &d, sizeof d);
+      }
+      break;
+
+    case PDUMP_CONS:
+      pdump_put_ref (b, XCAR (obj));
+      pdump_put_ref (b, XCDR (obj));
+      break;
+
+    case PDUMP_VECTOR:
+      {
+	struct Lisp_Vector *v = XVECTOR (obj);
+
+	n = ((v->size & PSEUDOVECTOR_FLAG)
+	     ? v->size & PSEUDOVECTOR_SIZE_MASK : v->size);
+	pdump_put_word (b, v->size);
+	pdump_put_int (b, n);
+	for (i = 0; i < n; i++)
+	  pdump_put_ref (b, v->contents[i]);
+      }
+      break;
+
+    case PDUMP_BOOL_VECTOR:
+      {
+	struct Lisp_Bool_Vector *v = XBOOL_VECTOR (obj);
+
+	pdump_put_word (b, v->size);
+	pdump_put_bytes (b, v->data,
+			 (v->size + BOOL_VECTOR_BITS_PER_CHAR - 1)
+			 / BOOL_VECTOR_BITS_PER_CHAR);
+      }
+      break;
+
+    case PDUMP_HASH_TABLE:
+      {
+	struct Lisp_Hash_Table *h = XHASH_TABLE (obj);
+
+	pdump_put_int (b, h->count);
+	pdump_put_ref (b, h->test);
+	pdump_put_ref (b, h->weak);
+	pdump_put_ref (b, h->rehash_size);
+	pdump_put_ref (b, h->rehash_threshold);
+	pdump_put_ref (b, h->hash);
+	pdump_put_ref (b, h->next);
+	pdump_put_ref (b, h->next_free);
+	pdump_put_ref (b, h->index);
+	pdump_put_ref (b, h->user_hash_function);
+	pdump_put_ref (b, h->user_cmp_function);
+	pdump_put_ref (b, h->key_and_value);
+      }
+      break;
+
+    case PDUMP_SUBR:
+      {
+	char *name = XSUBR (obj)->symbol_name;
+	pdump_put_name (b, (unsigned char *) name, strlen (name), strlen (name),
+			0);
+      }
+      break;
+
+    case PDUMP_OBARRAY:
+      break;
+
+    default:
+      abort ();
+    }
+
+  n = b->used - start - sizeof n;
+  bcopy (&n, b->data + start, sizeof n);
+  if (b->used >= 0x100000)
+    pdump_flush ();
+}
+
+/* Write the C data registered with pdump_remember_scalar and by the
+   hooks.  */
+
+static void
+pdump_run_save_hooks ()
+{
+  int i, start, n;
+
+  pdump_put_int (&pdump_hook_data, pdump_nhooks);
+  for (i = 0; i < pdump_nhooks; i++)
+    {
+      start = pdump_hook_data.used;
+      pdump_put_int (&pdump_hook_data, 0);
+      pdump_target = &pdump_hook_data;
+      pdump_hooks[i].save ();
+      pdump_target = NULL;
+      n = pdump_hook_data.used - start - sizeof n;
+      bcopy (&n, pdump_hook_data.data + start, sizeof n);
+    }
+}
+
+/* Write the NBYTES bytes at DATA to the dump being written.  Only a
+   save hook registered with pdump_add_hooks may call this.  */
+
+void
+pdump_write_data (data, nbytes)
+     void *data;
+     int nbytes;
+{
+  if (!pdump_target)
+    abort ();
+  pdump_put_bytes (pdump_target, data, nbytes);
+}
+
+/* Write a reference to the Lisp object OBJ to the dump being written.
+   Only a save hook registered with pdump_add_hooks may call this.  */
+
+void
+pdump_write_object (obj)
+     Lisp_Object obj;
+{
+  if (!pdump_target)
+    abort ();
+  pdump_put_ref (pdump_target, obj);
+}
+
+static Lisp_Object
+pdump_write_unwind (arg)
+     Lisp_Object arg;
+{
+  if (pdump_stream)
+    {
+      fclose (pdump_stream);
+      pdump_stream = NULL;
+      /* A partly written dump must not be loaded.  */
+      if (NILP (arg))
+	unlink ((char *) SDATA (ENCODE_FILE (pdump_file)));
+    }
+  xfree (pdump_objects);
+  pdump_objects = NULL;
+  pdump_nobjects = pdump_objects_size = 0;
+  xfree (pdump_out.data);
+  xfree (pdump_hook_data.data);
+  bzero (&pdump_out, sizeof pdump_out);
+  bzero (&pdump_hook_data, sizeof pdump_hook_data);
+  pdump_target = NULL;
+  pdump_index = Qnil;
+  pdump_file = Qnil;
+  return Qnil;
+}
+
+DEFUN ("dump-emacs-portable", Fdump_emacs_portable, Sdump_emacs_portable,
+       1, 1, 0,
+       doc: /* Dump the Lisp state of Emacs into the portable dump file FILENAME.
+This writes the functions, variables and other Lisp objects reachable
+from the symbols of the obarray and from the variables of Emacs itself
+to FILENAME.  Emacs loads such a file at startup instead of loading
+`loadup.el' when it has not been dumped with `dump-emacs'; see the
+`--dump-file' command line option.  Buffers, markers, windows, frames
+and processes are not saved, nor is anything referring to them.
+
+The file can only be loaded by the same executable that wrote it.
+
+This is used in the file `loadup.el' when building Emacs, but it can
+also be called after loading more packages, to make them part of the
+dump.  You must run Emacs in batch mode in order to dump it.  */)
+     (filename)
+     Lisp_Object filename;
+{
+  int count = SPECPDL_INDEX ();
+  struct pdump_header header;
+  Lisp_Object encoded;
+  int i;
+
+  if (! noninteractive)
+    error ("Dumping Emacs works only in batch mode");
+
+  CHECK_STRING (filename);
+  filename = Fexpand_file_name (filename, Qnil);
+
+  /* Bind `command-line-processed' to nil before dumping,
+     so that the Emacs loading the dump will process its command line.  */
+  specbind (intern ("command-line-processed"), Qnil);
+  Vpurify_flag = Qnil;
+
+  Fgarbage_collect ();
+  inhibit_garbage_collection ();
+
+  encoded = ENCODE_FILE (filename);
+  pdump_file = filename;
+  record_unwind_protect (pdump_write_unwind, Qnil);
+  pdump_stream = fopen ((char *) SDATA (encoded), "wb");
+  if (!pdump_stream)
+    report_file_error ("Opening dump file", Fcons (filename, Qnil));
+
+  {
+    Lisp_Object args[2];
+    args[0] = QCtest;
+    args[1] = Qeq;
+    pdump_index = Fmake_hash_table (2, args);
+  }
+
+  bzero (&header, sizeof header);
+  bcopy (pdump_magic, header.magic, sizeof header.magic);
+  header.version = PDUMP_VERSION;
+  header.word_size = sizeof (EMACS_INT);
+  header.double_size = sizeof (double);
+  pdump_put_bytes (&pdump_out, &header, sizeof header);
+
+  /* Find the roots first, so that the objects of Emacs come before
+     those only reachable through symbols of later packages.  The
+     references written while doing so are not needed.  */
+  for (i = 0; i < staticidx; i++)
+    {
+      pdump_put_ref (&pdump_hook_data, *staticvec[i]);
+      pdump_hook_data.used = 0;
+    }
+  for (i = 0; i < ASIZE (initial_obarray); i++)
+    {
+      Lisp_Object bucket = AREF (initial_obarray, i), sym;
+      struct Lisp_Symbol *s;
+
+      if (SYMBOLP (bucket))
+	for (s = XSYMBOL (bucket); s; s = s->next)
+	  {
+	    XSETSYMBOL (sym, s);
+	    pdump_put_ref (&pdump_hook_data, sym);
+	    pdump_hook_data.used = 0;
+	  }
+    }
+  pdump_run_save_hooks ();
+
+  /* Writing a record finds the objects it refers to, so this loop
+     ends when everything reachable has been written.  */
+  for (i = 0; i < pdump_nobjects; i++)
+    pdump_put_object (pdump_objects[i]);
+  pdump_put_byte (&pdump_out, PDUMP_END);
+
+  /* The roots.  Their addresses relative to the first one identify
+     the executable that wrote the dump.  */
+  pdump_put_int (&pdump_out, staticidx);
+  for (i = 0; i < staticidx; i++)
+    {
+      pdump_put_word (&pdump_out,
+		      (char *) staticvec[i] - (char *) staticvec[0]);
+      pdump_put_ref (&pdump_out, *staticvec[i]);
+    }
+
+  pdump_put_int (&pdump_out, pdump_nscalars);
+  for (i = 0; i < pdump_nscalars; i++)
+    {
+      pdump_put_int (&pdump_out, pdump_scalars[i].size);
+      pdump_put_bytes (&pdump_out, pdump_scalars[i].address,
+		       pdump_scalars[i].size);
+    }
+
+  pdump_put_bytes (&pdump_out, pdump_hook_data.data, pdump_hook_data.used);
+  pdump_put_bytes (&pdump_out, pdump_magic, sizeof pdump_magic);
+  pdump_flush ();
+
+  if (fclose (pdump_stream) != 0)
+    {
+      pdump_stream = NULL;
+      report_file_error ("Writing dump file", Fcons (filename, Qnil));
+    }
+  pdump_stream = NULL;
+
+  return unbind_to (count, Qnil);
+}
+
+
+/***********************************************************************
+			     Loading a dump
+ ***********************************************************************/
+
+/* The contents of the file being loaded.  */
+
+static unsigned char *pdump_base;
+static size_t pdump_size;
+static int pdump_mapped;
+
+/* Where the next read happens, and the end of what may be read.
+   pdump_bad is set by any read beyond the end.  */
+
+static unsigned char *pdump_pos, *pdump_end;
+static int pdump_bad;
+
+/* The number of records, their starts and kinds, and the object made
+   for each.  */
+
+static int pdump_count;
+static unsigned char **pdump_records;
+static unsigned char *pdump_kinds;
+static Lisp_Object *pdump_made;
+
+/* Non-zero for each record that is omitted, because it refers to
+   something that cannot be dumped.  */
+
+static char *pdump_omitted;
+
+/* Non-zero for each record whose object already existed.  */
+
+static char *pdump_adopted;
+
+struct pdump_ref
+{
+  int tag;
+  EMACS_INT value;
+};
+
+struct pdump_name
+{
+  unsigned char *data;
+  int nchars, nbytes, multibyte;
+};
+
+/* What precedes the references of a record.  */
+
+struct pdump_record
+{
+  int kind;
+  int flags, value_kind;
+  struct pdump_name name;
+  double number;
+  EMACS_UINT header;
+  int count;
+
+  /* The number of references, which are at pdump_pos.  */
+  int nrefs;
+};
+
+static void
+pdump_get_bytes (data, nbytes)
+     void *data;
+     int nbytes;
+{
+  if (nbytes < 0 || pdump_end - pdump_pos < nbytes)
+    {
+      pdump_bad = 1;
+      bzero (data, max (nbytes, 0));
+      pdump_pos = pdump_end;
+      return;
+    }
+  bcopy (pdump_pos, data, nbytes);
+  pdump_pos += nbytes;
+}
+
+static int
+pdump_get_byte ()
+{
+  if (pdump_pos >= pdump_end)
+    {
+      pdump_bad = 1;
+      return 0;
+    }
+  return *pdump_pos++;
+}
+
+static int
+pdump_get_int ()
+{
+  int i;
+  pdump_get_bytes (&i, sizeof i);
+  return i;
+}
+
+static EMACS_INT
+pdump_get_word ()
+{
+  EMACS_INT w;
+  pdump_get_bytes (&w, sizeof w);
+  return w;
+}
+
+static void
+pdump_get_name (name)
+     struct pdump_name *name;
+{
+  name->nchars = pdump_get_int ();
+  name->nbytes = pdump_get_int ();
+  name->multibyte = pdump_get_byte ();
+  name->data = pdump_pos;
+  if (name->nchars < 0 || name->nchars > name->nbytes
+      || pdump_end - pdump_pos < name->nbytes)
+    {
+      pdump_bad = 1;
+      name->nchars = name->nbytes = 0;
+      pdump_pos = pdump_end;
+    }
+  else
+    pdump_pos += name->nbytes;
+}
+
+static void
+pdump_get_ref (ref)
+     struct pdump_ref *ref;
+{
+  ref->tag = pdump_get_byte ();
+  ref->value = 0;
+  switch (ref->tag)
+    {
+    case PDUMP_REF_INT:
+      ref->value = pdump_get_word ();
+      break;
+    case PDUMP_REF_OBJECT:
+      ref->value = pdump_get_word ();
+      if (ref->value < 0 || ref->value >= pdump_count)
+	{
+	  pdump_bad = 1;
+	  ref->tag = PDUMP_REF_OMITTED;
+	}
+      break;
+    case PDUMP_REF_NONE:
+    case PDUMP_REF_UNBOUND:
+    case PDUMP_REF_OMITTED:
+      break;
+    default:
+      pdump_bad = 1;
+      ref->tag = PDUMP_REF_OMITTED;
+    }
+}
+
+/* Read what precedes the references of record I into R, and leave
+   pdump_pos at the first reference.  */
+
+static void
+pdump_get_record (i, r)
+     int i;
+     struct pdump_record *r;
+{
+  int size;
+
+  pdump_pos = pdump_records[i] + 1;
+  size = pdump_get_int ();
+  pdump_end = pdump_pos + size;
+  r->kind = pdump_kinds[i];
+  r->nrefs = 0;
+
+  switch (r->kind)
+    {
+    case PDUMP_SYMBOL:
+      r->flags = pdump_get_byte ();
+      pdump_get_name (&r->name);
+      r->value_kind = pdump_get_byte ();
+      r->nrefs = 4;
+      break;
+    case PDUMP_STRING:
+      pdump_get_name (&r->name);
+      r->nrefs = 1;
+      break;
+    case PDUMP_FLOAT:
+      pdump_get_bytes (&r->number, sizeof r->number);
+      break;
+    case PDUMP_CONS:
+      r->nrefs = 2;
+      break;
+    case PDUMP_VECTOR:
+      r->header = pdump_get_word ();
+      r->nrefs = pdump_get_int ();
+      if (r->nrefs < 0)
+	pdump_bad = 1, r->nrefs = 0;
+      break;
+    case PDUMP_BOOL_VECTOR:
+      r->header = pdump_get_word ();
+      r->name.data = pdump_pos;
+      r->name.nbytes = ((r->header + BOOL_VECTOR_BITS_PER_CHAR - 1)
+			/ BOOL_VECTOR_BITS_PER_CHAR);
+      if (pdump_end - pdump_pos < r->name.nbytes)
+	pdump_bad = 1, pdump_pos = pdump_end;
+      else
+	pdump_pos += r->name.nbytes;
+      break;
+    case PDUMP_HASH_TABLE:
+      r->count = pdump_get_int ();
+      r->nrefs = 11;
+      break;
+    case PDUMP_SUBR:
+      pdump_get_name (&r->name);
+      break;
+    }
+}
+
+/* Return the object REF refers to.  */
+
+static Lisp_Object
+pdump_value (ref)
+     struct pdump_ref *ref;
+{
+  switch (ref->tag)
+    {
+    case PDUMP_REF_INT:
+      return make_number (ref->value);
+    case PDUMP_REF_OBJECT:
+      return pdump_made[ref->value];
+    case PDUMP_REF_UNBOUND:
+      return Qunbound;
+    default:
+      return Qnil;
+    }
+}
+
+/* Return non-zero if REF refers to something that is not loaded.  */
+
+static int
+pdump_ref_omitted (ref)
+     struct pdump_ref *ref;
+{
+  return (ref->tag == PDUMP_REF_OMITTED
+	  || (ref->tag == PDUMP_REF_OBJECT && pdump_omitted[ref->value]));
+}
+
+/* Find the records, check that every reference is valid, and find
+   out which records are omitted.  A record is omitted if one of its
+   references is, except for symbols.  Return non-zero if the file
+   is well formed.  */
+
+static int
+pdump_scan ()
+{
+  struct pdump_record r;
+  struct pdump_ref ref;
+  unsigned char *p = pdump_pos, *after, *end = pdump_end;
+  int *nreferrers, *referrers, *start, *queue;
+  int i, j, head, tail, total;
+
+  /* Find the records.  */
+  for (pdump_count = 0; p < pdump_end && *p != PDUMP_END; pdump_count++)
+    {
+      int size;
+
+      if (*p > PDUMP_OBARRAY || pdump_end - p < 1 + (int) sizeof size)
+	return 0;
+      bcopy (p + 1, &size, sizeof size);
+      if (size < 0 || pdump_end - p - 1 - (int) sizeof size < size)
+	return 0;
+      p += 1 + sizeof size + size;
+    }
+  if (p >= pdump_end)
+    return 0;
+  after = p + 1;
+
+  pdump_records = (unsigned char **) xmalloc ((pdump_count + 1)
+					     * sizeof *pdump_records);
+  pdump_kinds = (unsigned char *) xmalloc (pdump_count + 1);
+  pdump_omitted = (char *) xmalloc (pdump_count + 1);
+  pdump_adopted = (char *) xmalloc (pdump_count + 1);
+  bzero (pdump_omitted, pdump_count + 1);
+  bzero (pdump_adopted, pdump_count + 1);
+
+  for (p = pdump_pos, i = 0; i < pdump_count; i++)
+    {
+      int size;
+
+      pdump_records[i] = p;
+      pdump_kinds[i] = *p;
+      bcopy (p + 1, &size, sizeof size);
+      p += 1 + sizeof size + size;
+    }
+
+  /* Count the referrers of each record, and queue the records
+     referring to something that cannot be dumped.  */
+  nreferrers = (int *) xmalloc ((pdump_count + 1) * sizeof (int));
+  queue = (int *) xmalloc ((pdump_count + 1) * sizeof (int));
+  bzero (nreferrers, (pdump_count + 1) * sizeof (int));
+  total = tail = 0;
+  for (i = 0; i < pdump_count; i++)
+    {
+      pdump_get_record (i, &r);
+      for (j = 0; j < r.nrefs; j++)
+	{
+	  pdump_get_ref (&ref);
+	  if (ref.tag == PDUMP_REF_OBJECT)
+	    nreferrers[ref.value]++, total++;
+	  else if (ref.tag == PDUMP_REF_OMITTED
+		   && r.kind != PDUMP_SYMBOL && !pdump_omitted[i])
+	    pdump_omitted[i] = 1, queue[tail++] = i;
+	}
+      if (pdump_pos != pdump_end)
+	pdump_bad = 1;
+      pdump_end = end;
+      if (pdump_bad)
+	break;
+    }
+
+  pdump_pos = after;
+  if (pdump_bad)
+    {
+      xfree (nreferrers);
+      xfree (queue);
+      return 0;
+    }
+
+  /* Make a table of the referrers of each record, and from it the
+     records that refer to omitted ones, transitively.  */
+  start = (int *) xmalloc ((pdump_count + 1) * sizeof (int));
+  referrers = (int *) xmalloc ((total + 1) * sizeof (int));
+  for (i = 0, j = 0; i < pdump_count; i++)
+    {
+      start[i] = j;
+      j += nreferrers[i];
+      nreferrers[i] = 0;
+    }
+  start[pdump_count] = j;
+  for (i = 0; i < pdump_count; i++)
+    {
+      pdump_get_record (i, &r);
+      if (r.kind != PDUMP_SYMBOL)
+	for (j = 0; j < r.nrefs; j++)
+	  {
+	    pdump_get_ref (&ref);
+	    if (ref.tag == PDUMP_REF_OBJECT)
+	      referrers[start[ref.value] + nreferrers[ref.value]++] = i;
+	  }
+      pdump_end = end;
+    }
+  pdump_pos = after;
+
+  for (head = 0; head < tail; head++)
+    {
+      int k = queue[head];
+
+      for (j = start[k]; j < start[k] + nreferrers[k]; j++)
+	if (!pdump_omitted[referrers[j]])
+	  {
+	    pdump_omitted[referrers[j]] = 1;
+	    queue[tail++] = referrers[j];
+	  }
+    }
+
+  xfree (start);
+  xfree (referrers);
+  xfree (nreferrers);
+  xfree (queue);
+  return 1;
+}
+
+/* Return non-zero if the object FRESH, which the Emacs starting made
+   for a root, can be reused for record I of the dump, so that the C
+   code holding on to it sees the dumped contents.  */
+
+static int
+pdump_adoptable (i, fresh)
+     int i;
+     Lisp_Object fresh;
+{
+  struct pdump_record r;
+  unsigned char *end = pdump_end;
+  int ok = 0;
+
+  pdump_get_record (i, &r);
+  pdump_end = end;
+  switch (r.kind)
+    {
+    case PDUMP_CONS:
+      ok = CONSP (fresh);
+      break;
+    case PDUMP_VECTOR:
+      ok = (VECTORLIKEP (fresh) && XVECTOR (fresh)->size == r.header
+	    && !EQ (fresh, initial_obarray));
+      break;
+    case PDUMP_SYMBOL:
+      ok = (SYMBOLP (fresh) && !SYMBOL_INTERNED_P (fresh)
+	    && (r.flags & PDUMP_SYMBOL_INTERNED_MASK) == SYMBOL_UNINTERNED);
+      break;
+    }
+  return ok;
+}
+
+/* Make the object for record I, or for containers, an empty object
+   of the right size, unless the object already exists.  */
+
+static void
+pdump_make_object (i, containers)
+     int i, containers;
+{
+  struct pdump_record r;
+  unsigned char *end = pdump_end;
+  Lisp_Object obj = Qnil;
+
+  if (pdump_omitted[i] || pdump_adopted[i])
+    return;
+  if (containers != (pdump_kinds[i] == PDUMP_CONS
+		     || pdump_kinds[i] == PDUMP_VECTOR
+		     || pdump_kinds[i] == PDUMP_HASH_TABLE))
+    return;
+
+  pdump_get_record (i, &r);
+  switch (r.kind)
+    {
+    case PDUMP_SYMBOL:
+      {
+	int initial = ((r.flags & PDUMP_SYMBOL_INTERNED_MASK)
+		       == SYMBOL_INTERNED_IN_INITIAL_OBARRAY);
+
+	if (initial)
+	  obj = oblookup (initial_obarray, (char *) r.name.data,
+			  r.name.nchars, r.name.nbytes);
+	if (!initial || !SYMBOLP (obj))
+	  {
+	    Lisp_Object name
+	      = make_specified_string ((char *) r.name.data, r.name.nchars,
+				       r.name.nbytes, r.name.multibyte);
+
+	    obj = initial ? Fintern (name, initial_obarray) : Fmake_symbol (name);
+	  }
+      }
+      break;
+
+    case PDUMP_STRING:
+      obj = make_specified_string ((char *) r.name.data, r.name.nchars,
+				   r.name.nbytes, r.name.multibyte);
+      break;
+
+    case PDUMP_FLOAT:
+      obj = make_float (r.number);
+      break;
+
+    case PDUMP_BOOL_VECTOR:
+      obj = Fmake_bool_vector (make_number (r.header), Qnil);
+      bcopy (r.name.data, XBOOL_VECTOR (obj)->data, r.name.nbytes);
+      break;
+
+    case PDUMP_SUBR:
+      obj = oblookup (initial_obarray, (char *) r.name.data, r.name.nchars,
+		      r.name.nbytes);
+      if (SYMBOLP (obj))
+	obj = XSYMBOL (obj)->function;
+      if (!SUBRP (obj))
+	fatal ("Unknown primitive `%.*s' in dump file",
+	       r.name.nbytes, r.name.data);
+      break;
+
+    case PDUMP_OBARRAY:
+      obj = initial_obarray;
+      break;
+
+    case PDUMP_CONS:
+      obj = Fcons (Qnil, Qnil);
+      break;
+
+    case PDUMP_VECTOR:
+      {
+	struct Lisp_Vector *v = allocate_vector (r.nrefs);
+	int j;
+
+	for (j = 0; j < r.nrefs; j++)
+	  v->contents[j] = Qnil;
+	v->size = r.header;
+	XSETVECTOR (obj, v);
+      }
+      break;
+
+    case PDUMP_HASH_TABLE:
+      {
+	struct pdump_ref test, weak, rehash_size, rehash_threshold;
+
+	pdump_get_ref (&test);
+	pdump_get_ref (&weak);
+	pdump_get_ref (&rehash_size);
+	pdump_get_ref (&rehash_threshold);
+	obj = make_hash_table (pdump_value (&test), make_number (1),
+			       pdump_value (&rehash_size),
+			       pdump_value (&rehash_threshold),
+			       pdump_value (&weak), Qnil, Qnil);
+      }
+      break;
+    }
+
+  pdump_made[i] = obj;
+  pdump_end = end;
+}
+
+/* Fill in the references of the object made for record I, except for
+   symbol values, which need everything else in place.  */
+
+static void
+pdump_fill_object (i)
+     int i;
+{
+  struct pdump_record r;
+  struct pdump_ref ref, refs[11];
+  unsigned char *end = pdump_end;
+  Lisp_Object obj = pdump_made[i];
+  int j;
+
+  if (pdump_omitted[i])
+    return;
+
+  pdump_get_record (i, &r);
+  switch (r.kind)
+    {
+    case PDUMP_SYMBOL:
+      {
+	struct Lisp_Symbol *s = XSYMBOL (obj);
+
+	pdump_get_ref (&ref);	/* The value.  */
+	pdump_get_ref (&ref);
+	if (!pdump_ref_omitted (&ref))
+	  s->function = pdump_value (&ref);
+	pdump_get_ref (&ref);
+	if (!pdump_ref_omitted (&ref))
+	  s->plist = pdump_value (&ref);
+	pdump_get_ref (&ref);
+	if ((r.flags & PDUMP_SYMBOL_INTERNED_MASK) == SYMBOL_INTERNED)
+	  {
+	    s->interned = SYMBOL_INTERNED;
+	    s->next = (ref.tag == PDUMP_REF_OBJECT
+		       ? XSYMBOL (pdump_made[ref.value]) : NULL);
+	  }
+	s->constant = (r.flags & PDUMP_SYMBOL_CONSTANT) != 0;
+	s->declared_special = (r.flags & PDUMP_SYMBOL_SPECIAL) != 0;
+      }
+      break;
+
+    case PDUMP_CONS:
+      pdump_get_ref (&ref);
+      XSETCAR (obj, pdump_value (&ref));
+      pdump_get_ref (&ref);
+      XSETCDR (obj, pdump_value (&ref));
+      break;
+
+    case PDUMP_VECTOR:
+      for (j = 0; j < r.nrefs; j++)
+	{
+	  pdump_get_ref (&ref);
+	  XVECTOR (obj)->contents[j] = pdump_value (&ref);
+	}
+      break;
+
+    case PDUMP_HASH_TABLE:
+      {
+	struct Lisp_Hash_Table *h = XHASH_TABLE (obj);
+
+	for (j = 0; j < 11; j++)
+	  pdump_get_ref (&refs[j]);
+	h->hash = pdump_value (&refs[4]);
+	h->next = pdump_value (&refs[5]);
+	h->next_free = pdump_value (&refs[6]);
+	h->index = pdump_value (&refs[7]);
+	h->user_hash_function = pdump_value (&refs[8]);
+	h->user_cmp_function = pdump_value (&refs[9]);
+	h->key_and_value = pdump_value (&refs[10]);
+	h->count = r.count;
+      }
+      break;
+    }
+
+  pdump_end = end;
+}
+
+/* Compute the hash codes of hash table H again, since those of
+   objects hashed by address have changed.  The entries stay where
+   they are, so that C code that knows their indices, like that of
+   the charsets and coding systems, still finds them.  */
+
+static void
+pdump_rehash (h)
+     struct Lisp_Hash_Table *h;
+{
+  int size = HASH_TABLE_SIZE (h), index_size = ASIZE (h->index);
+  int i;
+
+  for (i = 0; i < index_size; i++)
+    HASH_INDEX (h, i) = Qnil;
+  for (i = 0; i < size; i++)
+    if (!NILP (HASH_HASH (h, i)))
+      {
+	unsigned hash = h->hashfn (h, HASH_KEY (h, i));
+	int start = hash % index_size;
+
+	HASH_HASH (h, i) = make_number (hash);
+	HASH_NEXT (h, i) = HASH_INDEX (h, start);
+	HASH_INDEX (h, start) = make_number (i);
+      }
+}
+
+static Lisp_Object
+pdump_ignore_error (error)
+     Lisp_Object error;
+{
+  return Qnil;
+}
+
+static Lisp_Object
+pdump_set_default (arg)
+     Lisp_Object arg;
+{
+  return Fset_default (XCAR (arg), XCDR (arg));
+}
+
+static Lisp_Object
+pdump_make_local (sym)
+     Lisp_Object sym;
+{
+  return Fmake_variable_buffer_local (sym);
+}
+
+/* Set the value of the symbol made for record I, and restore what
+   else needs the objects to be complete.  */
+
+static void
+pdump_finish_object (i)
+     int i;
+{
+  struct pdump_record r;
+  struct pdump_ref ref;
+  unsigned char *end = pdump_end;
+  Lisp_Object obj = pdump_made[i], value;
+
+  if (pdump_omitted[i])
+    return;
+
+  pdump_get_record (i, &r);
+  switch (r.kind)
+    {
+    case PDUMP_SYMBOL:
+      pdump_get_ref (&ref);
+      if (pdump_ref_omitted (&ref))
+	break;
+      value = pdump_value (&ref);
+      if (r.value_kind == PDUMP_VALUE_PLAIN && !MISCP (XSYMBOL (obj)->value))
+	{
+	  XSYMBOL (obj)->value = value;
+	  XSYMBOL (obj)->indirect_variable
+	    = (r.flags & PDUMP_SYMBOL_INDIRECT) != 0;
+	  break;
+	}
+      if (r.value_kind == PDUMP_VALUE_LOCAL_IF_SET)
+	internal_condition_case_1 (pdump_make_local, obj,
+				   Qerror, pdump_ignore_error);
+      if (!EQ (value, Qunbound))
+	internal_condition_case_1 (pdump_set_default, Fcons (obj, value),
+				   Qerror, pdump_ignore_error);
+      break;
+
+    case PDUMP_STRING:
+      pdump_get_ref (&ref);
+      if (ref.tag == PDUMP_REF_OBJECT)
+	add_text_properties_from_list (obj, pdump_value (&ref),
+				       make_number (0));
+      break;
+
+    case PDUMP_HASH_TABLE:
+      pdump_rehash (XHASH_TABLE (obj));
+      break;
+    }
+
+  pdump_end = end;
+}
+
+/* The end of the data of the hook being loaded.  */
+
+static unsigned char *pdump_hook_end;
+
+/* Read NBYTES bytes into DATA from the dump being loaded.  Only a
+   load hook registered with pdump_add_hooks may call this.  */
+
+void
+pdump_read_data (data, nbytes)
+     void *data;
+     int nbytes;
+{
+  if (!pdump_hook_end)
+    abort ();
+  pdump_end = pdump_hook_end;
+  pdump_get_bytes (data, nbytes);
+  if (pdump_bad)
+    fatal ("Corrupt data in dump file");
+}
+
+/* Read a reference written with pdump_write_object, and store the
+   object into *OBJ.  Return zero, leaving *OBJ alone, if the object
+   was omitted.  Only a load hook registered with pdump_add_hooks may
+   call this.  */
+
+int
+pdump_read_object (obj)
+     Lisp_Object *obj;
+{
+  struct pdump_ref ref;
+
+  if (!pdump_hook_end)
+    abort ();
+  pdump_end = pdump_hook_end;
+  pdump_get_ref (&ref);
+  if (pdump_bad)
+    fatal ("Corrupt data in dump file");
+  if (pdump_ref_omitted (&ref))
+    return 0;
+  *obj = pdump_value (&ref);
+  return 1;
+}
+
+static void
+pdump_unmap ()
+{
+#ifdef HAVE_MMAP
+  if (pdump_mapped)
+    munmap (pdump_base, pdump_size);
+  else
+#endif
+    xfree (pdump_base);
+  pdump_base = NULL;
+}
+
+/* Read the file named FILE into pdump_base.  Return an error message,
+   or null.  */
+
+static char *
+pdump_map_file (file)
+     char *file;
+{
+  struct stat st;
+  int fd = emacs_open (file, O_RDONLY | O_BINARY, 0);
+
+  if (fd < 0)
+    return emacs_strerror (errno);
+  if (fstat (fd, &st) < 0 || st.st_size < sizeof (struct pdump_header))
+    {
+      emacs_close (fd);
+      return "Not a dump file";
+    }
+  pdump_size = st.st_size;
+  pdump_mapped = 0;
+
+#ifdef HAVE_MMAP
+  pdump_base = (unsigned char *) mmap (NULL, pdump_size, PROT_READ,
+				       MAP_PRIVATE, fd, 0);
+  if (pdump_base != (unsigned char *) MAP_FAILED)
+    pdump_mapped = 1;
+  else
+#endif
+    {
+      size_t done = 0;
+
+      pdump_base = (unsigned char *) xmalloc (pdump_size);
+      while (done < pdump_size)
+	{
+	  int n = emacs_read (fd, (char *) pdump_base + done, pdump_size - done);
+	  if (n <= 0)
+	    {
+	      emacs_close (fd);
+	      xfree (pdump_base);
+	      pdump_base = NULL;
+	      return "Cannot read dump file";
+	    }
+	  done += n;
+	}
+    }
+
+  emacs_close (fd);
+  return NULL;
+}
+
+/* Load the dump file named FILE into the Emacs starting.  This is
+   called after all the syms_of functions have run, before any Lisp
+   code.  Return an error message if FILE cannot be loaded; that can
+   only happen before anything was changed.  */
+
+char *
+pdump_load (file)
+     char *file;
+{
+  struct pdump_header header;
+  struct pdump_ref ref;
+  unsigned char *roots, *scalars, *hooks;
+  int count = SPECPDL_INDEX ();
+  int nroots, i, n, nadopted, *adopted;
+  char *error;
+
+  error = pdump_map_file (file);
+  if (error)
+    return error;
+
+  pdump_pos = pdump_base;
+  pdump_end = pdump_base + pdump_size;
+  pdump_bad = 0;
+  pdump_get_bytes (&header, sizeof header);
+  if (bcmp (header.magic, pdump_magic, sizeof pdump_magic)
+      || header.version != PDUMP_VERSION
+      || header.word_size != sizeof (EMACS_INT)
+      || header.double_size != sizeof (double))
+    {
+      pdump_unmap ();
+      return "Not a dump file for this version of Emacs";
+    }
+
+  if (!pdump_scan ())
+    {
+      error = "Dump file is corrupt";
+      goto fail;
+    }
+
+  /* Check that the roots are where this executable has them, and
+     that the C data has the same layout.  */
+  pdump_end = pdump_base + pdump_size;
+  nroots = pdump_get_int ();
+  roots = pdump_pos;
+  if (nroots < staticidx)
+    goto mismatch;
+  for (i = 0; i < nroots; i++)
+    {
+      EMACS_INT offset = pdump_get_word ();
+
+      if (i < staticidx
+	  && offset != (char *) staticvec[i] - (char *) staticvec[0])
+	goto mismatch;
+      pdump_get_ref (&ref);
+    }
+
+  scalars = pdump_pos;
+  if (pdump_get_int () != pdump_nscalars)
+    goto mismatch;
+  for (i = 0; i < pdump_nscalars; i++)
+    {
+      if (pdump_get_int () != pdump_scalars[i].size)
+	goto mismatch;
+      pdump_pos += min (pdump_scalars[i].size, pdump_end - pdump_pos);
+    }
+
+  hooks = pdump_pos;
+  if (pdump_get_int () != pdump_nhooks)
+    goto mismatch;
+  for (i = 0; i < pdump_nhooks; i++)
+    {
+      n = pdump_get_int ();
+      if (n < 0 || pdump_end - pdump_pos < n)
+	pdump_bad = 1;
+      else
+	pdump_pos += n;
+    }
+  if (pdump_end - pdump_pos != sizeof pdump_magic
+      || bcmp (pdump_pos, pdump_magic, sizeof pdump_magic))
+    pdump_bad = 1;
+  if (pdump_bad)
+    {
+      error = "Dump file is corrupt";
+      goto fail;
+    }
+
+  /* From here on, the Emacs starting is changed.  */
+  inhibit_garbage_collection ();
+
+  pdump_made = (Lisp_Object *) xmalloc ((pdump_count + 1)
+					* sizeof (Lisp_Object));
+  for (i = 0; i < pdump_count; i++)
+    pdump_made[i] = Qnil;
+
+  /* Reuse the objects the roots of this Emacs already have, wherever
+     the dump has one of the same shape for them.  An object is reused
+     only once, for two roots that had it may no longer share it.  */
+  adopted = (int *) xmalloc ((staticidx + 1) * sizeof (int));
+  nadopted = 0;
+  pdump_pos = roots;
+  pdump_end = scalars;
+  for (i = 0; i < staticidx; i++)
+    {
+      pdump_get_word ();
+      pdump_get_ref (&ref);
+      if (ref.tag == PDUMP_REF_OBJECT
+	  && !pdump_omitted[ref.value] && !pdump_adopted[ref.value])
+	{
+	  unsigned char *pos = pdump_pos, *end = pdump_end;
+	  int k;
+
+	  for (k = 0; k < nadopted; k++)
+	    if (EQ (pdump_made[adopted[k]], *staticvec[i]))
+	      break;
+	  if (k == nadopted && pdump_adoptable (ref.value, *staticvec[i]))
+	    {
+	      pdump_made[ref.value] = *staticvec[i];
+	      pdump_adopted[ref.value] = 1;
+	      adopted[nadopted++] = ref.value;
+	    }
+	  pdump_pos = pos, pdump_end = end;
+	}
+    }
+  xfree (adopted);
+
+  /* Make the objects whose contents are not references first, so that
+     hash tables can be made with their test and sizes.  */
+  for (i = 0; i < pdump_count; i++)
+    pdump_make_object (i, 0);
+  for (i = 0; i < pdump_count; i++)
+    pdump_make_object (i, 1);
+  for (i = 0; i < pdump_count; i++)
+    pdump_fill_object (i);
+  for (i = 0; i < pdump_count; i++)
+    pdump_finish_object (i);
+
+  pdump_pos = roots;
+  pdump_end = scalars;
+  for (i = 0; i < staticidx; i++)
+    {
+      pdump_get_word ();
+      pdump_get_ref (&ref);
+      if (!pdump_ref_omitted (&ref))
+	*staticvec[i] = pdump_value (&ref);
+    }
+
+  pdump_pos = scalars + sizeof (int);
+  pdump_end = hooks;
+  for (i = 0; i < pdump_nscalars; i++)
+    {
+      pdump_get_int ();
+      pdump_get_bytes (pdump_scalars[i].address, pdump_scalars[i].size);
+    }
+
+  pdump_pos = hooks + sizeof (int);
+  for (i = 0; i < pdump_nhooks; i++)
+    {
+      pdump_end = pdump_base + pdump_size;
+      n = pdump_get_int ();
+      pdump_hook_end = pdump_pos + n;
+      pdump_hooks[i].load ();
+      pdump_pos = pdump_hook_end;
+    }
+  pdump_hook_end = NULL;
+
+  Vportable_dump_file_name = build_string (file);
+  error = NULL;
+  unbind_to (count, Qnil);
+  goto done;
+
+ mismatch:
+  error = "Dump file was not written by this Emacs executable";
+ fail:
+  ;
+ done:
+  xfree (pdump_records);
+  xfree (pdump_kinds);
+  xfree (pdump_omitted);
+  xfree (pdump_adopted);
+  xfree (pdump_made);
+  pdump_records = NULL;
+  pdump_kinds = NULL;
+  pdump_omitted = pdump_adopted = NULL;
+  pdump_made = NULL;
+  pdump_unmap ();
+  return error;
+}
+
+static Lisp_Object
+pdump_snarf_documentation (file)
+     Lisp_Object file;
+{
+  return Fsnarf_documentation (file);
+}
+
+/* Finish loading a dump, once the directories of this Emacs are
+   known.  The documentation of subrs is not part of the dump, so
+   find it in the DOC file again.  */
+
+void
+pdump_after_load ()
+{
+  if (STRINGP (Vdoc_file_name))
+    internal_condition_case_1 (pdump_snarf_documentation, Vdoc_file_name,
+			       Qerror, pdump_ignore_error);
+}
+
+/* Return the name of the dump file to load at startup if none was
+   given on the command line, or nil if there is none.  It is NAME.pdmp
+   in the directory of the executable, for an executable named NAME,
+   or else emacs.pdmp in `exec-directory'.  */
+
+Lisp_Object
+pdump_default_file ()
+{
+  Lisp_Object file;
+
+  if (STRINGP (Vinvocation_directory) && STRINGP (Vinvocation_name))
+    {
+      file = concat3 (Vinvocation_directory, Vinvocation_name,
+		      build_string (".pdmp"));
+      if (access ((char *) SDATA (ENCODE_FILE (file)), R_OK) == 0)
+	return file;
+    }
+  if (STRINGP (Vexec_directory))
+    {
+      file = concat2 (Vexec_directory, build_string ("emacs.pdmp"));
+      if (access ((char *) SDATA (ENCODE_FILE (file)), R_OK) == 0)
+	return file;
+    }
+  return Qnil;
+}
+
+void
+syms_of_pdump ()
+{
+  /* pdump_index and pdump_file are not staticpro'd, or they would be
+     dumped; garbage collection is inhibited while they are used.  */
+  pdump_index = Qnil;
+  pdump_file = Qnil;
+
+  defsubr (&Sdump_emacs_portable);
+
+  DEFVAR_LISP ("portable-dump-file-name", &Vportable_dump_file_name,
+	       doc: /* The name of the dump file Emacs loaded at startup, or nil.
+See `dump-emacs-portable'.  */);
+  Vportable_dump_file_name = Qnil;
+}
+
+/* arch-tag: 5b0e7d1c-3f2a-4e86-9c41-a7d3e8f06b25
+   (do not change this comment) */
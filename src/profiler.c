@@ -0,0 +1,532 @@
+/* Sampling profiler for Lisp code.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+This file is part of GNU Emacs.
+
+GNU Emacs is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+GNU Emacs is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <signal.h>
+#include <setjmp.h>
+#include "lisp.h"
+#include "syssignal.h"
+
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+/* The CPU profiler needs an interval timer that counts the CPU time
+   of the process.  */
+
+#if defined (SIGPROF) && defined (HAVE_SETITIMER) && defined (ITIMER_PROF)
+#define PROFILER_CPU_SUPPORT
+#endif
+
+/* A log of call stacks.  Each entry holds the functions of the
+   innermost frames of backtrace_list when a sample was taken,
+   innermost first and padded with nil, and the number of samples
+   taken with that stack, or the number of bytes allocated with it.
+   CPU samples are recorded from a signal handler, so the log is a
+   fixed-size hash table in malloc'ed memory that recording never
+   reallocates; samples that find it full are only counted.  */
+
+struct profiler_log
+{
+  /* Maximum number of entries, and number of frames in each.  */
+  int size, depth;
+
+  /* Number of entries in use.  */
+  int used;
+
+  /* The frames of entry I are FRAMES[I * DEPTH] to
+     FRAMES[I * DEPTH + DEPTH - 1].  There is room for one entry more
+     than SIZE, where a new stack is assembled before it is looked
+     up.  */
+  Lisp_Object *frames;
+
+  /* What has been recorded for each entry.  */
+  EMACS_INT *counts;
+
+  /* Collision chains: the index of the first entry of each of SIZE
+     buckets, and the index of the entry after each entry in its
+     bucket, -1 at the end of a chain.  */
+  int *index, *next;
+
+  /* Total of the samples that found the log full.  */
+  EMACS_INT discarded;
+};
+
+/* The function recorded for samples taken during garbage
+   collection.  */
+
+Lisp_Object Qautomatic_gc;
+
+/* Maximum number of frames recorded per sample.  */
+
+EMACS_INT profiler_max_stack_depth;
+
+/* Maximum number of different call stacks in a log.  */
+
+EMACS_INT profiler_log_size;
+
+/* The log of the CPU profiler, or null if there is none.  */
+
+static struct profiler_log *cpu_log;
+
+/* Non-zero while the CPU profiler is running.  */
+
+static int profiler_cpu_running;
+
+/* The log of the memory profiler, or null if there is none.  */
+
+static struct profiler_log *memory_log;
+
+/* Non-zero while the memory profiler is running.  The allocation
+   functions in alloc.c call malloc_probe only if this is set.  */
+
+int profiler_memory_running;
+
+/* The memory profiler takes a sample each time this many bytes have
+   been allocated.  */
+
+static EMACS_INT memory_sample_bytes;
+
+/* Bytes allocated since the memory profiler's last sample.  */
+
+static EMACS_INT memory_pending_bytes;
+
+static struct profiler_log *make_log P_ ((int, int));
+static void free_log P_ ((struct profiler_log *));
+static void record_backtrace P_ ((struct profiler_log *, EMACS_INT));
+static Lisp_Object log_to_hash_table P_ ((struct profiler_log *));
+static void mark_log P_ ((struct profiler_log *));
+
+
+/* Return a new, empty log for at most SIZE different stacks of DEPTH
+   frames each.  */
+
+static struct profiler_log *
+make_log (size, depth)
+     int size, depth;
+{
+  struct profiler_log *log;
+  int i;
+
+  log = (struct profiler_log *) xmalloc (sizeof *log);
+  log->size = size;
+  log->depth = depth;
+  log->used = 0;
+  log->discarded = 0;
+  log->frames
+    = (Lisp_Object *) xmalloc ((size + 1) * depth * sizeof *log->frames);
+  log->counts = (EMACS_INT *) xmalloc (size * sizeof *log->counts);
+  log->index = (int *) xmalloc (size * sizeof *log->index);
+  log->next = (int *) xmalloc (size * sizeof *log->next);
+  for (i = 0; i < size; i++)
+    log->index[i] = -1;
+  return log;
+}
+
+static void
+free_log (log)
+     struct profiler_log *log;
+{
+  xfree (log->frames);
+  xfree (log->counts);
+  xfree (log->index);
+  xfree (log->next);
+  xfree (log);
+}
+
+/* Add COUNT to the entry of LOG for the current call stack.  This is
+   called from signal handlers: it must not allocate or signal.  */
+
+static void
+record_backtrace (log, count)
+     struct profiler_log *log;
+     EMACS_INT count;
+{
+  Lisp_Object *frames = log->frames + log->used * log->depth;
+  struct backtrace *bt;
+  EMACS_UINT hash;
+  int i, n;
+
+  n = 0;
+  if (gc_in_progress)
+    /* The stack of the code that happened to trigger GC says little
+       about where GC time goes.  */
+    frames[n++] = Qautomatic_gc;
+  else
+    for (bt = backtrace_list; bt && n < log->depth; bt = bt->next)
+      frames[n++] = *bt->function;
+  for (i = n; i < log->depth; i++)
+    frames[i] = Qnil;
+
+  hash = 0;
+  for (i = 0; i < n; i++)
+    hash = ((hash << 4) + (hash >> (BITS_PER_EMACS_INT - 4))
+	    + XHASH (frames[i]));
+
+  for (i = log->index[hash % log->size]; i >= 0; i = log->next[i])
+    {
+      Lisp_Object *entry = log->frames + i * log->depth;
+      int j;
+
+      for (j = 0; j < n && EQ (entry[j], frames[j]); j++)
+	;
+      if (j == n && (n == log->depth || NILP (entry[n])))
+	{
+	  log->counts[i] += count;
+	  return;
+	}
+    }
+
+  if (log->used < log->size)
+    {
+      /* FRAMES is already in place as the new entry.  */
+      i = log->used++;
+      log->counts[i] = count;
+      log->next[i] = log->index[hash % log->size];
+      log->index[hash % log->size] = i;
+    }
+  else
+    log->discarded += count;
+}
+
+/* Return non-zero if nothing has been recorded in LOG.  */
+
+static int
+log_empty_p (log)
+     struct profiler_log *log;
+{
+  return log->used == 0 && log->discarded == 0;
+}
+
+/* Return a hash table mapping each call stack in LOG, as a vector of
+   functions, to what has been recorded for it, and empty LOG.  Stacks
+   that didn't fit into LOG are counted under the key
+   [profiler-discarded].  */
+
+static Lisp_Object
+log_to_hash_table (log)
+     struct profiler_log *log;
+{
+  Lisp_Object table;
+  int i;
+
+  table = make_hash_table (Qequal, make_number (max (log->used, 1)),
+			   make_float (DEFAULT_REHASH_SIZE),
+			   make_float (DEFAULT_REHASH_THRESHOLD),
+			   Qnil, Qnil, Qnil);
+  for (i = 0; i < log->used; i++)
+    {
+      Lisp_Object *entry = log->frames + i * log->depth;
+      Lisp_Object key;
+      int n;
+
+      for (n = log->depth; n > 0 && NILP (entry[n - 1]); n--)
+	;
+      key = Fmake_vector (make_number (n), Qnil);
+      bcopy (entry, XVECTOR (key)->contents, n * sizeof *entry);
+      Fputhash (key, make_number (log->counts[i]), table);
+    }
+  if (log->discarded)
+    Fputhash (Fmake_vector (make_number (1), intern ("profiler-discarded")),
+	      make_number (log->discarded), table);
+
+  log->used = 0;
+  log->discarded = 0;
+  for (i = 0; i < log->size; i++)
+    log->index[i] = -1;
+  return table;
+}
+
+static void
+mark_log (log)
+     struct profiler_log *log;
+{
+  int i;
+
+  for (i = 0; i < log->used * log->depth; i++)
+    mark_object (log->frames[i]);
+}
+
+/* Mark the functions recorded in profiler logs.  Called during GC.  */
+
+void
+mark_profiler ()
+{
+  if (cpu_log)
+    mark_log (cpu_log);
+  if (memory_log)
+    mark_log (memory_log);
+}
+
+/* Count NBYTES of Lisp data just allocated, and charge the bytes
+   allocated since the last sample to the current call stack if that
+   makes MEMORY_SAMPLE_BYTES.  */
+
+void
+malloc_probe (nbytes)
+     size_t nbytes;
+{
+  memory_pending_bytes += nbytes;
+  /* Allocation from a signal handler could find MEMORY_LOG half
+     updated.  Keep its bytes for the next sample.  */
+  if (memory_pending_bytes >= memory_sample_bytes
+      && memory_log && !handling_signal)
+    {
+      record_backtrace (memory_log, memory_pending_bytes);
+      memory_pending_bytes = 0;
+    }
+}
+
+
+#ifdef PROFILER_CPU_SUPPORT
+
+/* Record a sample of the current call stack.  */
+
+static SIGTYPE
+handle_profiler_signal (signo)
+     int signo;
+{
+  SIGNAL_THREAD_CHECK (signo);
+  if (cpu_log)
+    record_backtrace (cpu_log, 1);
+}
+
+#endif /* PROFILER_CPU_SUPPORT */
+
+DEFUN ("profiler-cpu-start", Fprofiler_cpu_start, Sprofiler_cpu_start,
+       0, 1, 0,
+       doc: /* Start the CPU profiler.
+It samples the Lisp call stack every SAMPLING-INTERVAL nanoseconds of
+CPU time used by Emacs, 10000000 (10 ms) if omitted or nil.  Use
+`profiler-cpu-log' to get what was recorded.  */)
+     (sampling_interval)
+     Lisp_Object sampling_interval;
+{
+#ifdef PROFILER_CPU_SUPPORT
+  struct itimerval timer;
+  EMACS_INT interval;
+
+  if (NILP (sampling_interval))
+    interval = 10000000;
+  else
+    {
+      CHECK_NATNUM (sampling_interval);
+      interval = XFASTINT (sampling_interval);
+    }
+  if (profiler_cpu_running)
+    error ("CPU profiler is already running");
+
+  if (!cpu_log)
+    cpu_log = make_log (max (profiler_log_size, 1),
+			max (profiler_max_stack_depth, 1));
+
+  /* setitimer works in microseconds; don't round down to zero, which
+     would disarm the timer.  */
+  timer.it_interval.tv_sec = interval / 1000000000;
+  timer.it_interval.tv_usec = max ((interval % 1000000000) / 1000,
+				   timer.it_interval.tv_sec ? 0 : 1);
+  timer.it_value = timer.it_interval;
+
+  signal (SIGPROF, handle_profiler_signal);
+  if (setitimer (ITIMER_PROF, &timer, 0) != 0)
+    {
+      signal (SIGPROF, SIG_IGN);
+      error ("Could not start the CPU profiler timer");
+    }
+  profiler_cpu_running = 1;
+  return Qt;
+#else
+  error ("The CPU profiler is not supported on this system");
+#endif
+}
+
+DEFUN ("profiler-cpu-stop", Fprofiler_cpu_stop, Sprofiler_cpu_stop,
+       0, 0, 0,
+       doc: /* Stop the CPU profiler.
+What it recorded so far stays available to `profiler-cpu-log'.
+Return t if the profiler was running, nil otherwise.  */)
+     ()
+{
+#ifdef PROFILER_CPU_SUPPORT
+  struct itimerval timer;
+
+  if (!profiler_cpu_running)
+    return Qnil;
+
+  bzero (&timer, sizeof timer);
+  setitimer (ITIMER_PROF, &timer, 0);
+  signal (SIGPROF, SIG_IGN);
+  profiler_cpu_running = 0;
+  return Qt;
+#else
+  return Qnil;
+#endif
+}
+
+DEFUN ("profiler-cpu-running-p", Fprofiler_cpu_running_p,
+       Sprofiler_cpu_running_p, 0, 0, 0,
+       doc: /* Return non-nil if the CPU profiler is running.  */)
+     ()
+{
+  return profiler_cpu_running ? Qt : Qnil;
+}
+
+DEFUN ("profiler-cpu-log", Fprofiler_cpu_log, Sprofiler_cpu_log,
+       0, 0, 0,
+       doc: /* Return the CPU profiler's log and start a new one.
+The log is a hash table whose keys are vectors of functions, a call
+stack with the innermost function first, and whose values are the
+number of samples taken with that stack.  Samples taken during garbage
+collection have the stack [Automatic\\ GC].  At most
+`profiler-max-stack-depth' frames are recorded per sample, and at most
+`profiler-log-size' different stacks; further ones are counted under
+the key [profiler-discarded].
+
+Return nil instead if the CPU profiler has recorded nothing since it
+was started or its log was last returned.  */)
+     ()
+{
+  Lisp_Object table;
+
+  if (!cpu_log)
+    return Qnil;
+
+#ifdef PROFILER_CPU_SUPPORT
+  sigblock (sigmask (SIGPROF));
+#endif
+  table = log_empty_p (cpu_log) ? Qnil : log_to_hash_table (cpu_log);
+  if (!profiler_cpu_running)
+    {
+      /* Pick up any change of the size variables at the next start.  */
+      free_log (cpu_log);
+      cpu_log = NULL;
+    }
+#ifdef PROFILER_CPU_SUPPORT
+  sigunblock (sigmask (SIGPROF));
+#endif
+  return table;
+}
+
+DEFUN ("profiler-memory-start", Fprofiler_memory_start,
+       Sprofiler_memory_start, 0, 1, 0,
+       doc: /* Start the memory profiler.
+Each time SAMPLE-BYTES bytes of Lisp data have been allocated, 65536 if
+omitted or nil, it charges the bytes allocated since the last sample to
+the current Lisp call stack.  Conses, floats, vectors and string data
+are counted.  Use `profiler-memory-log' to get what was recorded.  */)
+     (sample_bytes)
+     Lisp_Object sample_bytes;
+{
+  if (NILP (sample_bytes))
+    sample_bytes = make_number (65536);
+  CHECK_NATNUM (sample_bytes);
+  if (profiler_memory_running)
+    error ("Memory profiler is already running");
+
+  if (!memory_log)
+    memory_log = make_log (max (profiler_log_size, 1),
+			   max (profiler_max_stack_depth, 1));
+  memory_sample_bytes = XFASTINT (sample_bytes);
+  memory_pending_bytes = 0;
+  profiler_memory_running = 1;
+  return Qt;
+}
+
+DEFUN ("profiler-memory-stop", Fprofiler_memory_stop,
+       Sprofiler_memory_stop, 0, 0, 0,
+       doc: /* Stop the memory profiler.
+What it recorded so far stays available to `profiler-memory-log'.
+Return t if the profiler was running, nil otherwise.  */)
+     ()
+{
+  if (!profiler_memory_running)
+    return Qnil;
+  profiler_memory_running = 0;
+  return Qt;
+}
+
+DEFUN ("profiler-memory-running-p", Fprofiler_memory_running_p,
+       Sprofiler_memory_running_p, 0, 0, 0,
+       doc: /* Return non-nil if the memory profiler is running.  */)
+     ()
+{
+  return profiler_memory_running ? Qt : Qnil;
+}
+
+DEFUN ("profiler-memory-log", Fprofiler_memory_log, Sprofiler_memory_log,
+       0, 0, 0,
+       doc: /* Return the memory profiler's log and start a new one.
+The log is a hash table whose keys are vectors of functions, a call
+stack with the innermost function first, and whose values are the
+number of bytes charged to that stack.  It is limited like the log of
+`profiler-cpu-log'.
+
+Return nil instead if the memory profiler has recorded nothing since
+it was started or its log was last returned.  */)
+     ()
+{
+  Lisp_Object table;
+  int running = profiler_memory_running;
+
+  if (!memory_log)
+    return Qnil;
+
+  /* Don't sample the allocation of the table itself.  */
+  profiler_memory_running = 0;
+  table = log_empty_p (memory_log) ? Qnil : log_to_hash_table (memory_log);
+  profiler_memory_running = running;
+  if (!running)
+    {
+      free_log (memory_log);
+      memory_log = NULL;
+    }
+  return table;
+}
+
+
+void
+syms_of_profiler ()
+{
+  Qautomatic_gc = intern ("Automatic GC");
+  staticpro (&Qautomatic_gc);
+
+  DEFVAR_INT ("profiler-max-stack-depth", &profiler_max_stack_depth,
+	      doc: /* Maximum number of frames recorded per profiler sample.
+Only the innermost frames of deeper call stacks are recorded.  A change
+takes effect when the profiler is next started after its log has been
+fetched.  */);
+  profiler_max_stack_depth = 16;
+
+  DEFVAR_INT ("profiler-log-size", &profiler_log_size,
+	      doc: /* Maximum number of different call stacks in a profiler log.
+A change takes effect when the profiler is next started after its log
+has been fetched.  */);
+  profiler_log_size = 10000;
+
+  defsubr (&Sprofiler_cpu_start);
+  defsubr (&Sprofiler_cpu_stop);
+  defsubr (&Sprofiler_cpu_running_p);
+  defsubr (&Sprofiler_cpu_log);
+  defsubr (&Sprofiler_memory_start);
+  defsubr (&Sprofiler_memory_stop);
+  defsubr (&Sprofiler_memory_running_p);
+  defsubr (&Sprofiler_memory_log);
+}
+
+/* arch-tag: 4808f65b-f3fb-4d14-a6db-0343c5c42b1c
+   (do not change this comment) */
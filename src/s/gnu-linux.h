@@ -182,8 +182,13 @@ along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
 /* Link temacs with -z nocombreloc so that unexec works right, whether or
    not -z combreloc is the default.  GNU ld ignores unknown -z KEYWORD
    switches, so this also works with older versions that don't implement
-   -z combreloc.  */
-#define LD_SWITCH_SYSTEM_TEMACS -z nocombreloc
+   -z combreloc.  Export the symbols of temacs, with -E (the linker's
+   spelling of gcc's -rdynamic), so that the native code loaded by
+   native.c can refer to them.  */
+#define LD_SWITCH_SYSTEM_TEMACS -z nocombreloc -E
+
+/* native.c loads native code with dlopen, from libdl.  */
+#define HAVE_DLOPEN
 
 #ifdef emacs
 #define INTERRUPT_INPUT
@@ -209,7 +214,7 @@ along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.  */
 
 /* alane@wozzle.linet.org says that -lipc is not a separate library,
    since libc-4.4.1.  So -lipc was deleted.  */
-#define LIBS_SYSTEM
+#define LIBS_SYSTEM -ldl
 /* _BSD_SOURCE is redundant, at least in glibc2, since we define
    _GNU_SOURCE.  Left in in case it's relevant to libc5 systems and
    anyone's still using Emacs on those.  --fx 2002-12-14  */
@@ -3371,7 +3371,8 @@ handle_fontified_prop (it)
       val = Vfontification_functions;
       specbind (Qfontification_functions, Qnil);
 
-      if (!CONSP (val) || EQ (XCAR (val), Qlambda))
+      if (!CONSP (val) || EQ (XCAR (val), Qlambda)
+	  || EQ (XCAR (val), Qclosure))
 	safe_call1 (val, pos);
       else
 	{
@@ -6741,6 +6741,50 @@ DEFUN ("show-face-resources", Fshow_face_resources, Sshow_face_resources,
 			    Initialization
  ***********************************************************************/
 
+/* Save the mapping from Lisp face ids to face names in a portable
+   dump, together with the faces of the frame Emacs starts with,
+   which are not part of any root.  */
+
+static void
+xfaces_dump_save ()
+{
+  int i;
+
+  pdump_write_data (&next_lface_id, sizeof next_lface_id);
+  for (i = 0; i < next_lface_id; i++)
+    pdump_write_object (lface_id_to_name[i]);
+  pdump_write_object (FRAMEP (selected_frame)
+		      ? XFRAME (selected_frame)->face_alist : Qnil);
+}
+
+/* Restore what xfaces_dump_save saved.  */
+
+static void
+xfaces_dump_load ()
+{
+  Lisp_Object face_alist;
+  int i, n;
+
+  pdump_read_data (&n, sizeof n);
+  if (n > lface_id_to_name_size)
+    {
+      lface_id_to_name = ((Lisp_Object *)
+			  xrealloc (lface_id_to_name,
+				    n * sizeof *lface_id_to_name));
+      lface_id_to_name_size = n;
+    }
+  for (i = 0; i < n; i++)
+    {
+      lface_id_to_name[i] = Qnil;
+      pdump_read_object (&lface_id_to_name[i]);
+    }
+  next_lface_id = n;
+
+  if (pdump_read_object (&face_alist) && FRAMEP (selected_frame))
+    XFRAME (selected_frame)->face_alist = face_alist;
+  ++face_change_count;
+}
+
 void
 syms_of_xfaces ()
 {
@@ -6748,6 +6792,7 @@ syms_of_xfaces ()
   staticpro (&Qface);
   Qface_no_inherit = intern ("face-no-inherit");
   staticpro (&Qface_no_inherit);
+  pdump_add_hooks (xfaces_dump_save, xfaces_dump_load);
   Qbitmap_spec_p = intern ("bitmap-spec-p");
   staticpro (&Qbitmap_spec_p);
   Qframe_set_background_mode = intern ("frame-set-background-mode");
@@ -0,0 +1,106 @@
+;;; bytecode-bench.el --- micro-benchmarks for the byte-code interpreter
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Small loops that spend nearly all their time dispatching cheap
+;; byte-code instructions: arithmetic and comparisons, list walking,
+;; vector access, variable references and function calls.  Each one
+;; is byte-compiled and then timed, and a checksum is printed so that
+;; a changed interpreter can be checked against an old one.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l bytecode-bench.el -f bytecode-bench-run
+
+;;; Code:
+
+(defvar bytecode-bench-count 3000000
+  "Number of iterations of each loop.")
+
+(defvar bytecode-bench-var 0
+  "A dynamic variable used by `bytecode-bench-varref'.")
+
+(defun bytecode-bench-arith (n)
+  (let ((i 0) (sum 0))
+    (while (< i n)
+      (if (= (% i 3) 0)
+	  (setq sum (+ sum i))
+	(setq sum (- sum 1)))
+      (setq i (1+ i)))
+    sum))
+
+(defun bytecode-bench-list (n)
+  (let ((list (make-list 100 1)) (sum 0) (i 0))
+    (while (< i n)
+      (let ((tail list))
+	(while tail
+	  (setq sum (+ sum (car tail)))
+	  (setq tail (cdr tail))))
+      (setq i (+ i 100)))
+    sum))
+
+(defun bytecode-bench-vector (n)
+  (let ((v (make-vector 64 0)) (i 0))
+    (while (< i n)
+      (aset v (logand i 63) (1+ (aref v (logand (1+ i) 63))))
+      (setq i (1+ i)))
+    (aref v 0)))
+
+(defun bytecode-bench-varref (n)
+  (let ((i 0))
+    (setq bytecode-bench-var 0)
+    (while (< i n)
+      (setq bytecode-bench-var (+ bytecode-bench-var (logand i 7)))
+      (setq i (1+ i)))
+    bytecode-bench-var))
+
+(defun bytecode-bench-callee (a b)
+  (if (> a b) (- a b) (+ a b)))
+
+(defun bytecode-bench-call (n)
+  (let ((i 0) (sum 0))
+    (while (< i n)
+      (setq sum (logand (bytecode-bench-callee i sum) 65535))
+      (setq i (1+ i)))
+    sum))
+
+(defconst bytecode-bench-tests
+  '(bytecode-bench-arith bytecode-bench-list bytecode-bench-vector
+    bytecode-bench-varref bytecode-bench-call)
+  "The benchmarks run by `bytecode-bench-run'.")
+
+(defun bytecode-bench-run ()
+  "Byte-compile and time the byte-code micro-benchmarks."
+  (byte-compile 'bytecode-bench-callee)
+  (let ((total 0.0))
+    (dolist (test bytecode-bench-tests)
+      (byte-compile test)
+      (garbage-collect)
+      (let* ((start (float-time))
+	     (value (funcall test bytecode-bench-count))
+	     (elapsed (- (float-time) start)))
+	(setq total (+ total elapsed))
+	(message "%-24s %8.4fs  (%s)" test elapsed value)))
+    (message "%-24s %8.4fs" "total" total)))
+
+;;; bytecode-bench.el ends here
@@ -0,0 +1,107 @@
+;;; catch-bench.el --- micro-benchmarks for catch and condition-case
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Tight byte-compiled loops that enter a `catch' or `condition-case'
+;; on every iteration, the way a parser wraps each line it reads:
+;; without any throw or error, with a throw, with an error that is
+;; caught, and with `ignore-errors' around a conversion.  Each one is
+;; byte-compiled and then timed, and a checksum is printed so that a
+;; changed implementation can be checked against an old one.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l catch-bench.el -f catch-bench-run
+
+;;; Code:
+
+(defvar catch-bench-count 1000000
+  "Number of iterations of each loop.")
+
+(defun catch-bench-condition-case (n)
+  (let ((i 0) (sum 0))
+    (while (< i n)
+      (setq sum (condition-case nil
+		    (+ sum (logand i 7))
+		  (error sum)))
+      (setq i (1+ i)))
+    sum))
+
+(defun catch-bench-condition-case-error (n)
+  (let ((i 0) (sum 0))
+    (while (< i n)
+      (setq sum (condition-case err
+		    (if (= (logand i 3) 0)
+			(signal 'wrong-type-argument (list i))
+		      (1+ sum))
+		  (wrong-type-argument (+ sum (cadr err)))))
+      (setq i (1+ i)))
+    sum))
+
+(defun catch-bench-catch (n)
+  (let ((i 0) (sum 0))
+    (while (< i n)
+      (setq sum (catch 'done
+		  (+ sum (logand i 7))))
+      (setq i (1+ i)))
+    sum))
+
+(defun catch-bench-throw (n)
+  (let ((i 0) (sum 0))
+    (while (< i n)
+      (setq sum (catch 'done
+		  (if (= (logand i 3) 0)
+		      (throw 'done (+ sum 2))
+		    (1+ sum))))
+      (setq i (1+ i)))
+    sum))
+
+(defun catch-bench-ignore-errors (n)
+  (let ((lines ["12" "x" "7" "(" "40"]) (i 0) (sum 0))
+    (while (< i n)
+      (let ((value (ignore-errors
+		     (car (read-from-string (aref lines (% i 5)))))))
+	(if (integerp value)
+	    (setq sum (+ sum value))))
+      (setq i (1+ i)))
+    sum))
+
+(defconst catch-bench-tests
+  '(catch-bench-condition-case catch-bench-condition-case-error
+    catch-bench-catch catch-bench-throw catch-bench-ignore-errors)
+  "The benchmarks run by `catch-bench-run'.")
+
+(defun catch-bench-run ()
+  "Byte-compile and time the catch and condition-case micro-benchmarks."
+  (let ((total 0.0))
+    (dolist (test catch-bench-tests)
+      (byte-compile test)
+      (garbage-collect)
+      (let* ((start (float-time))
+	     (value (funcall test catch-bench-count))
+	     (elapsed (- (float-time) start)))
+	(setq total (+ total elapsed))
+	(message "%-34s %8.4fs  (%s)" test elapsed value)))
+    (message "%-34s %8.4fs" "total" total)))
+
+;;; catch-bench.el ends here
@@ -0,0 +1,87 @@
+;;; gc-pause-bench.el --- benchmark garbage collection pauses
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Garbage collection sweeps only the newest cons block, and leaves
+;; the others to be swept lazily: by `cons' when it runs out of free
+;; conses, when Emacs waits for a command, or at the start of the next
+;; garbage collection.  This measures the pauses of garbage
+;; collections with a large heap of long-lived conses, as reported by
+;; `gc-statistics', and the total time of the loop, which includes the
+;; sweeping done outside of the pauses.
+;;
+;; In the "consing" loop, some conses are allocated between the
+;; collections, which sweeps part of the cons blocks.  In the
+;; "back to back" loop, nothing is, so each collection starts by
+;; sweeping what the previous one left.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l gc-pause-bench.el -f gc-pause-bench-run
+
+;;; Code:
+
+(defvar gc-pause-bench-live 1000000
+  "Number of long-lived conses.")
+
+(defvar gc-pause-bench-garbage 200000
+  "Number of conses allocated between two collections in the consing loop.")
+
+(defvar gc-pause-bench-repeat 30
+  "Number of garbage collections to time in each loop.")
+
+(defvar gc-pause-bench-heap nil
+  "The long-lived conses.")
+
+(defun gc-pause-bench-loop (name garbage)
+  "Time `gc-pause-bench-repeat' collections, consing GARBAGE conses before each.
+Print NAME with the mean and maximum pause and the total time."
+  (let ((total 0.0)
+	(longest 0.0)
+	(start (float-time)))
+    (dotimes (i gc-pause-bench-repeat)
+      (let ((n garbage))
+	(while (> n 0)
+	  (cons n n)
+	  (setq n (1- n))))
+      (garbage-collect)
+      (let ((pause (plist-get (gc-statistics) :pause)))
+	(setq total (+ total pause)
+	      longest (max longest pause))))
+    (princ (format "%-14s pause: mean %6.2fms  max %6.2fms  loop %6.3fs\n"
+		   name
+		   (/ (* 1000 total) gc-pause-bench-repeat)
+		   (* 1000 longest)
+		   (- (float-time) start)))))
+
+(defun gc-pause-bench-run ()
+  "Time garbage collection pauses with a large heap of conses."
+  (let ((gc-cons-threshold most-positive-fixnum))
+    (setq gc-pause-bench-heap (make-list gc-pause-bench-live nil))
+    (garbage-collect)
+    (byte-compile 'gc-pause-bench-loop)
+    (gc-pause-bench-loop "consing" gc-pause-bench-garbage)
+    (gc-pause-bench-loop "back to back" 0)
+    (setq gc-pause-bench-heap nil)))
+
+;;; gc-pause-bench.el ends here
@@ -0,0 +1,73 @@
+;;; gc-stack-scan-bench.el --- benchmark conservative stack scanning
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Garbage collection scans the C stack conservatively, looking up
+;; every word on it among the blocks of Lisp data.  This measures the
+;; time a GC takes with a deep C stack, as during byte compilation or
+;; redisplay, compared with a shallow one.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l gc-stack-scan-bench.el -f gc-stack-scan-bench-run
+
+;;; Code:
+
+(defvar gc-stack-scan-bench-depth 3000
+  "Depth of Lisp recursion at which to garbage collect.")
+
+(defvar gc-stack-scan-bench-repeat 50
+  "Number of garbage collections to time.")
+
+(defvar gc-stack-scan-bench-heap nil
+  "Lisp data kept alive, so that there are many blocks to search.")
+
+(defun gc-stack-scan-bench-time ()
+  "Return the time in seconds taken by one garbage collection."
+  (let ((start (float-time)))
+    (dotimes (i gc-stack-scan-bench-repeat)
+      (garbage-collect))
+    (/ (- (float-time) start) gc-stack-scan-bench-repeat)))
+
+(defun gc-stack-scan-bench-recurse (n)
+  "Recurse N levels deep, then time garbage collection."
+  (if (> n 0)
+      (car (list (gc-stack-scan-bench-recurse (1- n))))
+    (gc-stack-scan-bench-time)))
+
+(defun gc-stack-scan-bench-run ()
+  "Time garbage collection with a shallow and with a deep C stack."
+  (let ((max-lisp-eval-depth (* 10 gc-stack-scan-bench-depth))
+	(max-specpdl-size (* 10 gc-stack-scan-bench-depth)))
+    (setq gc-stack-scan-bench-heap
+	  (let (l)
+	    (dotimes (i 200000 l)
+	      (push (list (make-vector (% i 20) i) (number-to-string i)
+			  (* 1.0 i))
+		    l))))
+    (let ((shallow (gc-stack-scan-bench-time))
+	  (deep (gc-stack-scan-bench-recurse gc-stack-scan-bench-depth)))
+      (message "GC with shallow stack: %.4fs, at depth %d: %.4fs"
+	       shallow gc-stack-scan-bench-depth deep))))
+
+;;; gc-stack-scan-bench.el ends here
@@ -0,0 +1,127 @@
+;;; gc-sweep-threads-testsuite.el --- tests for `gc-sweep-threads'
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Garbage collects with `gc-sweep-threads' set to 4, so that the
+;; cons, float and symbol blocks are swept by several threads, while
+;; allocating more data between the collections, and checks that the
+;; data kept alive is intact.  This also covers builds whose malloc is
+;; gmalloc.c without thread support, which is the case on systems
+;; other than GNU/Linux, and on GNU/Linux without GTK or without the
+;; malloc hooks of the C library: the threads that sweep must never
+;; call malloc.
+;;
+;; Where /proc/self/task lists the threads of Emacs, it also checks
+;; that the threads are started once and then kept.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l gc-sweep-threads-testsuite.el -f gc-sweep-threads-testsuite-run
+;;
+;; It signals an error if a test fails.
+
+;;; Code:
+
+(defvar gc-sweep-threads-testsuite-size 200000
+  "Number of conses, floats and symbols that the tests keep alive.")
+
+(defvar gc-sweep-threads-testsuite-rounds 5
+  "Number of garbage collections that the tests do.")
+
+(defun gc-sweep-threads-testsuite-check (test ok)
+  "Report TEST, and signal an error unless OK is non-nil."
+  (princ (format "%s: %s\n" test (if ok "OK" "NG")))
+  (unless ok
+    (error "Sweep threads test failed: %s" test)))
+
+(defun gc-sweep-threads-testsuite-threads ()
+  "Return the number of threads of Emacs, or nil if it is unknown."
+  (if (file-directory-p "/proc/self/task")
+      (length (directory-files "/proc/self/task" nil "\\`[0-9]"))))
+
+(defun gc-sweep-threads-testsuite-data (n)
+  "Return a list of N conses, N floats and N / 10 uninterned symbols.
+Garbage is allocated in between, so that live and free objects share
+blocks."
+  (let (conses floats symbols)
+    (dotimes (i n)
+      (push i conses)
+      (cons i i)
+      (push (+ i 0.5) floats)
+      (+ i 0.25)
+      (when (zerop (% i 10))
+	(let ((sym (make-symbol (format "gc-sweep-%d" i))))
+	  (set sym i)
+	  (push sym symbols)
+	  (make-symbol "garbage"))))
+    (list conses floats symbols)))
+
+(defun gc-sweep-threads-testsuite-intact-p (data n)
+  "Return non-nil if DATA is what `gc-sweep-threads-testsuite-data' made.
+N is the argument it was called with."
+  (let ((i (1- n))
+	(ok t))
+    (dolist (elt (nth 0 data))
+      (unless (eq elt i) (setq ok nil))
+      (setq i (1- i)))
+    (setq i (1- n))
+    (dolist (elt (nth 1 data))
+      (unless (= elt (+ i 0.5)) (setq ok nil))
+      (setq i (1- i)))
+    (dolist (sym (nth 2 data))
+      (unless (equal (symbol-name sym) (format "gc-sweep-%d" (symbol-value sym)))
+	(setq ok nil)))
+    (and ok
+	 (= (length (nth 0 data)) n)
+	 (= (length (nth 1 data)) n)
+	 (= (length (nth 2 data)) (/ (+ n 9) 10)))))
+
+(defun gc-sweep-threads-testsuite-run ()
+  "Test garbage collection with several sweep threads."
+  (let* ((n gc-sweep-threads-testsuite-size)
+	 (gc-sweep-threads 4)
+	 (data (gc-sweep-threads-testsuite-data n))
+	 threads more ok)
+    (garbage-collect)
+    (setq threads (gc-sweep-threads-testsuite-threads))
+    (setq ok t)
+    (dotimes (round gc-sweep-threads-testsuite-rounds)
+      ;; Reuse the free lists that the threads built.
+      (setq more (gc-sweep-threads-testsuite-data (/ n 4)))
+      (garbage-collect)
+      (unless (and (gc-sweep-threads-testsuite-intact-p data n)
+		   (gc-sweep-threads-testsuite-intact-p more (/ n 4)))
+	(setq ok nil)))
+    (gc-sweep-threads-testsuite-check "data intact" ok)
+    (let ((gc-sweep-threads 1))
+      (garbage-collect))
+    (gc-sweep-threads-testsuite-check
+     "data intact after sweeping in one thread"
+     (gc-sweep-threads-testsuite-intact-p data n))
+    (if (null threads)
+	(princ "threads kept: skipped, no /proc/self/task\n")
+      (gc-sweep-threads-testsuite-check
+       (format "threads kept: %d" threads)
+       (= (gc-sweep-threads-testsuite-threads) threads)))))
+
+;;; gc-sweep-threads-testsuite.el ends here
@@ -0,0 +1,169 @@
+;;; lazy-load-testsuite.el --- tests for `load-lazy-functions'
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Loads byte-compiled files with `load-lazy-functions' non-nil, and
+;; checks that the functions they define were left in the file, except
+;; for those whose constants refer to each other with #N= labels, and
+;; that they then run and have their doc strings as if they had been
+;; read completely.  The files are ring.elc from the lisp/ directory
+;; of the source tree, whose functions the byte compiler precedes with
+;; their #@ doc strings, and a file compiled into a temporary
+;; directory.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l lazy-load-testsuite.el -f lazy-load-testsuite-run
+;;
+;; It signals an error if a test fails.
+
+;;; Code:
+
+(defvar lazy-load-testsuite-ring
+  (expand-file-name "../lisp/emacs-lisp/ring.elc"
+		    (file-name-directory (or load-file-name
+					     buffer-file-name)))
+  "Byte-compiled file from the source tree that the tests load.")
+
+(defconst lazy-load-testsuite-source
+  '((defun lazy-load-test-plain (x)
+      (list x (* x 2)))
+    (defun lazy-load-test-doc (list)
+      "Return the sum of the numbers in LIST."
+      (apply '+ list))
+    (defun lazy-load-test-nested (n)
+      "Return a function that adds N to its argument."
+      `(lambda (x) (+ x ,n)))
+    (defmacro lazy-load-test-macro (form)
+      "Evaluate FORM twice."
+      `(progn ,form ,form)))
+  "Definitions in the file that the tests compile.")
+
+(defun lazy-load-testsuite-check (test ok)
+  "Report TEST, and signal an error unless OK is non-nil."
+  (princ (format "%s: %s\n" test (if ok "OK" "NG")))
+  (unless ok
+    (error "Lazy load test failed: %s" test)))
+
+(defun lazy-load-testsuite-lazy-p (function)
+  "Return non-nil if FUNCTION was left in its file by `load'."
+  (let ((def (symbol-function function)))
+    (and (byte-code-function-p def)
+	 (consp (aref def 1)))))
+
+(defun lazy-load-testsuite-labeled-p (file function)
+  "Return non-nil if the definition of FUNCTION in FILE uses #N= labels.
+`load' reads such a definition completely, because the parts of the
+function that it leaves in the file must make sense on their own."
+  (with-temp-buffer
+    (insert-file-contents-literally file)
+    (and (search-forward (format "(defalias '%s #[" function) nil t)
+	 (re-search-forward "#[0-9]+[=#]" (line-end-position) t))))
+
+(defun lazy-load-testsuite-functions (file)
+  "Return the functions that loading FILE defined."
+  (let (functions)
+    (dolist (elt (cdr (assoc file load-history)))
+      (if (eq (car-safe elt) 'defun)
+	  (push (cdr elt) functions)))
+    functions))
+
+(defun lazy-load-testsuite-ring ()
+  "Test loading `lazy-load-testsuite-ring' lazily."
+  (let ((load-lazy-functions t)
+	(load-native-code nil)
+	functions ring)
+    (load lazy-load-testsuite-ring nil t t)
+    (setq functions (lazy-load-testsuite-functions lazy-load-testsuite-ring))
+    (lazy-load-testsuite-check
+     (format "ring.elc: %d functions" (length functions))
+     (and functions
+	  (not (memq nil
+		     (mapcar (lambda (function)
+			       (if (lazy-load-testsuite-labeled-p
+				    lazy-load-testsuite-ring function)
+				   (not (lazy-load-testsuite-lazy-p function))
+				 (lazy-load-testsuite-lazy-p function)))
+			     functions)))))
+    (lazy-load-testsuite-check
+     "ring.elc: doc string"
+     (string-match "\\`Return t if X is a ring"
+		   (documentation 'ring-p)))
+    (setq ring (make-ring 3))
+    (dolist (elt '(a b c d))
+      (ring-insert ring elt))
+    (lazy-load-testsuite-check
+     "ring.elc: calls"
+     (and (ring-p ring)
+	  (equal (ring-elements ring) '(d c b))
+	  (eq (ring-ref ring 1) 'c)
+	  (not (lazy-load-testsuite-lazy-p 'ring-insert))))))
+
+(defun lazy-load-testsuite-compiled ()
+  "Test loading a file compiled for the test lazily."
+  (let* ((dir (make-temp-file "lazy-load-test" t))
+	 (el (expand-file-name "lazy-load-test.el" dir))
+	 (elc (concat el "c"))
+	 (load-native-code nil)
+	 expected)
+    (unwind-protect
+	(progn
+	  (with-temp-file el
+	    (let ((print-length nil) (print-level nil))
+	      (dolist (form lazy-load-testsuite-source)
+		(prin1 form (current-buffer))
+		(insert "\n"))))
+	  (lazy-load-testsuite-check "byte-compile" (byte-compile-file el))
+	  (let ((load-lazy-functions nil))
+	    (load elc nil t t))
+	  (setq expected
+		(list (lazy-load-test-plain 4)
+		      (lazy-load-test-doc '(1 2 3))
+		      (funcall (lazy-load-test-nested 5) 1)
+		      (let ((n 0)) (lazy-load-test-macro (setq n (1+ n))) n)
+		      (documentation 'lazy-load-test-doc)))
+	  (let ((load-lazy-functions t))
+	    (load elc nil t t))
+	  (lazy-load-testsuite-check
+	   "lazy"
+	   (and (lazy-load-testsuite-lazy-p 'lazy-load-test-plain)
+		(lazy-load-testsuite-lazy-p 'lazy-load-test-doc)
+		(lazy-load-testsuite-lazy-p 'lazy-load-test-nested)))
+	  (lazy-load-testsuite-check
+	   "values"
+	   (equal (list (lazy-load-test-plain 4)
+			(lazy-load-test-doc '(1 2 3))
+			(funcall (lazy-load-test-nested 5) 1)
+			(let ((n 0)) (lazy-load-test-macro (setq n (1+ n))) n)
+			(documentation 'lazy-load-test-doc))
+		  expected)))
+      (dolist (file (directory-files dir t "\\`[^.]"))
+	(delete-file file))
+      (delete-directory dir))))
+
+(defun lazy-load-testsuite-run ()
+  "Test loading byte-compiled files with `load-lazy-functions'."
+  (lazy-load-testsuite-ring)
+  (lazy-load-testsuite-compiled))
+
+;;; lazy-load-testsuite.el ends here
@@ -0,0 +1,243 @@
+;;; lexical-binding-testsuite.el --- tests for lexical binding
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Evaluates forms with lexical binding in the interpreter, and
+;; compares their values with the expected ones.  The forms cover
+;; `let' and `let*', closures that capture the variables of a loop,
+;; `condition-case' variables, and variables declared special, which
+;; must stay dynamic wherever they are bound.  Then a file whose first
+;; line sets `lexical-binding' is loaded, and `byte-compile-file' must
+;; refuse it without deleting its .elc file.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l lexical-binding-testsuite.el -f lexical-binding-testsuite-run
+;;
+;; It signals an error if a test fails.
+
+;;; Code:
+
+(defvar lexical-binding-test-special 'global
+  "Special variable that the tests bind.")
+
+(defconst lexical-binding-test-constant 'constant
+  "Constant that the tests check is special.")
+
+(defun lexical-binding-test-special-value ()
+  "Return the dynamic value of `lexical-binding-test-special'."
+  lexical-binding-test-special)
+
+(defun lexical-binding-test-symbol-value (symbol)
+  "Return the dynamic value of SYMBOL, or `unbound'."
+  (if (boundp symbol) (symbol-value symbol) 'unbound))
+
+(defconst lexical-binding-testsuite-forms
+  '(;; let and let*
+    ("let" (let ((x 1) (y 2)) (list x y)) (1 2))
+    ("let: parallel"
+     (let ((x 1)) (let ((x 2) (y x)) (list x y))) (2 1))
+    ("let*: sequential"
+     (let ((x 1)) (let* ((x 2) (y x)) (list x y))) (2 2))
+    ("let: not dynamic"
+     (let ((lbt-x 1)) (lexical-binding-test-symbol-value 'lbt-x))
+     unbound)
+    ("let*: not dynamic"
+     (let* ((lbt-x 1) (lbt-y lbt-x))
+       (list (lexical-binding-test-symbol-value 'lbt-x)
+	     (lexical-binding-test-symbol-value 'lbt-y)))
+     (unbound unbound))
+    ("let: setq"
+     (let ((x 1)) (let ((x 2)) (setq x 3)) x) 1)
+    ;; Closures
+    ("closure: argument"
+     (funcall (let ((n 10)) (lambda (x) (+ x n))) 5) 15)
+    ("closure: outlives its let"
+     (let ((make (lambda (n) (lambda () n))))
+       (list (funcall (funcall make 1)) (funcall (funcall make 2))))
+     (1 2))
+    ("closure: loop variable bound in each iteration"
+     (let ((i 0) fns)
+       (while (< i 3)
+	 (let ((j i))
+	   (setq fns (cons (lambda () j) fns)))
+	 (setq i (1+ i)))
+       (mapcar 'funcall fns))
+     (2 1 0))
+    ("closure: loop variable bound once"
+     (let ((i 0) fns)
+       (while (< i 3)
+	 (setq fns (cons (lambda () i) fns))
+	 (setq i (1+ i)))
+       (mapcar 'funcall fns))
+     (3 3 3))
+    ("closure: shared mutable variable"
+     (let* ((count 0)
+	    (inc (lambda () (setq count (1+ count))))
+	    (get (lambda () count)))
+       (funcall inc)
+       (funcall inc)
+       (list (funcall get) count))
+     (2 2))
+    ("closure: mapcar"
+     (let ((k 3)) (mapcar (lambda (x) (* x k)) '(1 2 3))) (3 6 9))
+    ("closure: &optional and &rest"
+     (let ((base 100))
+       (funcall (lambda (a &optional b &rest c) (list base a b c)) 1 2 3 4))
+     (100 1 2 (3 4)))
+    ("closure: arguments are not dynamic"
+     (funcall (lambda (lbt-x) (lexical-binding-test-symbol-value 'lbt-x)) 1)
+     unbound)
+    ;; condition-case
+    ("condition-case: variable"
+     (condition-case err (signal 'wrong-type-argument '(x))
+       (error (cdr err)))
+     (x))
+    ("condition-case: variable is not dynamic"
+     (condition-case lbt-err (error "Oops")
+       (error (lexical-binding-test-symbol-value 'lbt-err)))
+     unbound)
+    ("condition-case: closure over variable"
+     (funcall (condition-case err (error "Oops")
+		(error (lambda () (cadr err)))))
+     "Oops")
+    ;; Special variables
+    ("special-variable-p: defvar"
+     (special-variable-p 'lexical-binding-test-special) t)
+    ("special-variable-p: defconst"
+     (special-variable-p 'lexical-binding-test-constant) t)
+    ("special-variable-p: plain symbol"
+     (special-variable-p 'lbt-not-special) nil)
+    ("special: let"
+     (let ((lexical-binding-test-special 'let))
+       (lexical-binding-test-special-value))
+     let)
+    ("special: let*"
+     (let* ((x 'let*) (lexical-binding-test-special x))
+       (lexical-binding-test-special-value))
+     let*)
+    ("special: closure argument"
+     (funcall (lambda (lexical-binding-test-special)
+		(lexical-binding-test-special-value))
+	      'argument)
+     argument)
+    ("special: closure &rest argument"
+     (funcall (lambda (&rest lexical-binding-test-special)
+		(lexical-binding-test-special-value))
+	      1 2)
+     (1 2))
+    ("special: condition-case variable"
+     (condition-case lexical-binding-test-special (error "Oops")
+       (error (car (lexical-binding-test-special-value))))
+     error)
+    ("special: binding is undone"
+     (progn
+       (let ((lexical-binding-test-special 'let)) nil)
+       (funcall (lambda (lexical-binding-test-special) nil) 'argument)
+       lexical-binding-test-special)
+     global)
+    ("special: local defvar"
+     (let ((x 1))
+       (defvar lbt-local)
+       (let ((lbt-local 'inner))
+	 (list x (lexical-binding-test-symbol-value 'lbt-local)
+	       (special-variable-p 'lbt-local))))
+     (1 inner nil))
+    ("special: local defvar ends with its scope"
+     (progn
+       (let ((x 1)) (defvar lbt-local-2) x)
+       (let ((lbt-local-2 1))
+	 (lexical-binding-test-symbol-value 'lbt-local-2)))
+     unbound))
+  "Forms evaluated with lexical binding, and their expected values.
+Each element is (NAME FORM VALUE).")
+
+(defconst lexical-binding-testsuite-file-contents
+  ";; -*- lexical-binding: t -*-
+\(defvar lexical-binding-test-file-special 'global)
+\(defun lexical-binding-test-adder (n)
+  (lambda (x) (+ x n)))
+\(defun lexical-binding-test-file-special (lexical-binding-test-file-special)
+  (funcall (lambda () (symbol-value 'lexical-binding-test-file-special))))
+"
+  "Contents of the file with lexical binding that the tests load.")
+
+(defun lexical-binding-testsuite-check (test ok)
+  "Report TEST, and signal an error unless OK is non-nil."
+  (princ (format "%s: %s\n" test (if ok "OK" "NG")))
+  (unless ok
+    (error "Lexical binding test failed: %s" test)))
+
+(defun lexical-binding-testsuite-forms ()
+  "Evaluate `lexical-binding-testsuite-forms' with lexical binding."
+  (dolist (test lexical-binding-testsuite-forms)
+    (lexical-binding-testsuite-check
+     (car test) (equal (eval (nth 1 test) t) (nth 2 test))))
+  (lexical-binding-testsuite-check
+   "dynamic: closures are not made"
+   (eq (car-safe (eval '(let ((x 1)) (lambda () x)))) 'lambda)))
+
+(defun lexical-binding-testsuite-file ()
+  "Test loading and compiling a file that sets `lexical-binding'."
+  (let* ((dir (make-temp-file "lexical-binding-test" t))
+	 (el (expand-file-name "lexical-binding-test.el" dir))
+	 (elc (concat el "c")))
+    (unwind-protect
+	(progn
+	  (with-temp-file el
+	    (insert lexical-binding-testsuite-file-contents))
+	  (load el nil t t)
+	  (lexical-binding-testsuite-check
+	   "file: closure"
+	   (and (eq (car-safe (lexical-binding-test-adder 1)) 'closure)
+		(= (funcall (lexical-binding-test-adder 10) 5) 15)))
+	  (lexical-binding-testsuite-check
+	   "file: special argument"
+	   (eq (lexical-binding-test-file-special 'argument) 'argument))
+	  ;; The compiler refuses the file, and leaves its .elc file
+	  ;; alone.
+	  (with-temp-file elc
+	    (insert ";ELC\n"))
+	  (lexical-binding-testsuite-check
+	   "file: byte-compile-file signals an error"
+	   (condition-case nil
+	       (progn (byte-compile-file el) nil)
+	     (error t)))
+	  (lexical-binding-testsuite-check
+	   "file: .elc file kept" (file-exists-p elc))
+	  ;; Unless the file also asks not to be compiled.
+	  (with-temp-file el
+	    (insert ";; -*- lexical-binding: t; no-byte-compile: t -*-\n"))
+	  (lexical-binding-testsuite-check
+	   "file: no-byte-compile"
+	   (eq (byte-compile-file el) 'no-byte-compile)))
+      (dolist (file (directory-files dir t "\\`[^.]"))
+	(delete-file file))
+      (delete-directory dir))))
+
+(defun lexical-binding-testsuite-run ()
+  "Test lexical binding in the interpreter."
+  (lexical-binding-testsuite-forms)
+  (lexical-binding-testsuite-file))
+
+;;; lexical-binding-testsuite.el ends here
@@ -0,0 +1,88 @@
+;;; load-bench.el --- benchmark for loading byte-compiled files
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Runs `load' on every .elc file in the lisp/ directory of the source
+;; tree, the way Emacs loads them at startup, and prints how long that
+;; took.  The forms are read, but not evaluated, so that the files
+;; cannot change the session running the benchmark and what is timed
+;; is the reader and the file handling of `load'.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l load-bench.el -f load-bench-run
+
+;;; Code:
+
+(defvar load-bench-directory
+  (expand-file-name "../lisp/"
+		    (file-name-directory (or load-file-name
+					     buffer-file-name)))
+  "Directory whose byte-compiled files `load-bench-run' loads.")
+
+(defvar load-bench-repeat 3
+  "Number of times to load the files.")
+
+(defun load-bench-files (dir)
+  "Return the .elc files in DIR and its subdirectories."
+  (let (files)
+    (dolist (file (directory-files dir t))
+      (cond ((string-match "/\\.\\.?\\'" file))
+	    ((file-directory-p file)
+	     (setq files (nconc (load-bench-files file) files)))
+	    ((string-match "\\.elc\\'" file)
+	     (push file files))))
+    files))
+
+(defun load-bench-read (stream)
+  "Read a form from STREAM for `load', and discard it."
+  (read stream)
+  nil)
+
+(defun load-bench-run ()
+  "Time loading the byte-compiled files in `load-bench-directory'."
+  (let ((files (load-bench-files load-bench-directory))
+	(bytes 0)
+	(best nil))
+    (dolist (file files)
+      (setq bytes (+ bytes (nth 7 (file-attributes file)))))
+    (message "%d files, %d bytes" (length files) bytes)
+    (dotimes (i load-bench-repeat)
+      (garbage-collect)
+      (let ((start (float-time))
+	    (failed 0))
+	(let ((load-read-function 'load-bench-read)
+	      (load-history load-history)
+	      (load-native-code nil))
+	  (dolist (file files)
+	    (condition-case nil
+		(load file nil t t)
+	      (error (setq failed (1+ failed))))))
+	(let ((elapsed (- (float-time) start)))
+	  (if (or (null best) (< elapsed best))
+	      (setq best elapsed))
+	  (message "run %d: %8.4fs  (%d failed)" (1+ i) elapsed failed))))
+    (message "best:  %8.4fs  %8.1f MB/s"
+	     best (/ bytes best 1024.0 1024.0))))
+
+;;; load-bench.el ends here
@@ -0,0 +1,128 @@
+;;; native-code-testsuite.el --- tests for byte-native.el and native.c
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Writes a small Lisp file into a temporary directory, byte-compiles
+;; it, translates the .elc file into a .eln file with
+;; `byte-native-compile-file', and loads it.  The functions loaded
+;; must then run as native code and return what the same functions
+;; return when interpreted.  Then the .eln file is made older than
+;; the .elc file, and loading it again must leave the functions in
+;; the interpreter.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l native-code-testsuite.el -f native-code-testsuite-run
+;;
+;; It signals an error if a test fails.
+
+;;; Code:
+
+(require 'byte-native)
+
+(defconst native-code-testsuite-source
+  '((defun native-code-test-sum (n)
+      (let ((sum 0) (i 0))
+	(while (< i n)
+	  (setq sum (+ sum (* i i))
+		i (1+ i)))
+	sum))
+    (defun native-code-test-collect (list)
+      (let (result)
+	(dolist (elt list (nreverse result))
+	  (cond ((integerp elt) (push (- elt) result))
+		((stringp elt) (push (concat elt "!") result))
+		((consp elt) (push (car elt) result))))))
+    (defun native-code-test-catch (n)
+      (catch 'done
+	(dotimes (i n)
+	  (if (= i 7) (throw 'done (list 'stopped i))))
+	'finished))
+    (defun native-code-test-error (x)
+      (condition-case err
+	  (car x)
+	(wrong-type-argument (list 'caught (car err))))))
+  "Definitions of the functions that the tests translate.")
+
+(defconst native-code-testsuite-calls
+  '((native-code-test-sum 0)
+    (native-code-test-sum 1000)
+    (native-code-test-collect (1 "a" (b . c) 2.5 -3))
+    (native-code-test-catch 5)
+    (native-code-test-catch 20)
+    (native-code-test-error (x y))
+    (native-code-test-error 42))
+  "Calls whose values are compared.
+The arguments are not evaluated.")
+
+(defun native-code-testsuite-values ()
+  "Return the values of `native-code-testsuite-calls'."
+  (mapcar (lambda (call) (apply (car call) (cdr call)))
+	  native-code-testsuite-calls))
+
+(defun native-code-testsuite-check (test ok)
+  "Report TEST, and signal an error unless OK is non-nil."
+  (princ (format "%s: %s\n" test (if ok "OK" "NG")))
+  (unless ok
+    (error "Native code test failed: %s" test)))
+
+(defun native-code-testsuite-run ()
+  "Test translating a byte-compiled file to native code and loading it."
+  (let* ((dir (make-temp-file "native-code-test" t))
+	 (el (expand-file-name "native-code-test.el" dir))
+	 (elc (concat el "c"))
+	 (eln (concat el "n"))
+	 (load-native-code t)
+	 expected count)
+    (unwind-protect
+	(progn
+	  (mapc 'eval native-code-testsuite-source)
+	  (setq expected (native-code-testsuite-values))
+	  (with-temp-file el
+	    (let ((print-length nil) (print-level nil))
+	      (dolist (form native-code-testsuite-source)
+		(prin1 form (current-buffer))
+		(insert "\n"))))
+	  (native-code-testsuite-check "byte-compile" (byte-compile-file el))
+	  (setq count (byte-native-compile-file elc))
+	  (native-code-testsuite-check
+	   "translate" (and (file-exists-p eln) (> count 0)))
+	  (load elc nil t t)
+	  (native-code-testsuite-check
+	   "native" (native-code-function-p
+		     (symbol-function 'native-code-test-sum)))
+	  (native-code-testsuite-check
+	   "values" (equal (native-code-testsuite-values) expected))
+	  ;; Native code older than its byte code is not loaded.
+	  (set-file-times eln (seconds-to-time 0))
+	  (load elc nil t t)
+	  (native-code-testsuite-check
+	   "stale" (not (native-code-function-p
+			 (symbol-function 'native-code-test-sum))))
+	  (native-code-testsuite-check
+	   "stale values" (equal (native-code-testsuite-values) expected)))
+      (dolist (file (directory-files dir t "\\`[^.]"))
+	(delete-file file))
+      (delete-directory dir))))
+
+;;; native-code-testsuite.el ends here
@@ -0,0 +1,136 @@
+;;; obarray-testsuite.el --- tests for obarrays
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Interns many more symbols in a small obarray than it has buckets,
+;; and checks that the obarray still behaves as a vector whose
+;; elements are its buckets: `aref' returns symbols or 0, a copy made
+;; with `copy-sequence' is an obarray of its own for new symbols, and
+;; `mapatoms', `intern-soft' and `unintern' see every symbol.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l obarray-testsuite.el -f obarray-testsuite-run
+;;
+;; It signals an error if a test fails.
+
+;;; Code:
+
+(defvar obarray-testsuite-count 1000
+  "Number of symbols the tests intern in an obarray of 7 buckets.")
+
+(defun obarray-testsuite-check (test ok)
+  "Report TEST, and signal an error unless OK is non-nil."
+  (princ (format "%s: %s\n" test (if ok "OK" "NG")))
+  (unless ok
+    (error "Obarray test failed: %s" test)))
+
+(defun obarray-testsuite-size (ob)
+  "Return the number of symbols in the obarray OB."
+  (let ((n 0))
+    (mapatoms (lambda (sym) (setq n (1+ n))) ob)
+    n))
+
+(defun obarray-testsuite-buckets-p (ob)
+  "Return non-nil if every element of OB is 0 or a symbol."
+  (let ((ok t))
+    (dotimes (i (length ob))
+      (unless (or (eq (aref ob i) 0) (symbolp (aref ob i)))
+	(setq ok nil)))
+    ok))
+
+(defun obarray-testsuite-name (i)
+  "Return the name of the Ith symbol that the tests intern."
+  (format "obarray-test-%d" i))
+
+(defun obarray-testsuite-run ()
+  "Test obarrays that hold many more symbols than they have buckets."
+  (let ((ob (make-vector 7 0))
+	(n obarray-testsuite-count)
+	copy found)
+    (dotimes (i n)
+      (intern (obarray-testsuite-name i) ob))
+    (obarray-testsuite-check "length" (= (length ob) 7))
+    (obarray-testsuite-check "aref" (obarray-testsuite-buckets-p ob))
+    (obarray-testsuite-check "mapatoms" (= (obarray-testsuite-size ob) n))
+    (setq found 0)
+    (dotimes (i n)
+      (let ((sym (intern-soft (obarray-testsuite-name i) ob)))
+	(if (and sym (equal (symbol-name sym) (obarray-testsuite-name i))
+		 (eq sym (intern (obarray-testsuite-name i) ob)))
+	    (setq found (1+ found)))))
+    (obarray-testsuite-check "intern-soft" (= found n))
+    (obarray-testsuite-check
+     "intern-soft: other obarray"
+     (not (intern-soft (obarray-testsuite-name 0))))
+    ;; A copy has the same symbols, but what is interned in it later
+    ;; is not in the original.
+    (setq copy (copy-sequence ob))
+    (intern "x" copy)
+    (obarray-testsuite-check "copy: aref" (obarray-testsuite-buckets-p copy))
+    (obarray-testsuite-check
+     "copy: intern"
+     (and (intern-soft "x" copy) (not (intern-soft "x" ob))))
+    (obarray-testsuite-check
+     "copy: mapatoms"
+     (and (= (obarray-testsuite-size ob) n)
+	  (= (obarray-testsuite-size copy) (1+ n))))
+    (obarray-testsuite-check
+     "copy: same symbols"
+     (eq (intern-soft (obarray-testsuite-name 1) copy)
+	 (intern-soft (obarray-testsuite-name 1) ob)))
+    ;; Unintern every other symbol.
+    (dotimes (i n)
+      (if (zerop (% i 2))
+	  (unintern (obarray-testsuite-name i) ob)))
+    (setq found 0)
+    (dotimes (i n)
+      (if (intern-soft (obarray-testsuite-name i) ob)
+	  (setq found (1+ found))))
+    (obarray-testsuite-check
+     "unintern"
+     (and (= found (/ n 2))
+	  (not (intern-soft (obarray-testsuite-name 0) ob))
+	  (intern-soft (obarray-testsuite-name 1) ob)))
+    (obarray-testsuite-check
+     "unintern: mapatoms" (= (obarray-testsuite-size ob) (/ n 2)))
+    (obarray-testsuite-check "unintern: aref" (obarray-testsuite-buckets-p ob))
+    ;; Interning while mapping.
+    (setq found 0)
+    (mapatoms (lambda (sym)
+		(unless (string-match "-new\\'" (symbol-name sym))
+		  (intern (concat (symbol-name sym) "-new") ob)
+		  (setq found (1+ found))))
+	      ob)
+    (obarray-testsuite-check
+     "mapatoms: intern"
+     (and (= found (/ n 2))
+	  (= (obarray-testsuite-size ob) n)
+	  (intern-soft (concat (obarray-testsuite-name 1) "-new") ob)))
+    ;; The standard obarray is a vector of buckets too.
+    (obarray-testsuite-check
+     "standard obarray"
+     (and (vectorp obarray) (obarray-testsuite-buckets-p obarray)
+	  (eq (intern-soft "car") 'car)))))
+
+;;; obarray-testsuite.el ends here
@@ -0,0 +1,89 @@
+;;; weak-hash-bench.el --- benchmark GC of dependent weak hash tables
+
+;; Copyright (C) 2026  Free Software Foundation, Inc.
+
+;; Keywords:       internal
+;; Human-Keywords: internal
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <http://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; Entries of weak hash tables can keep each other alive: in a
+;; key-weak table, the value of an entry whose key survives survives
+;; too, and may be the key of another entry.  This builds long chains
+;; of such entries, spread over several weak tables, and times garbage
+;; collection.  It also checks that exactly the live part of each
+;; chain survives.
+;;
+;; Run it with
+;;
+;;   emacs -batch -l weak-hash-bench.el -f weak-hash-bench-run
+
+;;; Code:
+
+(defvar weak-hash-bench-length 5000
+  "Number of entries in each chain.")
+
+(defvar weak-hash-bench-tables 8
+  "Number of weak tables the entries of a chain are spread over.")
+
+(defvar weak-hash-bench-root nil
+  "The object keeping the first chain alive.")
+
+(defun weak-hash-bench-make-chain (tables)
+  "Make a chain of entries in TABLES, shuffled.  Return its first key."
+  (let* ((n weak-hash-bench-length)
+	 (objects (make-vector (1+ n) nil))
+	 (order (make-vector n nil)))
+    (dotimes (i (1+ n))
+      (aset objects i (list i)))
+    (dotimes (i n)
+      (aset order i i))
+    ;; Shuffle, so that the entries aren't looked at in chain order.
+    (dotimes (i n)
+      (let ((j (+ i (random (- n i))))
+	    (tem (aref order i)))
+	(aset order i (aref order j))
+	(aset order j tem)))
+    (dotimes (k n)
+      (let ((i (aref order k)))
+	(puthash (aref objects i) (aref objects (1+ i))
+		 (aref tables (% i (length tables))))))
+    (aref objects 0)))
+
+(defun weak-hash-bench-run ()
+  "Time garbage collection with long chains of weak entries."
+  (random "weak-hash-bench")
+  (let ((tables (make-vector weak-hash-bench-tables nil))
+	start elapsed count)
+    (dotimes (i weak-hash-bench-tables)
+      (aset tables i (make-hash-table :test 'eq :weakness 'key)))
+    ;; One chain stays alive, the other one doesn't.
+    (setq weak-hash-bench-root (weak-hash-bench-make-chain tables))
+    (weak-hash-bench-make-chain tables)
+    (garbage-collect)
+    (setq start (float-time))
+    (garbage-collect)
+    (setq elapsed (- (float-time) start))
+    (setq count 0)
+    (dotimes (i weak-hash-bench-tables)
+      (setq count (+ count (hash-table-count (aref tables i)))))
+    (message "GC with %d chained weak entries: %.4fs, %d entries left%s"
+	     (* 2 weak-hash-bench-length) elapsed count
+	     (if (= count weak-hash-bench-length) "" " (wrong)"))))
+
+;;; weak-hash-bench.el ends here